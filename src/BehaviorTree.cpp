@@ -25,795 +25,5208 @@
 
 #include "BehaviorTree.h"
 
-BehaviorTree::CompositeNode::CompositeNode() 
-: Node()
-, maxChildrenSize(BehaviorTree::INFINITE_CHILDREN)
-, runningChildIndex(BehaviorTree::NO_RUNNING_CHILD)
-{}
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+// SSE2 path of BatchCondition. The scalar fallback covers everything else.
+#include <emmintrin.h>
+#endif
+
+#if defined(BT_DEBUG_ALLOC)
+#include <cassert>
+#include <cstdlib>
+
+// Allocation audit state. Per thread, so a worker ticking one agent doesn't
+// count allocations of another worker. @see BehaviorTree::AllocationAudit
+static thread_local bool allocationAuditActive = false;
+static thread_local int allocationAuditDepth = 0;
+static thread_local unsigned long long allocationAuditCount = 0;
+static thread_local unsigned long long allocationAuditLastTick = 0;
+
+// Assert switch. One shared slot; flip it before ticking.
+static bool allocationAuditAsserts = false;
+
+/**
+*	@name auditedAllocate
+*	@brief Heap allocation behind the replaced global operator new. Counts
+*	the allocation when a tick is being audited on this thread.
+*/
+static void* auditedAllocate(const std::size_t size)
+{
+	if (allocationAuditActive)
+	{
+		allocationAuditCount++;
 
-BehaviorTree::CompositeNode::CompositeNode(std::unique_ptr<BehaviorTree::Node> child)
-: Node()
-, maxChildrenSize(BehaviorTree::INFINITE_CHILDREN)
-, runningChildIndex(BehaviorTree::NO_RUNNING_CHILD)
+		// Trap right here so the offending node is up the call stack
+		assert(allocationAuditAsserts == false && "heap allocation during Tree::update");
+	}
+
+	void* memory = std::malloc((size == 0) ? 1 : size);
+
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	return memory;
+}
+
+// Replaced global allocation functions. Only with BT_DEBUG_ALLOC; without it
+// this translation unit leaves the global heap alone. The nothrow and
+// aligned forms fall back to these by default, so replacing the four
+// ordinary ones catches everything.
+void* operator new(std::size_t size)
 {
-	this->addChild(std::move(child));
+	return auditedAllocate(size);
 }
 
-BehaviorTree::CompositeNode::CompositeNode(std::vector<std::unique_ptr<BehaviorTree::Node>>& children) 
-: Node()
-, maxChildrenSize(BehaviorTree::INFINITE_CHILDREN)
-, runningChildIndex(BehaviorTree::NO_RUNNING_CHILD)
+void* operator new[](std::size_t size)
 {
-	this->addChildren(children);
+	return auditedAllocate(size);
 }
 
-const bool BehaviorTree::CompositeNode::addChild(std::unique_ptr<BehaviorTree::Node> child)
+void operator delete(void* memory) noexcept
 {
-	if (child != nullptr)
-	{
-		// Add to children
-		this->children.push_back(std::move(child));
-		return true;
-	}
-	else
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+#endif
+
+/**
+*	@name xorshift32
+*	@brief Fast PRNG used to shuffle child update order. State must not be 0.
+*/
+static unsigned int xorshift32(unsigned int& state)
+{
+	unsigned int x = state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	state = x;
+	return x;
+}
+
+/**
+*	@name seedRngState
+*	@brief Seed a PRNG state once from random device. Never returns 0.
+*/
+static unsigned int seedRngState()
+{
+	unsigned int seed = static_cast<unsigned int>(std::random_device{}());
+	if (seed == 0)
 	{
-		return false;
+		// xorshift state must not be 0
+		seed = 0x9E3779B9;
 	}
+	return seed;
 }
 
-const bool BehaviorTree::CompositeNode::addChildren(std::vector<std::unique_ptr<BehaviorTree::Node>>& children)
+// Every node allocation is prefixed with one aligned header word that tags
+// where the memory came from, so operator delete knows whether to free it.
+static const std::size_t NODE_ALLOC_HEADER = alignof(std::max_align_t);
+
+// Header tag for memory carved from a NodePool. Reclaimed by recycle.
+static const std::size_t NODE_ALLOC_POOLED = 1;
+
+// Header tag for memory from the global heap. Freed by operator delete.
+static const std::size_t NODE_ALLOC_HEAP = 0;
+
+BehaviorTree::NodePool* BehaviorTree::NodePool::activePool = nullptr;
+
+BehaviorTree::NodePool::NodePool(const int blockSize)
+: blockSize(blockSize)
+{}
+
+BehaviorTree::NodePool::~NodePool()
 {
-	if (children.empty())
+	if (activePool == this)
 	{
-		// Empty children. Reject
-		return false;
+		// Don't leave a dangling bound pool behind
+		activePool = nullptr;
 	}
+}
 
-	if (this->maxChildrenSize != BehaviorTree::INFINITE_CHILDREN)
+void* BehaviorTree::NodePool::allocate(const std::size_t size)
+{
+	// Round up so the next allocation stays aligned for any node
+	const std::size_t alignment = alignof(std::max_align_t);
+	const int alignedSize = static_cast<int>((size + alignment - 1) & ~(alignment - 1));
+
+	if (this->blocks.empty() || (this->blocks.back().capacity - this->blocks.back().used) < alignedSize)
 	{
-		// There is maximum children can be added. Get current children size
-		int currentChildrenSize = static_cast<int>(this->children.size());
-		// Get size of children that need to be added
-		int addingChildrenSize = static_cast<int>(children.size());
+		// Current block is full. Make a new one, big enough even for odd sizes.
+		Block block;
+		block.capacity = std::max(this->blockSize, alignedSize);
+		block.used = 0;
+		block.memory = std::unique_ptr<unsigned char[]>(new unsigned char[block.capacity]);
 
-		if (currentChildrenSize + addingChildrenSize > this->maxChildrenSize)
-		{
-			// Total size after adding children exceeds maximu children size. Reject.
-			return false;
-		}
+		this->blocks.push_back(std::move(block));
 	}
 
-	for (auto& child : children)
+	Block& block = this->blocks.back();
+
+	void* memory = block.memory.get() + block.used;
+	block.used += alignedSize;
+
+	return memory;
+}
+
+void BehaviorTree::NodePool::begin()
+{
+	activePool = this;
+}
+
+void BehaviorTree::NodePool::end()
+{
+	if (activePool == this)
 	{
-		// No need to check nullptr
-		this->addChild(std::move(child));
+		activePool = nullptr;
 	}
+}
 
-	return true;
+void BehaviorTree::NodePool::recycle()
+{
+	// Blocks are kept. Only the bump offsets go back to 0, so the whole
+	// pool is handed back in one pass regardless of how many nodes it held.
+	for (auto& block : this->blocks)
+	{
+		block.used = 0;
+	}
 }
 
-const std::vector<std::unique_ptr<BehaviorTree::Node>>& BehaviorTree::CompositeNode::getChildren()
+const int BehaviorTree::NodePool::getBlockCount()
 {
-	// Return children as reference
-	return this->children;
+	return static_cast<int>(this->blocks.size());
 }
 
-void BehaviorTree::CompositeNode::clearChildren(const bool cleanUp)
+BehaviorTree::NodePool* BehaviorTree::NodePool::getActivePool()
 {
-	// Clear vector
-	this->children.clear();
+	return activePool;
 }
 
-const bool BehaviorTree::CompositeNode::setMaxChildrenSize(const int maxChildrenSize, const bool cleanUpRemains)
+void* BehaviorTree::Node::operator new(std::size_t size)
 {
-	//can't be 0
-	if (maxChildrenSize == 0)
+	NodePool* pool = NodePool::getActivePool();
+
+	// Header word in front of the node remembers where the memory came from
+	unsigned char* memory = nullptr;
+
+	if (pool != nullptr)
 	{
-		return false;
+		memory = static_cast<unsigned char*>(pool->allocate(size + NODE_ALLOC_HEADER));
+		*reinterpret_cast<std::size_t*>(memory) = NODE_ALLOC_POOLED;
+	}
+	else
+	{
+		memory = static_cast<unsigned char*>(::operator new(size + NODE_ALLOC_HEADER));
+		*reinterpret_cast<std::size_t*>(memory) = NODE_ALLOC_HEAP;
 	}
 
-	// Get current children size
-	const int currentChildrenSize = static_cast<int>(this->children.size());
-	if (maxChildrenSize == currentChildrenSize)
+	return memory + NODE_ALLOC_HEADER;
+}
+
+void BehaviorTree::Node::operator delete(void* ptr)
+{
+	if (ptr == nullptr) return;
+
+	unsigned char* memory = static_cast<unsigned char*>(ptr) - NODE_ALLOC_HEADER;
+
+	if (*reinterpret_cast<std::size_t*>(memory) == NODE_ALLOC_HEAP)
 	{
-		// Setting to same size. 
-		return true;
+		::operator delete(memory);
 	}
+	// else: pooled. Memory goes back all at once on NodePool::recycle.
+}
 
-	//make infinite. Always valid operation.
-	if (maxChildrenSize == BehaviorTree::INFINITE_CHILDREN)
+
+#if defined(BT_PROFILING)
+BehaviorTree::Profiler* BehaviorTree::Profiler::activeProfiler = nullptr;
+
+BehaviorTree::Profiler::Profiler()
+: previous(nullptr)
+{
+	this->clear();
+}
+
+void BehaviorTree::Profiler::begin()
+{
+	// Remember the outer binding, if any. Trees can update nested.
+	this->previous = activeProfiler;
+	activeProfiler = this;
+}
+
+void BehaviorTree::Profiler::end()
+{
+	if (activeProfiler == this)
 	{
-		this->maxChildrenSize = BehaviorTree::INFINITE_CHILDREN;
-		return true;
+		activeProfiler = this->previous;
 	}
 
-	//Check if new max children size is larger than current max children size
-	if (maxChildrenSize >= this->maxChildrenSize)
+	this->previous = nullptr;
+}
+
+void BehaviorTree::Profiler::record(const BehaviorTree::NODE_TYPE type, const BehaviorTree::NODE_STATE result, const double seconds)
+{
+	const int typeIndex = static_cast<int>(type);
+	const int stateIndex = static_cast<int>(result);
+
+	this->invocationCounts[typeIndex]++;
+	this->stateCounts[typeIndex][stateIndex]++;
+	this->cumulativeSeconds[typeIndex] += seconds;
+
+	if (this->invocationCounts[typeIndex] > 1 && this->lastResults[typeIndex] != result)
 	{
-		// Valid. Set new max children size.
-		this->maxChildrenSize = maxChildrenSize;
-		return true;
+		// Same node type came back with a different state than last time
+		this->transitionCounts[typeIndex]++;
 	}
+	this->lastResults[typeIndex] = result;
 
-	// Check if max children size is current children size
-	if (currentChildrenSize < maxChildrenSize)
+	Sample& sample = this->samples[this->sampleCursor];
+	sample.type = type;
+	sample.result = result;
+	sample.milliseconds = static_cast<float>(seconds * 1000.0);
+
+#if defined(BT_DEBUG_ALLOC)
+	// ProfileScope annotates the real count right after. @see AllocationAudit
+	sample.allocations = 0;
+#endif
+
+	this->sampleCursor = (this->sampleCursor + 1) % SAMPLE_RING_SIZE;
+	this->totalSampleCount++;
+}
+
+#if defined(BT_DEBUG_ALLOC)
+void BehaviorTree::Profiler::annotateLastSampleAllocations(const unsigned long long allocations)
+{
+	if (this->totalSampleCount == 0)
 	{
-		//can be resized without resizing children vector
-		this->maxChildrenSize = maxChildrenSize;
-		return true;
+		return;
 	}
-	
-	//new maximum children size is not infiite, 0, or bigger and equal than current size.
-	if (cleanUpRemains)
+
+	// record already advanced the cursor. Step back to the newest sample.
+	const int newest = (this->sampleCursor + SAMPLE_RING_SIZE - 1) % SAMPLE_RING_SIZE;
+	this->samples[newest].allocations = allocations;
+}
+#endif
+
+void BehaviorTree::Profiler::clear()
+{
+	for (int i = 0; i < TYPE_COUNT; i++)
 	{
-		// Clean up reamaining nodes before resizing.
-		int i = maxChildrenSize;
-		int childrenSize = static_cast<int>(this->children.size());
-		for (; i < childrenSize; i)
+		this->invocationCounts[i] = 0;
+		this->transitionCounts[i] = 0;
+		this->cumulativeSeconds[i] = 0.0;
+		this->lastResults[i] = NODE_STATE::SUCCESS;
+
+		for (int j = 0; j < STATE_COUNT; j++)
 		{
-			if (this->children.at(i) != nullptr)
-			{
-				std::unique_ptr<BehaviorTree::Node> nodePtr = std::move(this->children.at(i));
-				BehaviorTree::Node* node = nodePtr.release();
-				delete node;
-				node = nullptr;
-			}
+			this->stateCounts[i][j] = 0;
 		}
 	}
 
-	// Resize
-	this->children.resize(maxChildrenSize);
+	this->sampleCursor = 0;
+	this->totalSampleCount = 0;
 }
 
-const bool BehaviorTree::CompositeNode::isRunningChildIndexValid()
+const unsigned long long BehaviorTree::Profiler::getInvocationCount(const BehaviorTree::NODE_TYPE type)
 {
-	int size = static_cast<int>(this->children.size());
-	return (this->runningChildIndex < size) && (this->runningChildIndex != BehaviorTree::NO_RUNNING_CHILD);
+	return this->invocationCounts[static_cast<int>(type)];
 }
 
-const BehaviorTree::NODE_STATE BehaviorTree::CompositeNode::updateRunningChild(const float delta, int& start)
+const unsigned long long BehaviorTree::Profiler::getStateCount(const BehaviorTree::NODE_TYPE type, const BehaviorTree::NODE_STATE state)
 {
-	int size = static_cast<int>(this->children.size());
+	return this->stateCounts[static_cast<int>(type)][static_cast<int>(state)];
+}
 
-	//check if this selector has running child and make sure it's in the range
-	if (this->runningChildIndex < size)
+const unsigned long long BehaviorTree::Profiler::getTransitionCount(const BehaviorTree::NODE_TYPE type)
+{
+	return this->transitionCounts[static_cast<int>(type)];
+}
+
+const double BehaviorTree::Profiler::getCumulativeSeconds(const BehaviorTree::NODE_TYPE type)
+{
+	return this->cumulativeSeconds[static_cast<int>(type)];
+}
+
+const int BehaviorTree::Profiler::getSampleCount()
+{
+	return (this->totalSampleCount < static_cast<unsigned long long>(SAMPLE_RING_SIZE)) ? static_cast<int>(this->totalSampleCount) : SAMPLE_RING_SIZE;
+}
+
+const BehaviorTree::Profiler::Sample& BehaviorTree::Profiler::getSample(const int index)
+{
+	const int count = this->getSampleCount();
+
+	// Oldest sample sits at the cursor once the ring has wrapped
+	const int oldest = (this->totalSampleCount > static_cast<unsigned long long>(SAMPLE_RING_SIZE)) ? this->sampleCursor : 0;
+
+	return this->samples[(oldest + index) % SAMPLE_RING_SIZE];
+}
+
+BehaviorTree::Profiler* BehaviorTree::Profiler::getActiveProfiler()
+{
+	return activeProfiler;
+}
+
+BehaviorTree::ProfileScope::ProfileScope(const BehaviorTree::NODE_TYPE type)
+: type(type)
+, profiler(Profiler::getActiveProfiler())
+{
+	if (this->profiler != nullptr)
 	{
-		// This selector has running child and it's in range of children size.
-		// Update running node and get result.
-		BehaviorTree::NODE_STATE state = this->children.at(this->runningChildIndex)->update(delta);
+		this->start = std::chrono::steady_clock::now();
 
-		if (state == BehaviorTree::NODE_STATE::RUNNING)
-		{
-			// Still running. Keep go on.
-			return state;
-		}
-		else if (state == BehaviorTree::NODE_STATE::SUCCESS)
-		{
-			// Success. Reset running child index.
-			this->runningChildIndex = BehaviorTree::NO_RUNNING_CHILD;
-			// Because it's selector, ends here.
-			return state;
-		}
-		else
-		{
-			// Else, status is FAILURE or ignorable ERROR.
-			// Set start index after the running child index.
-			start = this->runningChildIndex + 1;
-			// Reset running child index
-			this->runningChildIndex = BehaviorTree::NO_RUNNING_CHILD;
-		}
+#if defined(BT_DEBUG_ALLOC)
+		this->allocStart = AllocationAudit::getCurrentCount();
+#endif
 	}
-	// else, there was no running child
-	return BehaviorTree::NODE_STATE::FAILURE;
 }
 
-const BehaviorTree::NODE_STATE BehaviorTree::CompositeNode::updateChildren(const int start, const float delta, const BehaviorTree::NODE_STATE continueCondition)
+const BehaviorTree::NODE_STATE BehaviorTree::ProfileScope::finish(const BehaviorTree::NODE_STATE state)
 {
-	// If running childe node returned FAILURE or ERROR, keep go on.
-	int size = static_cast<int>(this->children.size());
-	for (int i = start; i < size; i++)
+	if (this->profiler != nullptr)
 	{
-		if (this->children.at(i) != nullptr)
-		{
-			// Update node
-			BehaviorTree::NODE_STATE state = this->children.at(i)->update(delta);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->start).count();
+		this->profiler->record(this->type, state, seconds);
 
-			// Check status
-			if (state == continueCondition)
-			{
-				// If this is selector, state must be FAILURE to continue.
-				// If this is sequence, state must be SUCCESS to continue.
-				continue;
-			}
-			else if (state == BehaviorTree::NODE_STATE::ERROR)
-			{
-				// Error occured.
-				if (BehaviorTree::IGNORE_ERROR)
-				{
-					// Can ignore error. 
-					continue;
-				}
-				else
-				{
-					// Terminate. Return ERROR.
-					return state;
-				}
-			}
-			else if (state == BehaviorTree::NODE_STATE::RUNNING)
-			{
-				// Set this node as running child
-				this->runningChildIndex = i;
-				return state;
-			}
-			else
-			{
-				// If this is selector, this is SUCCESS. Return.
-				// If this is sequence, this is FAILURE. Return.
-				return state;
-			}
-		}
+#if defined(BT_DEBUG_ALLOC)
+		// Pin this update's allocations to its ring buffer sample
+		this->profiler->annotateLastSampleAllocations(AllocationAudit::getCurrentCount() - this->allocStart);
+#endif
 	}
 
-	// Iterated all children
-	// If this is selector, every child failed. Return FAILURE.
-	// If this is sequence, every child succeeded. Return SUCCESS.
+	return state;
+}
+#endif
+
+#if defined(BT_DEBUG_ALLOC)
+const unsigned long long BehaviorTree::AllocationAudit::begin()
+{
+	if (allocationAuditDepth == 0)
+	{
+		// Outermost update on this thread. Start a fresh count.
+		allocationAuditCount = 0;
+		allocationAuditActive = true;
+	}
+
+	allocationAuditDepth++;
+
+	return allocationAuditCount;
+}
+
+const unsigned long long BehaviorTree::AllocationAudit::end(const unsigned long long startCount)
+{
+	allocationAuditDepth--;
+
+	if (allocationAuditDepth == 0)
+	{
+		allocationAuditActive = false;
+	}
+
+	allocationAuditLastTick = allocationAuditCount - startCount;
+
+	return allocationAuditLastTick;
+}
+
+const unsigned long long BehaviorTree::AllocationAudit::getCurrentCount()
+{
+	return allocationAuditCount;
+}
+
+const unsigned long long BehaviorTree::AllocationAudit::getLastTickCount()
+{
+	return allocationAuditLastTick;
+}
+
+void BehaviorTree::AllocationAudit::setAssertOnAllocation(const bool enabled)
+{
+	allocationAuditAsserts = enabled;
+}
+
+const bool BehaviorTree::AllocationAudit::getAssertOnAllocation()
+{
+	return allocationAuditAsserts;
+}
+#endif
+
+BehaviorTree::Blackboard::Entry::Entry()
+: type(BehaviorTree::Blackboard::ENTRY_TYPE::EMPTY)
+, version(0)
+, boolValue(false)
+, intValue(0)
+, floatValue(0.0f)
+, pointerValue(nullptr)
+{}
+
+BehaviorTree::Blackboard::Blackboard() {}
+
+BehaviorTree::Blackboard::Entry& BehaviorTree::Blackboard::entryAt(const int keyId)
+{
+	if (keyId >= static_cast<int>(this->entries.size()))
+	{
+		this->entries.resize(keyId + 1);
+	}
+
+	return this->entries.at(keyId);
+}
+
+const BehaviorTree::Blackboard::Entry* BehaviorTree::Blackboard::findEntry(const int keyId) const
+{
+	if (keyId < 0 || keyId >= static_cast<int>(this->entries.size()))
+	{
+		return nullptr;
+	}
+
+	return &this->entries.at(keyId);
+}
+
+const int BehaviorTree::Blackboard::internKey(const char* name)
+{
+	// IDs are process wide, so every blackboard indexes the same way and
+	// key IDs can be baked in to node parameters.
+	static std::unordered_map<std::string, int> keys;
+
+	auto find_it = keys.find(name);
+	if (find_it != keys.end())
+	{
+		return find_it->second;
+	}
+
+	const int keyId = static_cast<int>(keys.size());
+	keys.emplace(name, keyId);
+
+	return keyId;
+}
+
+void BehaviorTree::Blackboard::setBool(const int keyId, const bool value)
+{
+	if (keyId < 0)
+	{
+		return;
+	}
+
+	BehaviorTree::Blackboard::Entry& entry = this->entryAt(keyId);
+	entry.type = BehaviorTree::Blackboard::ENTRY_TYPE::BOOL;
+	entry.boolValue = value;
+	entry.version++;
+}
+
+void BehaviorTree::Blackboard::setInt(const int keyId, const int value)
+{
+	if (keyId < 0)
+	{
+		return;
+	}
+
+	BehaviorTree::Blackboard::Entry& entry = this->entryAt(keyId);
+	entry.type = BehaviorTree::Blackboard::ENTRY_TYPE::INT;
+	entry.intValue = value;
+	entry.version++;
+}
+
+void BehaviorTree::Blackboard::setFloat(const int keyId, const float value)
+{
+	if (keyId < 0)
+	{
+		return;
+	}
+
+	BehaviorTree::Blackboard::Entry& entry = this->entryAt(keyId);
+	entry.type = BehaviorTree::Blackboard::ENTRY_TYPE::FLOAT;
+	entry.floatValue = value;
+	entry.version++;
+}
+
+void BehaviorTree::Blackboard::setPointer(const int keyId, void* value)
+{
+	if (keyId < 0)
+	{
+		return;
+	}
+
+	BehaviorTree::Blackboard::Entry& entry = this->entryAt(keyId);
+	entry.type = BehaviorTree::Blackboard::ENTRY_TYPE::POINTER;
+	entry.pointerValue = value;
+	entry.version++;
+}
+
+const bool BehaviorTree::Blackboard::getBool(const int keyId, const bool defaultValue) const
+{
+	this->recordRead(keyId);
+
+	const BehaviorTree::Blackboard::Entry* entry = this->findEntry(keyId);
+
+	if (entry == nullptr || entry->type != BehaviorTree::Blackboard::ENTRY_TYPE::BOOL)
+	{
+		return defaultValue;
+	}
+
+	return entry->boolValue;
+}
+
+const int BehaviorTree::Blackboard::getInt(const int keyId, const int defaultValue) const
+{
+	this->recordRead(keyId);
+
+	const BehaviorTree::Blackboard::Entry* entry = this->findEntry(keyId);
+
+	if (entry == nullptr || entry->type != BehaviorTree::Blackboard::ENTRY_TYPE::INT)
+	{
+		return defaultValue;
+	}
+
+	return entry->intValue;
+}
+
+const float BehaviorTree::Blackboard::getFloat(const int keyId, const float defaultValue) const
+{
+	this->recordRead(keyId);
+
+	const BehaviorTree::Blackboard::Entry* entry = this->findEntry(keyId);
+
+	if (entry == nullptr || entry->type != BehaviorTree::Blackboard::ENTRY_TYPE::FLOAT)
+	{
+		return defaultValue;
+	}
+
+	return entry->floatValue;
+}
+
+void* BehaviorTree::Blackboard::getPointer(const int keyId, void* defaultValue) const
+{
+	this->recordRead(keyId);
+
+	const BehaviorTree::Blackboard::Entry* entry = this->findEntry(keyId);
+
+	if (entry == nullptr || entry->type != BehaviorTree::Blackboard::ENTRY_TYPE::POINTER)
+	{
+		return defaultValue;
+	}
+
+	return entry->pointerValue;
+}
+
+const BehaviorTree::Blackboard::ENTRY_TYPE BehaviorTree::Blackboard::getType(const int keyId) const
+{
+	this->recordRead(keyId);
+
+	const BehaviorTree::Blackboard::Entry* entry = this->findEntry(keyId);
+
+	return entry == nullptr ? BehaviorTree::Blackboard::ENTRY_TYPE::EMPTY : entry->type;
+}
+
+const int BehaviorTree::Blackboard::getVersion(const int keyId) const
+{
+	const BehaviorTree::Blackboard::Entry* entry = this->findEntry(keyId);
+
+	return entry == nullptr ? 0 : entry->version;
+}
+
+void BehaviorTree::Blackboard::recordRead(const int keyId) const
+{
+	if (this->recordingStack.empty() || keyId < 0)
+	{
+		return;
+	}
+
+	// Every active recording notes the key, so a nested Memoize doesn't
+	// swallow reads an enclosing one has to watch. Subtrees read few
+	// distinct keys; a linear scan per level beats a set here.
+	for (std::vector<int>& level : this->recordingStack)
+	{
+		bool recorded = false;
+
+		for (const int id : level)
+		{
+			if (id == keyId)
+			{
+				recorded = true;
+				break;
+			}
+		}
+
+		if (recorded == false)
+		{
+			level.push_back(keyId);
+		}
+	}
+}
+
+void BehaviorTree::Blackboard::startReadRecording()
+{
+	this->recordingStack.emplace_back();
+}
+
+const std::vector<int> BehaviorTree::Blackboard::stopReadRecording()
+{
+	if (this->recordingStack.empty())
+	{
+		// Stop without a start. Nothing was recorded.
+		return std::vector<int>();
+	}
+
+	std::vector<int> keys = std::move(this->recordingStack.back());
+	this->recordingStack.pop_back();
+
+	return keys;
+}
+
+
+
+
+BehaviorTree::Condition::Condition()
+: Node()
+, dirty(true)
+, lastResult(false)
+{}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Condition::update(const float delta)
+{
+	if (this->dirty)
+	{
+		// Underlying value changed since last evaluation. Re-evaluate.
+		this->lastResult = this->evaluate();
+		this->dirty = false;
+	}
+	// Else, return the cached result without evaluating.
+
+	return this->lastResult ? BehaviorTree::NODE_STATE::SUCCESS : BehaviorTree::NODE_STATE::FAILURE;
+}
+
+void BehaviorTree::Condition::markDirty()
+{
+	this->dirty = true;
+}
+
+const bool BehaviorTree::Condition::isDirty()
+{
+	return this->dirty;
+}
+
+const bool BehaviorTree::Condition::getLastResult()
+{
+	return this->lastResult;
+}
+
+void BehaviorTree::Condition::reset()
+{
+	// Force re-evaluation on next update
+	this->dirty = true;
+	this->lastResult = false;
+}
+
+
+
+
+// Lanes evaluated per step in the vector path. Arrays are padded to this.
+static const int BATCH_CONDITION_WIDTH = 4;
+
+BehaviorTree::BatchCondition::BatchCondition()
+: Node()
+, conditionCount(0)
+, firstPassingIndex(-1)
+{}
+
+void BehaviorTree::BatchCondition::addCondition(const float* value, const BehaviorTree::BatchCondition::COMPARATOR comparator, const float threshold)
+{
+	if (value == nullptr)
+	{
+		// Nothing to read from. Ignore, same as CompositeNode ignores nullptr children.
+		return;
+	}
+
+	if (this->conditionCount % BATCH_CONDITION_WIDTH == 0)
+	{
+		// Grow every stream by one full SIMD step. Padded lanes keep zero
+		// masks in every comparator stream, so they never pass.
+		const int paddedSize = this->conditionCount + BATCH_CONDITION_WIDTH;
+
+		this->gatheredValues.resize(paddedSize, 0.0f);
+		this->thresholds.resize(paddedSize, 0.0f);
+		this->lessMasks.resize(paddedSize, 0u);
+		this->lessEqualMasks.resize(paddedSize, 0u);
+		this->greaterMasks.resize(paddedSize, 0u);
+		this->greaterEqualMasks.resize(paddedSize, 0u);
+		this->equalMasks.resize(paddedSize, 0u);
+		this->notEqualMasks.resize(paddedSize, 0u);
+	}
+
+	const int index = this->conditionCount;
+
+	this->valuePointers.push_back(value);
+	this->thresholds.at(index) = threshold;
+	this->results.push_back(0);
+
+	// Mark this lane in its comparator's select mask stream
+	switch (comparator)
+	{
+	case COMPARATOR::LESS:
+		this->lessMasks.at(index) = 0xFFFFFFFFu;
+		break;
+	case COMPARATOR::LESS_EQUAL:
+		this->lessEqualMasks.at(index) = 0xFFFFFFFFu;
+		break;
+	case COMPARATOR::GREATER:
+		this->greaterMasks.at(index) = 0xFFFFFFFFu;
+		break;
+	case COMPARATOR::GREATER_EQUAL:
+		this->greaterEqualMasks.at(index) = 0xFFFFFFFFu;
+		break;
+	case COMPARATOR::EQUAL:
+		this->equalMasks.at(index) = 0xFFFFFFFFu;
+		break;
+	case COMPARATOR::NOT_EQUAL:
+	default:
+		this->notEqualMasks.at(index) = 0xFFFFFFFFu;
+		break;
+	}
+
+	this->conditionCount++;
+}
+
+const BehaviorTree::NODE_STATE BehaviorTree::BatchCondition::update(const float delta)
+{
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::LEAF);
+
+	if (this->conditionCount == 0)
+	{
+		// Empty block, same rule as a composite without children
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	// Gather current values in to the contiguous stream
+	for (int i = 0; i < this->conditionCount; i++)
+	{
+		this->gatheredValues.at(i) = *this->valuePointers.at(i);
+	}
+
+	this->firstPassingIndex = -1;
+
+	const int paddedSize = static_cast<int>(this->gatheredValues.size());
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	// Three compares cover all six comparators: >, >= and != are the
+	// complements of <=, < and ==. Each lane picks its outcome through the
+	// comparator select masks built in addCondition.
+	for (int i = 0; i < paddedSize; i += BATCH_CONDITION_WIDTH)
+	{
+		const __m128 values = _mm_loadu_ps(this->gatheredValues.data() + i);
+		const __m128 limits = _mm_loadu_ps(this->thresholds.data() + i);
+
+		const __m128 less = _mm_cmplt_ps(values, limits);
+		const __m128 lessEqual = _mm_cmple_ps(values, limits);
+		const __m128 equal = _mm_cmpeq_ps(values, limits);
+
+		__m128 passed = _mm_and_ps(less, _mm_loadu_ps(reinterpret_cast<const float*>(this->lessMasks.data() + i)));
+		passed = _mm_or_ps(passed, _mm_and_ps(lessEqual, _mm_loadu_ps(reinterpret_cast<const float*>(this->lessEqualMasks.data() + i))));
+		passed = _mm_or_ps(passed, _mm_and_ps(equal, _mm_loadu_ps(reinterpret_cast<const float*>(this->equalMasks.data() + i))));
+		passed = _mm_or_ps(passed, _mm_andnot_ps(lessEqual, _mm_loadu_ps(reinterpret_cast<const float*>(this->greaterMasks.data() + i))));
+		passed = _mm_or_ps(passed, _mm_andnot_ps(less, _mm_loadu_ps(reinterpret_cast<const float*>(this->greaterEqualMasks.data() + i))));
+		passed = _mm_or_ps(passed, _mm_andnot_ps(equal, _mm_loadu_ps(reinterpret_cast<const float*>(this->notEqualMasks.data() + i))));
+
+		const int passedBits = _mm_movemask_ps(passed);
+
+		for (int lane = 0; lane < BATCH_CONDITION_WIDTH; lane++)
+		{
+			const int index = i + lane;
+			if (index >= this->conditionCount)
+			{
+				break;
+			}
+
+			const bool pass = (passedBits & (1 << lane)) != 0;
+			this->results.at(index) = pass ? 1 : 0;
+
+			if (pass && this->firstPassingIndex == -1)
+			{
+				this->firstPassingIndex = index;
+			}
+		}
+	}
+#else
+	// Scalar fallback. Same comparator blend as the vector path, so both
+	// paths agree on every edge (padding, NaN, exact equality).
+	for (int i = 0; i < this->conditionCount; i++)
+	{
+		const float value = this->gatheredValues.at(i);
+		const float limit = this->thresholds.at(i);
+
+		const unsigned int less = (value < limit) ? 0xFFFFFFFFu : 0u;
+		const unsigned int lessEqual = (value <= limit) ? 0xFFFFFFFFu : 0u;
+		const unsigned int equal = (value == limit) ? 0xFFFFFFFFu : 0u;
+
+		unsigned int passed = less & this->lessMasks.at(i);
+		passed |= lessEqual & this->lessEqualMasks.at(i);
+		passed |= equal & this->equalMasks.at(i);
+		passed |= ~lessEqual & this->greaterMasks.at(i);
+		passed |= ~less & this->greaterEqualMasks.at(i);
+		passed |= ~equal & this->notEqualMasks.at(i);
+
+		this->results.at(i) = (passed != 0) ? 1 : 0;
+
+		if (passed != 0 && this->firstPassingIndex == -1)
+		{
+			this->firstPassingIndex = i;
+		}
+	}
+
+	(void)paddedSize;
+#endif
+
+	BT_PROFILE_RETURN((this->firstPassingIndex != -1) ? BehaviorTree::NODE_STATE::SUCCESS : BehaviorTree::NODE_STATE::FAILURE);
+}
+
+const int BehaviorTree::BatchCondition::getConditionCount()
+{
+	return this->conditionCount;
+}
+
+const int BehaviorTree::BatchCondition::getFirstPassingIndex()
+{
+	return this->firstPassingIndex;
+}
+
+const bool BehaviorTree::BatchCondition::getConditionResult(const int index)
+{
+	if (index < 0 || index >= this->conditionCount)
+	{
+		return false;
+	}
+
+	return this->results.at(index) != 0;
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::BatchCondition::clone()
+{
+	std::unique_ptr<BehaviorTree::BatchCondition> copy(new BehaviorTree::BatchCondition());
+
+	// Configuration is copied as is; the pointers read shared gameplay values
+	copy->valuePointers = this->valuePointers;
+	copy->thresholds = this->thresholds;
+	copy->lessMasks = this->lessMasks;
+	copy->lessEqualMasks = this->lessEqualMasks;
+	copy->greaterMasks = this->greaterMasks;
+	copy->greaterEqualMasks = this->greaterEqualMasks;
+	copy->equalMasks = this->equalMasks;
+	copy->notEqualMasks = this->notEqualMasks;
+	copy->conditionCount = this->conditionCount;
+
+	// Last-update state starts clean
+	copy->gatheredValues.assign(this->gatheredValues.size(), 0.0f);
+	copy->results.assign(this->results.size(), 0);
+	copy->firstPassingIndex = -1;
+
+	return std::unique_ptr<BehaviorTree::Node>(copy.release());
+}
+
+
+
+
+BehaviorTree::BlackboardCondition::BlackboardCondition(BehaviorTree::Blackboard* blackboard, const int keyId, const BehaviorTree::BatchCondition::COMPARATOR comparator, const float threshold)
+: Condition()
+, blackboard(blackboard)
+, keyId(keyId)
+, comparator(comparator)
+, threshold(threshold)
+, seenVersion(-1)
+{}
+
+const bool BehaviorTree::BlackboardCondition::evaluate()
+{
+	if (this->blackboard == nullptr)
+	{
+		return false;
+	}
+
+	// Remember the version this evaluation saw
+	this->seenVersion = this->blackboard->getVersion(this->keyId);
+
+	float value = 0.0f;
+
+	switch (this->blackboard->getType(this->keyId))
+	{
+	case BehaviorTree::Blackboard::ENTRY_TYPE::BOOL:
+		value = this->blackboard->getBool(this->keyId) ? 1.0f : 0.0f;
+		break;
+	case BehaviorTree::Blackboard::ENTRY_TYPE::INT:
+		value = static_cast<float>(this->blackboard->getInt(this->keyId));
+		break;
+	case BehaviorTree::Blackboard::ENTRY_TYPE::FLOAT:
+		value = this->blackboard->getFloat(this->keyId);
+		break;
+	case BehaviorTree::Blackboard::ENTRY_TYPE::EMPTY:
+	case BehaviorTree::Blackboard::ENTRY_TYPE::POINTER:
+	default:
+		// Nothing numeric to compare
+		return false;
+	}
+
+	switch (this->comparator)
+	{
+	case BehaviorTree::BatchCondition::COMPARATOR::LESS:
+		return value < this->threshold;
+	case BehaviorTree::BatchCondition::COMPARATOR::LESS_EQUAL:
+		return value <= this->threshold;
+	case BehaviorTree::BatchCondition::COMPARATOR::GREATER:
+		return value > this->threshold;
+	case BehaviorTree::BatchCondition::COMPARATOR::GREATER_EQUAL:
+		return value >= this->threshold;
+	case BehaviorTree::BatchCondition::COMPARATOR::EQUAL:
+		return value == this->threshold;
+	case BehaviorTree::BatchCondition::COMPARATOR::NOT_EQUAL:
+	default:
+		return value != this->threshold;
+	}
+}
+
+const BehaviorTree::NODE_STATE BehaviorTree::BlackboardCondition::update(const float delta)
+{
+	if (this->blackboard != nullptr && this->blackboard->getVersion(this->keyId) != this->seenVersion)
+	{
+		// The entry was written since the last evaluation
+		this->markDirty();
+	}
+	// Else, the entry is untouched; the cached result still holds.
+
+	return BehaviorTree::Condition::update(delta);
+}
+
+const bool BehaviorTree::BlackboardCondition::isDirty()
+{
+	// Fold the version check in, so a reactive Selector observing this
+	// guard aborts on a blackboard write with nobody calling markDirty.
+	if (this->blackboard != nullptr && this->blackboard->getVersion(this->keyId) != this->seenVersion)
+	{
+		this->markDirty();
+	}
+
+	return BehaviorTree::Condition::isDirty();
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::BlackboardCondition::clone()
+{
+	// Copies observe the same blackboard entry with their own cache
+	return std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::BlackboardCondition(this->blackboard, this->keyId, this->comparator, this->threshold));
+}
+
+
+
+
+BehaviorTree::CompositeNode::CompositeNode()
+: Node()
+, maxChildrenSize(BehaviorTree::INFINITE_CHILDREN)
+, errorPolicy(BehaviorTree::ERROR_POLICY::IGNORE)
+, runningChildIndex(BehaviorTree::NO_RUNNING_CHILD)
+{}
+
+BehaviorTree::CompositeNode::CompositeNode(std::unique_ptr<BehaviorTree::Node> child)
+: Node()
+, maxChildrenSize(BehaviorTree::INFINITE_CHILDREN)
+, errorPolicy(BehaviorTree::ERROR_POLICY::IGNORE)
+, runningChildIndex(BehaviorTree::NO_RUNNING_CHILD)
+{
+	this->addChild(std::move(child));
+}
+
+BehaviorTree::CompositeNode::CompositeNode(std::vector<std::unique_ptr<BehaviorTree::Node>>& children) 
+: Node()
+, maxChildrenSize(BehaviorTree::INFINITE_CHILDREN)
+, errorPolicy(BehaviorTree::ERROR_POLICY::IGNORE)
+, runningChildIndex(BehaviorTree::NO_RUNNING_CHILD)
+{
+	this->addChildren(children);
+}
+
+const bool BehaviorTree::CompositeNode::addChild(std::unique_ptr<BehaviorTree::Node> child)
+{
+	if (child != nullptr)
+	{
+		// Add to children
+		this->children.push_back(std::move(child));
+
+		if (this->updateOrder.empty() == false)
+		{
+			// This composite shuffles. Grow the permutation here, at build
+			// time, so the first shuffled tick doesn't have to.
+			this->updateOrder.push_back(static_cast<int>(this->updateOrder.size()));
+		}
+
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+const bool BehaviorTree::CompositeNode::addChildren(std::vector<std::unique_ptr<BehaviorTree::Node>>& children)
+{
+	if (children.empty())
+	{
+		// Empty children. Reject
+		return false;
+	}
+
+	if (this->maxChildrenSize != BehaviorTree::INFINITE_CHILDREN)
+	{
+		// There is maximum children can be added. Get current children size
+		int currentChildrenSize = static_cast<int>(this->children.size());
+		// Get size of children that need to be added
+		int addingChildrenSize = static_cast<int>(children.size());
+
+		if (currentChildrenSize + addingChildrenSize > this->maxChildrenSize)
+		{
+			// Total size after adding children exceeds maximu children size. Reject.
+			return false;
+		}
+	}
+
+	for (auto& child : children)
+	{
+		// No need to check nullptr
+		this->addChild(std::move(child));
+	}
+
+	return true;
+}
+
+const std::vector<std::unique_ptr<BehaviorTree::Node>>& BehaviorTree::CompositeNode::getChildren()
+{
+	// Return children as reference
+	return this->children;
+}
+
+void BehaviorTree::CompositeNode::clearChildren(const bool cleanUp)
+{
+	// Clear vector
+	this->children.clear();
+	this->updateOrder.clear();
+}
+
+const bool BehaviorTree::CompositeNode::setMaxChildrenSize(const int maxChildrenSize, const bool cleanUpRemains)
+{
+	//can't be 0
+	if (maxChildrenSize == 0)
+	{
+		return false;
+	}
+
+	// Get current children size
+	const int currentChildrenSize = static_cast<int>(this->children.size());
+	if (maxChildrenSize == currentChildrenSize)
+	{
+		// Setting to same size. 
+		return true;
+	}
+
+	//make infinite. Always valid operation.
+	if (maxChildrenSize == BehaviorTree::INFINITE_CHILDREN)
+	{
+		this->maxChildrenSize = BehaviorTree::INFINITE_CHILDREN;
+		return true;
+	}
+
+	//Check if new max children size is larger than current max children size.
+	//INFINITE_CHILDREN is no cap at all, so any finite request shrinks it.
+	if (this->maxChildrenSize != BehaviorTree::INFINITE_CHILDREN && maxChildrenSize >= this->maxChildrenSize)
+	{
+		// Valid. Set new max children size.
+		this->maxChildrenSize = maxChildrenSize;
+		return true;
+	}
+
+	// Check if max children size is current children size
+	if (currentChildrenSize < maxChildrenSize)
+	{
+		//can be resized without resizing children vector
+		this->maxChildrenSize = maxChildrenSize;
+		return true;
+	}
+	
+	//new maximum children size is not infiite, 0, or bigger and equal than current size.
+	if (cleanUpRemains)
+	{
+		// Clean up reamaining nodes before resizing.
+		int i = maxChildrenSize;
+		int childrenSize = static_cast<int>(this->children.size());
+		for (; i < childrenSize; i++)
+		{
+			if (this->children.at(i) != nullptr)
+			{
+				std::unique_ptr<BehaviorTree::Node> nodePtr = std::move(this->children.at(i));
+				BehaviorTree::Node* node = nodePtr.release();
+				delete node;
+				node = nullptr;
+			}
+		}
+	}
+
+	// Resize
+	this->children.resize(maxChildrenSize);
+	this->maxChildrenSize = maxChildrenSize;
+
+	if (this->updateOrder.empty() == false)
+	{
+		// Old permutation indexes children that are gone. Rebuild it.
+		this->primeUpdateOrder();
+	}
+
+	return true;
+}
+
+const std::vector<int>& BehaviorTree::CompositeNode::getUpdateOrder()
+{
+	return this->updateOrder;
+}
+
+void BehaviorTree::CompositeNode::setErrorPolicy(const BehaviorTree::ERROR_POLICY errorPolicy)
+{
+	this->errorPolicy = errorPolicy;
+
+	// Push the policy down, so the whole subtree agrees on it
+	for (auto& child : this->children)
+	{
+		if (child != nullptr)
+		{
+			child->setErrorPolicy(errorPolicy);
+		}
+	}
+}
+
+const BehaviorTree::ERROR_POLICY BehaviorTree::CompositeNode::getErrorPolicy()
+{
+	return this->errorPolicy;
+}
+
+void BehaviorTree::CompositeNode::reset()
+{
+	// Forget the running branch and reset the whole subtree
+	this->runningChildIndex = BehaviorTree::NO_RUNNING_CHILD;
+
+	for (auto& child : this->children)
+	{
+		if (child != nullptr)
+		{
+			child->reset();
+		}
+	}
+}
+
+const bool BehaviorTree::CompositeNode::cloneChildrenInto(BehaviorTree::CompositeNode& copy)
+{
+	copy.maxChildrenSize = this->maxChildrenSize;
+	copy.errorPolicy = this->errorPolicy;
+
+	for (auto& child : this->children)
+	{
+		if (child == nullptr)
+		{
+			continue;
+		}
+
+		std::unique_ptr<BehaviorTree::Node> childCopy = child->clone();
+		if (childCopy == nullptr)
+		{
+			// A leaf below doesn't override clone. Whole copy is unusable.
+			return false;
+		}
+
+		copy.addChild(std::move(childCopy));
+	}
+
+	return true;
+}
+
+BehaviorTree::Node* BehaviorTree::CompositeNode::childAt(const int i)
+{
+	if (this->updateOrder.empty())
+	{
+		// Natural order
+		return this->children.at(i).get();
+	}
+	else
+	{
+		// Visit through the index array
+		return this->children.at(this->updateOrder.at(i)).get();
+	}
+}
+
+void BehaviorTree::CompositeNode::shuffleUpdateOrder(unsigned int& rngState)
+{
+	const int size = static_cast<int>(this->children.size());
+
+	if (static_cast<int>(this->updateOrder.size()) != size)
+	{
+		// Shouldn't happen: construction primes the buffer and addChild
+		// keeps it sized (@see primeUpdateOrder), so ticking never grows
+		// it. Kept as a safety net for children changed some new way.
+		this->primeUpdateOrder();
+	}
+
+	// Fisher-Yates over the index array. unique_ptrs never move.
+	for (int i = size - 1; i > 0; i--)
+	{
+		const int j = static_cast<int>(xorshift32(rngState) % static_cast<unsigned int>(i + 1));
+		std::swap(this->updateOrder.at(i), this->updateOrder.at(j));
+	}
+}
+
+void BehaviorTree::CompositeNode::primeUpdateOrder()
+{
+	const int size = static_cast<int>(this->children.size());
+
+	this->updateOrder.resize(size);
+
+	for (int i = 0; i < size; i++)
+	{
+		this->updateOrder.at(i) = i;
+	}
+}
+
+const bool BehaviorTree::CompositeNode::isRunningChildIndexValid()
+{
+	int size = static_cast<int>(this->children.size());
+	return (this->runningChildIndex < size) && (this->runningChildIndex != BehaviorTree::NO_RUNNING_CHILD);
+}
+
+const BehaviorTree::NODE_STATE BehaviorTree::CompositeNode::updateRunningChild(const float delta, int& start)
+{
+	int size = static_cast<int>(this->children.size());
+
+	//check if this selector has running child and make sure it's in the range
+	if (this->runningChildIndex < size)
+	{
+		// This selector has running child and it's in range of children size.
+		// Update running node and get result.
+		BehaviorTree::NODE_STATE state = this->childAt(this->runningChildIndex)->update(delta);
+
+		if (state == BehaviorTree::NODE_STATE::RUNNING)
+		{
+			// Still running. Keep go on.
+			return state;
+		}
+		else if (state == BehaviorTree::NODE_STATE::SUCCESS)
+		{
+			// Success. Reset running child index.
+			this->runningChildIndex = BehaviorTree::NO_RUNNING_CHILD;
+			// Because it's selector, ends here.
+			return state;
+		}
+		else
+		{
+			// Else, status is FAILURE or ignorable ERROR.
+			// Set start index after the running child index.
+			start = this->runningChildIndex + 1;
+			// Reset running child index
+			this->runningChildIndex = BehaviorTree::NO_RUNNING_CHILD;
+		}
+	}
+	// else, there was no running child
+	return BehaviorTree::NODE_STATE::FAILURE;
+}
+
+const BehaviorTree::NODE_STATE BehaviorTree::CompositeNode::updateChildren(const int start, const float delta, const BehaviorTree::NODE_STATE continueCondition)
+{
+	// If running childe node returned FAILURE or ERROR, keep go on.
+	int size = static_cast<int>(this->children.size());
+	for (int i = start; i < size; i++)
+	{
+		BehaviorTree::Node* child = this->childAt(i);
+		if (child != nullptr)
+		{
+			// Update node
+			BehaviorTree::NODE_STATE state = child->update(delta);
+
+			// Check status
+			if (state == continueCondition)
+			{
+				// If this is selector, state must be FAILURE to continue.
+				// If this is sequence, state must be SUCCESS to continue.
+				continue;
+			}
+			else if (state == BehaviorTree::NODE_STATE::ERROR)
+			{
+				// Error occured.
+				if (this->errorPolicy == BehaviorTree::ERROR_POLICY::IGNORE)
+				{
+					// Can ignore error. 
+					continue;
+				}
+				else
+				{
+					// Terminate. Return ERROR.
+					return state;
+				}
+			}
+			else if (state == BehaviorTree::NODE_STATE::RUNNING)
+			{
+				// Set this node as running child
+				this->runningChildIndex = i;
+				return state;
+			}
+			else
+			{
+				// If this is selector, this is SUCCESS. Return.
+				// If this is sequence, this is FAILURE. Return.
+				return state;
+			}
+		}
+	}
+
+	// Iterated all children
+	// If this is selector, every child failed. Return FAILURE.
+	// If this is sequence, every child succeeded. Return SUCCESS.
+	return continueCondition;
+}
+
+BehaviorTree::CompositeNode::~CompositeNode()
+{
+	// Delete children
+	clearChildren();
+}
+
+
+
+
+
+BehaviorTree::Selector::Selector(std::unique_ptr<BehaviorTree::Node> child) 
+: BehaviorTree::CompositeNode(std::move(child)) 
+, reactive(false)
+{}
+
+BehaviorTree::Selector::Selector(std::vector<std::unique_ptr<BehaviorTree::Node>>& children) 
+: BehaviorTree::CompositeNode(children) 
+, reactive(false)
+{}
+
+void BehaviorTree::Selector::setReactive(const bool reactive)
+{
+	this->reactive = reactive;
+}
+
+const bool BehaviorTree::Selector::isReactive()
+{
+	return this->reactive;
+}
+
+const bool BehaviorTree::Selector::preempt(const int childIndex)
+{
+	if (childIndex < 0 || childIndex >= static_cast<int>(this->children.size()))
+	{
+		return false;
+	}
+
+	if (this->isRunningChildIndexValid() == false)
+	{
+		// Nothing running; the next update evaluates lanes top down anyway
+		return false;
+	}
+
+	if (childIndex >= this->runningChildIndex)
+	{
+		// The running branch already has equal or higher priority
+		return false;
+	}
+
+	// Reset only the abandoned path
+	BehaviorTree::Node* running = this->childAt(this->runningChildIndex);
+	if (running != nullptr)
+	{
+		running->reset();
+	}
+
+	// The next update enters directly at the preempting branch through the
+	// running child slot; higher priority lanes are not re-evaluated. If
+	// the branch fails, the lanes after it run as usual.
+	this->runningChildIndex = childIndex;
+
+	return true;
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::Selector::clone()
+{
+	std::unique_ptr<BehaviorTree::Selector> copy(new BehaviorTree::Selector(nullptr));
+	copy->setReactive(this->reactive);
+
+	if (this->cloneChildrenInto(*copy) == false)
+	{
+		return nullptr;
+	}
+
+	return std::unique_ptr<BehaviorTree::Node>(copy.release());
+}
+
+BehaviorTree::Condition* BehaviorTree::Selector::getBranchGuard(const int i)
+{
+	BehaviorTree::Node* child = this->childAt(i);
+
+	if (child == nullptr)
+	{
+		return nullptr;
+	}
+
+	// The branch itself can be a condition
+	BehaviorTree::Condition* condition = dynamic_cast<BehaviorTree::Condition*>(child);
+	if (condition != nullptr)
+	{
+		return condition;
+	}
+
+	// Common guard pattern: sequence whose first child is a condition
+	BehaviorTree::Sequence* sequence = dynamic_cast<BehaviorTree::Sequence*>(child);
+	if (sequence != nullptr && sequence->getChildren().empty() == false)
+	{
+		return dynamic_cast<BehaviorTree::Condition*>(sequence->getChildren().front().get());
+	}
+
+	return nullptr;
+}
+
+BehaviorTree::Selector::~Selector() {}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Selector::update(const float delta)
+{
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::SELECTOR);
+
+	if (this->children.empty())
+	{
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	int start = 0;
+
+	if (this->reactive && this->isRunningChildIndexValid())
+	{
+		// Observer aborts. Check higher priority branches whose observed
+		// condition was flagged dirty. Clean branches are not re-evaluated.
+		for (int i = 0; i < this->runningChildIndex; i++)
+		{
+			BehaviorTree::Condition* guard = this->getBranchGuard(i);
+
+			if (guard != nullptr && guard->isDirty())
+			{
+				if (guard->update(delta) == BehaviorTree::NODE_STATE::SUCCESS)
+				{
+					// Condition flipped to viable. Abort the running branch
+					// and re-enter at this higher priority branch.
+					this->childAt(this->runningChildIndex)->reset();
+					this->runningChildIndex = BehaviorTree::NO_RUNNING_CHILD;
+					BT_PROFILE_RETURN(this->updateChildren(i, delta, BehaviorTree::NODE_STATE::FAILURE));
+				}
+			}
+		}
+	}
+
+	// Update running child if there's one.
+	if (this->isRunningChildIndexValid())
+	{
+		const BehaviorTree::NODE_STATE runningChildstate = BehaviorTree::CompositeNode::updateRunningChild(delta, start);
+
+		if (runningChildstate == BehaviorTree::NODE_STATE::SUCCESS || 
+			runningChildstate == BehaviorTree::NODE_STATE::RUNNING)
+		{
+			// Stop and return
+			BT_PROFILE_RETURN(runningChildstate);
+		}
+		else if (runningChildstate == BehaviorTree::NODE_STATE::ERROR)
+		{
+			// It was error.
+			if (this->errorPolicy == BehaviorTree::ERROR_POLICY::TERMINATE)
+			{
+				// Can't ignore error. Return.
+				BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+			}
+		}
+		// Else, it was either FAILURE or ERROR that can be ignored.
+	}
+
+	// Update children
+	BT_PROFILE_RETURN(this->updateChildren(start, delta, BehaviorTree::NODE_STATE::FAILURE));
+}
+
+
+
+
+
+BehaviorTree::RandomSelector::RandomSelector(std::unique_ptr<BehaviorTree::Node> child)
+: BehaviorTree::Selector(std::move(child))
+, needShuffle(true)
+, rngState(seedRngState())
+{
+	// Size the permutation buffer now, not on the first shuffled tick
+	this->primeUpdateOrder();
+}
+
+BehaviorTree::RandomSelector::RandomSelector(std::vector<std::unique_ptr<BehaviorTree::Node>>& children)
+: BehaviorTree::Selector(children)
+, needShuffle(true)
+, rngState(seedRngState())
+{
+	this->primeUpdateOrder();
+}
+
+BehaviorTree::RandomSelector::~RandomSelector() {}
+
+const BehaviorTree::NODE_STATE BehaviorTree::RandomSelector::update(const float delta)
+{
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::RANDOM_SELECTOR);
+
+	if (this->children.empty())
+	{
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	// No need to shuffle children if there's only one child
+	if (this->runningChildIndex == BehaviorTree::NO_RUNNING_CHILD && needShuffle && this->children.size() > 1)
+	{
+		// Shuffle the cached index permutation. Children never move.
+		this->shuffleUpdateOrder(this->rngState);
+	}
+	
+	BehaviorTree::NODE_STATE state = BehaviorTree::Selector::update(delta);
+
+	if (state == BehaviorTree::NODE_STATE::RUNNING)
+	{
+		// If random selector is still running, don't shuffle
+		this->needShuffle = false;
+	}
+	else
+	{
+		// If random selector is not running, shuffle it!
+		this->needShuffle = true;
+	}
+
+	BT_PROFILE_RETURN(state);
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::RandomSelector::clone()
+{
+	// Runtime state (shuffle flag, PRNG) starts fresh in the copy
+	std::unique_ptr<BehaviorTree::RandomSelector> copy(new BehaviorTree::RandomSelector(nullptr));
+	copy->setReactive(this->isReactive());
+
+	if (this->cloneChildrenInto(*copy) == false)
+	{
+		return nullptr;
+	}
+
+	// Children arrived after construction; size the permutation buffer
+	copy->primeUpdateOrder();
+
+	return std::unique_ptr<BehaviorTree::Node>(copy.release());
+}
+
+
+
+
+BehaviorTree::Sequence::Sequence(std::unique_ptr<BehaviorTree::Node> child)
+: BehaviorTree::CompositeNode(std::move(child))
+{}
+
+BehaviorTree::Sequence::Sequence(std::vector<std::unique_ptr<BehaviorTree::Node>>& children)
+: BehaviorTree::CompositeNode(children)
+{}
+
+BehaviorTree::Sequence::~Sequence() {}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Sequence::update(const float delta)
+{
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::SEQUENCE);
+
+	if (this->children.empty())
+	{
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	int start = 0;
+
+	// Update running child if there's one.
+	if (this->isRunningChildIndexValid())
+	{
+		const BehaviorTree::NODE_STATE runningChildstate = BehaviorTree::CompositeNode::updateRunningChild(delta, start);
+
+		if (runningChildstate == BehaviorTree::NODE_STATE::FAILURE ||
+			runningChildstate == BehaviorTree::NODE_STATE::RUNNING)
+		{
+			// If failed, stop sequence.
+			// If it's still running, keep running.
+			BT_PROFILE_RETURN(runningChildstate);
+		}
+		else if (runningChildstate == BehaviorTree::NODE_STATE::ERROR)
+		{
+			// Error occured
+			if (this->errorPolicy == BehaviorTree::ERROR_POLICY::TERMINATE)
+			{
+				// Can't ignore error. Return.
+				BT_PROFILE_RETURN(runningChildstate);
+			}
+			// Else, this error can be ignored and considered as SUCCESS. keep go on.
+		}
+		// Else, if status is SUCCESS, keep go on.
+	}
+
+	// Update children
+	BT_PROFILE_RETURN(this->updateChildren(start, delta, BehaviorTree::NODE_STATE::SUCCESS));
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::Sequence::clone()
+{
+	std::unique_ptr<BehaviorTree::Sequence> copy(new BehaviorTree::Sequence(nullptr));
+
+	if (this->cloneChildrenInto(*copy) == false)
+	{
+		return nullptr;
+	}
+
+	return std::unique_ptr<BehaviorTree::Node>(copy.release());
+}
+
+
+
+
+BehaviorTree::RandomSequence::RandomSequence(std::unique_ptr<BehaviorTree::Node> child)
+: BehaviorTree::Sequence(std::move(child))
+, needShuffle(true)
+, rngState(seedRngState())
+{
+	// Size the permutation buffer now, not on the first shuffled tick
+	this->primeUpdateOrder();
+}
+
+BehaviorTree::RandomSequence::RandomSequence(std::vector<std::unique_ptr<BehaviorTree::Node>>& children)
+: BehaviorTree::Sequence(children)
+, needShuffle(true)
+, rngState(seedRngState())
+{
+	this->primeUpdateOrder();
+}
+
+BehaviorTree::RandomSequence::~RandomSequence() {}
+
+const BehaviorTree::NODE_STATE BehaviorTree::RandomSequence::update(const float delta)
+{
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::RANDOM_SEQUENCE);
+
+	if (this->children.empty())
+	{
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	if (this->runningChildIndex == BehaviorTree::NO_RUNNING_CHILD && needShuffle && this->children.size() > 1)
+	{
+		// Shuffle the cached index permutation. Children never move.
+		this->shuffleUpdateOrder(this->rngState);
+	}
+
+	BehaviorTree::NODE_STATE state = BehaviorTree::Sequence::update(delta);
+
+	if (state == BehaviorTree::NODE_STATE::RUNNING)
+	{
+		// If random selector is still running, don't shuffle
+		this->needShuffle = false;
+	}
+	else
+	{
+		// If random selector is not running, shuffle it!
+		this->needShuffle = true;
+	}
+
+	BT_PROFILE_RETURN(state);
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::RandomSequence::clone()
+{
+	// Runtime state (shuffle flag, PRNG) starts fresh in the copy
+	std::unique_ptr<BehaviorTree::RandomSequence> copy(new BehaviorTree::RandomSequence(nullptr));
+
+	if (this->cloneChildrenInto(*copy) == false)
+	{
+		return nullptr;
+	}
+
+	// Children arrived after construction; size the permutation buffer
+	copy->primeUpdateOrder();
+
+	return std::unique_ptr<BehaviorTree::Node>(copy.release());
+}
+
+
+
+
+BehaviorTree::Parallel::Parallel(std::unique_ptr<BehaviorTree::Node> child, const BehaviorTree::Parallel::POLICY successPolicy, const BehaviorTree::Parallel::POLICY failurePolicy)
+: BehaviorTree::CompositeNode(std::move(child))
+, successPolicy(successPolicy)
+, failurePolicy(failurePolicy)
+, concurrent(false)
+{}
+
+BehaviorTree::Parallel::Parallel(std::vector<std::unique_ptr<BehaviorTree::Node>>& children, const BehaviorTree::Parallel::POLICY successPolicy, const BehaviorTree::Parallel::POLICY failurePolicy)
+: BehaviorTree::CompositeNode(children)
+, successPolicy(successPolicy)
+, failurePolicy(failurePolicy)
+, concurrent(false)
+{}
+
+BehaviorTree::Parallel::~Parallel() {}
+
+void BehaviorTree::Parallel::finish()
+{
+	const int childrenSize = static_cast<int>(this->children.size());
+
+	for (int i = 0; i < childrenSize; i++)
+	{
+		if (this->childStates.at(i) == BehaviorTree::NODE_STATE::RUNNING)
+		{
+			// The vote was decided without this child. Abort it.
+			this->childAt(i)->reset();
+		}
+	}
+
+	// Next update starts a fresh run
+	this->childStates.clear();
+}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Parallel::update(const float delta)
+{
+	// Stays LEAF when baked, so profiled as one
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::LEAF);
+
+	const int childrenSize = static_cast<int>(this->children.size());
+
+	if (childrenSize == 0)
+	{
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	if (static_cast<int>(this->childStates.size()) != childrenSize)
+	{
+		// Fresh run. Every child takes part.
+		this->childStates.assign(childrenSize, BehaviorTree::NODE_STATE::RUNNING);
+	}
+
+	if (this->concurrent)
+	{
+		// Dispatch every still running child as a task and join. Worth the
+		// thread spawns only when children are heavyweight subtrees.
+		std::vector<std::thread> tasks;
+		tasks.reserve(childrenSize);
+
+		for (int i = 0; i < childrenSize; i++)
+		{
+			if (this->childStates.at(i) == BehaviorTree::NODE_STATE::RUNNING)
+			{
+				BehaviorTree::Node* child = this->childAt(i);
+				BehaviorTree::NODE_STATE* slot = &this->childStates.at(i);
+
+				tasks.push_back(std::thread([child, slot, delta]()
+				{
+					*slot = child->update(delta);
+				}));
+			}
+		}
+
+		for (auto& task : tasks)
+		{
+			task.join();
+		}
+	}
+	else
+	{
+		for (int i = 0; i < childrenSize; i++)
+		{
+			if (this->childStates.at(i) == BehaviorTree::NODE_STATE::RUNNING)
+			{
+				this->childStates.at(i) = this->childAt(i)->update(delta);
+			}
+		}
+	}
+
+	// Count the votes
+	int successCount = 0;
+	int failureCount = 0;
+
+	for (int i = 0; i < childrenSize; i++)
+	{
+		const BehaviorTree::NODE_STATE childState = this->childStates.at(i);
+
+		if (childState == BehaviorTree::NODE_STATE::SUCCESS)
+		{
+			successCount++;
+		}
+		else if (childState == BehaviorTree::NODE_STATE::FAILURE)
+		{
+			failureCount++;
+		}
+		else if (childState == BehaviorTree::NODE_STATE::ERROR)
+		{
+			if (this->errorPolicy == BehaviorTree::ERROR_POLICY::TERMINATE)
+			{
+				// Can't ignore error. Abort the run and return.
+				this->finish();
+				BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+			}
+
+			// Ignored errors vote as FAILURE, same as Selector treats them
+			failureCount++;
+		}
+	}
+
+	// Success policy is checked first
+	if ((this->successPolicy == BehaviorTree::Parallel::POLICY::REQUIRE_ONE && successCount >= 1) ||
+		(this->successPolicy == BehaviorTree::Parallel::POLICY::REQUIRE_ALL && successCount == childrenSize))
+	{
+		this->finish();
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::SUCCESS);
+	}
+
+	if ((this->failurePolicy == BehaviorTree::Parallel::POLICY::REQUIRE_ONE && failureCount >= 1) ||
+		(this->failurePolicy == BehaviorTree::Parallel::POLICY::REQUIRE_ALL && failureCount == childrenSize))
+	{
+		this->finish();
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::FAILURE);
+	}
+
+	// Neither vote met yet. Check that a vote still can be met: when every
+	// child finished, the run can't progress further; treat as FAILURE.
+	if (successCount + failureCount == childrenSize)
+	{
+		this->finish();
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::FAILURE);
+	}
+
+	BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::RUNNING);
+}
+
+void BehaviorTree::Parallel::setConcurrent(const bool concurrent)
+{
+	this->concurrent = concurrent;
+}
+
+const bool BehaviorTree::Parallel::isConcurrent()
+{
+	return this->concurrent;
+}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Parallel::getChildState(const int i)
+{
+	if (i < 0 || i >= static_cast<int>(this->childStates.size()))
+	{
+		return BehaviorTree::NODE_STATE::RUNNING;
+	}
+
+	return this->childStates.at(i);
+}
+
+void BehaviorTree::Parallel::reset()
+{
+	this->childStates.clear();
+	BehaviorTree::CompositeNode::reset();
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::Parallel::clone()
+{
+	// Policies and the dispatch flag are parameters; progress starts fresh
+	std::unique_ptr<BehaviorTree::Parallel> copy(new BehaviorTree::Parallel(nullptr, this->successPolicy, this->failurePolicy));
+	copy->setConcurrent(this->concurrent);
+
+	if (this->cloneChildrenInto(*copy) == false)
+	{
+		return nullptr;
+	}
+
+	return std::unique_ptr<BehaviorTree::Node>(copy.release());
+}
+
+
+
+
+BehaviorTree::DecoratorNode::DecoratorNode(std::unique_ptr<BehaviorTree::Node> child)
+{
+	addChild(std::move(child));
+}
+
+BehaviorTree::DecoratorNode::~DecoratorNode()
+{
+	// Unique ptr will release for us
+	this->child = nullptr;
+}
+
+void BehaviorTree::DecoratorNode::setErrorPolicy(const BehaviorTree::ERROR_POLICY errorPolicy)
+{
+	// Decorators keep no policy of their own; pass it through
+	if (this->child != nullptr)
+	{
+		this->child->setErrorPolicy(errorPolicy);
+	}
+}
+
+void BehaviorTree::DecoratorNode::reset()
+{
+	if (this->child != nullptr)
+	{
+		this->child->reset();
+	}
+}
+
+const bool BehaviorTree::DecoratorNode::cloneChild(std::unique_ptr<BehaviorTree::Node>& copy)
+{
+	if (this->child == nullptr)
+	{
+		// Nothing to copy. The clone decorates nothing, same as this one.
+		return true;
+	}
+
+	copy = this->child->clone();
+
+	return copy != nullptr;
+}
+
+void BehaviorTree::DecoratorNode::addChild(std::unique_ptr<BehaviorTree::Node> child, const bool overwrite)
+{
+	if (child == nullptr)
+	{
+		this->child = std::move(child);
+	}
+	else
+	{
+		if (overwrite)
+		{
+			// unique_ptr will release for us
+			this->child = nullptr;
+			// move ptr
+			this->child = std::move(child);
+		}
+	}
+}
+
+
+
+
+BehaviorTree::Inverter::Inverter() : BehaviorTree::DecoratorNode(nullptr) {}
+
+BehaviorTree::Inverter::Inverter(std::unique_ptr<BehaviorTree::Node> child) : BehaviorTree::DecoratorNode(std::move(child)) {}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Inverter::update(const float delta)
+{
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::INVERTER);
+
+	// Update child
+	if (this->child == nullptr)
+	{
+		// Doesn't have child. Return ERROR
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	BehaviorTree::NODE_STATE state = this->child->update(delta);
+
+	if (state == BehaviorTree::NODE_STATE::RUNNING || state == BehaviorTree::NODE_STATE::ERROR)
+	{
+		BT_PROFILE_RETURN(state);
+	}
+	else
+	{
+		// If status was SUCCESS or FAILURE, invert result.
+		BT_PROFILE_RETURN(state == BehaviorTree::NODE_STATE::SUCCESS ? BehaviorTree::NODE_STATE::FAILURE : BehaviorTree::NODE_STATE::SUCCESS);
+	}
+
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::Inverter::clone()
+{
+	std::unique_ptr<BehaviorTree::Node> childCopy = nullptr;
+	if (this->cloneChild(childCopy) == false)
+	{
+		return nullptr;
+	}
+
+	return std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Inverter(std::move(childCopy)));
+}
+
+
+
+
+
+BehaviorTree::Succeeder::Succeeder() : BehaviorTree::DecoratorNode(nullptr) {}
+
+BehaviorTree::Succeeder::Succeeder(std::unique_ptr<BehaviorTree::Node> child) : BehaviorTree::DecoratorNode(std::move(child)) {}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Succeeder::update(const float delta)
+{
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::SUCCEEDER);
+
+	if (this->child == nullptr)
+	{
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	// Update child. We don't need the result
+	this->child->update(delta);
+	// Always return SUCCSS.
+	BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::Succeeder::clone()
+{
+	std::unique_ptr<BehaviorTree::Node> childCopy = nullptr;
+	if (this->cloneChild(childCopy) == false)
+	{
+		return nullptr;
+	}
+
+	return std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Succeeder(std::move(childCopy)));
+}
+
+
+
+
+
+BehaviorTree::Failer::Failer() : BehaviorTree::DecoratorNode(nullptr) {}
+
+BehaviorTree::Failer::Failer(std::unique_ptr<BehaviorTree::Node> child) : BehaviorTree::DecoratorNode(std::move(child)) {}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Failer::update(const float delta)
+{
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::FAILER);
+
+	if (this->child == nullptr)
+	{
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	// Update child. We don't need the result
+	this->child->update(delta);
+	// Always return FAILURE.
+	BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::FAILURE);
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::Failer::clone()
+{
+	std::unique_ptr<BehaviorTree::Node> childCopy = nullptr;
+	if (this->cloneChild(childCopy) == false)
+	{
+		return nullptr;
+	}
+
+	return std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Failer(std::move(childCopy)));
+}
+
+
+
+
+BehaviorTree::Repeat::Repeat(const int repeat) : BehaviorTree::DecoratorNode(nullptr)
+{
+	this->setRepeat(repeat);
+}
+
+BehaviorTree::Repeat::Repeat(std::unique_ptr<BehaviorTree::Node> child, const int repeat) : BehaviorTree::DecoratorNode(std::move(child))
+{
+	this->setRepeat(repeat);
+}
+
+void BehaviorTree::Repeat::setRepeat(const int repeat)
+{
+	if (repeat < 0 && repeat != BehaviorTree::Repeat::REPEAT_INFINITE)
+	{
+		this->repeat = 0;
+	}
+	else
+	{
+		this->repeat = repeat;
+	}
+}
+
+const int BehaviorTree::Repeat::getRepeat()
+{
+	return this->repeat;
+}
+
+
+
+
+BehaviorTree::Repeater::Repeater(const int repeat) : BehaviorTree::Repeat(repeat) 
+{
+	if (repeat == BehaviorTree::Repeat::REPEAT_INFINITE)
+	{
+		// Repeater can't have infinite because it faills to infinite loop
+		this->repeat = 0;
+	}
+}
+
+BehaviorTree::Repeater::Repeater(std::unique_ptr<BehaviorTree::Node> child, const int repeat) : BehaviorTree::Repeat(std::move(child), repeat)
+{
+	if (repeat == BehaviorTree::Repeat::REPEAT_INFINITE)
+	{
+		// Repeater can't have infinite because it faills to infinite loop
+		this->repeat = 0;
+	}
+}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Repeater::update(const float delta)
+{
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::REPEATER);
+
+	if (this->repeat == 0)
+	{
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	// Repeat update for certain amount of times.
+	for (int i = 0; i < repeat; i++)
+	{
+		// Update child.
+		BehaviorTree::NODE_STATE state = this->child->update(delta);
+		if (state == BehaviorTree::NODE_STATE::SUCCESS || state == BehaviorTree::NODE_STATE::FAILURE)
+		{
+			// If status was SUCCESS or FAILURE, keep go on
+			continue;
+		}
+		else
+		{
+			BT_PROFILE_RETURN(state);
+		}
+	}
+	
+	// Finished repeating. Return SUCCESS
+	BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::Repeater::clone()
+{
+	std::unique_ptr<BehaviorTree::Node> childCopy = nullptr;
+	if (this->cloneChild(childCopy) == false)
+	{
+		return nullptr;
+	}
+
+	return std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Repeater(std::move(childCopy), this->repeat));
+}
+
+
+
+
+BehaviorTree::RepeatUntil::RepeatUntil(const int repeat, const BehaviorTree::NODE_STATE conditionStatus) : BehaviorTree::Repeat(repeat), desiredStatus(conditionStatus) {}
+
+BehaviorTree::RepeatUntil::RepeatUntil(std::unique_ptr<BehaviorTree::Node> child, const int repeat, const BehaviorTree::NODE_STATE conditionStatus) : BehaviorTree::Repeat(std::move(child), repeat), desiredStatus(conditionStatus) {}
+
+const BehaviorTree::NODE_STATE BehaviorTree::RepeatUntil::update(const float delta)
+{
+	BT_PROFILE_SCOPE((this->desiredStatus == BehaviorTree::NODE_STATE::FAILURE) ? BehaviorTree::NODE_TYPE::REPEAT_UNTIL_FAIL : BehaviorTree::NODE_TYPE::REPEAT_UNTIL_SUCCESS);
+
+	if (this->repeat == 0)
+	{
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	if (this->repeat == BehaviorTree::Repeat::REPEAT_INFINITE)
+	{
+		BehaviorTree::NODE_STATE state;
+		// Run infitie loop until status is failure
+		do
+		{
+			// Update child.
+			state = this->child->update(delta);
+		} while (state != this->desiredStatus);
+
+		// Finished repeating. Return SUCCESS
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::SUCCESS);
+	}
+	else
+	{
+		// Repeat update for certain amount of times.
+		for (int i = 0; i < this->repeat; i++)
+		{
+			// Update child.
+			BehaviorTree::NODE_STATE state = this->child->update(delta);
+			if (state == this->desiredStatus)
+			{
+				// Failed. return success.
+				BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::SUCCESS);
+			}
+			// Else, continue.
+		}
+
+		// Finished repeating. Haven't failed. Return FAILURE
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::FAILURE);
+	}
+}
+
+
+
+
+
+
+BehaviorTree::RepeatUntilFail::RepeatUntilFail(const int repeat) : BehaviorTree::RepeatUntil(repeat, BehaviorTree::NODE_STATE::FAILURE) {}
+
+BehaviorTree::RepeatUntilFail::RepeatUntilFail(std::unique_ptr<BehaviorTree::Node> child, const int repeat) : BehaviorTree::RepeatUntil(std::move(child), repeat, BehaviorTree::NODE_STATE::FAILURE) {}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::RepeatUntilFail::clone()
+{
+	std::unique_ptr<BehaviorTree::Node> childCopy = nullptr;
+	if (this->cloneChild(childCopy) == false)
+	{
+		return nullptr;
+	}
+
+	return std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::RepeatUntilFail(std::move(childCopy), this->repeat));
+}
+
+
+
+
+
+BehaviorTree::RepeatUntilSuccess::RepeatUntilSuccess(const int repeat) : BehaviorTree::RepeatUntil(repeat, BehaviorTree::NODE_STATE::SUCCESS) {}
+
+BehaviorTree::RepeatUntilSuccess::RepeatUntilSuccess(std::unique_ptr<BehaviorTree::Node> child, const int repeat) : BehaviorTree::RepeatUntil(std::move(child), repeat, BehaviorTree::NODE_STATE::SUCCESS) {}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::RepeatUntilSuccess::clone()
+{
+	std::unique_ptr<BehaviorTree::Node> childCopy = nullptr;
+	if (this->cloneChild(childCopy) == false)
+	{
+		return nullptr;
+	}
+
+	return std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::RepeatUntilSuccess(std::move(childCopy), this->repeat));
+}
+
+
+
+
+BehaviorTree::Limiter::Limiter(const int limit) : BehaviorTree::DecoratorNode(nullptr), limit(limit), limitCount(0) {}
+
+BehaviorTree::Limiter::Limiter(std::unique_ptr<BehaviorTree::Node> child, const int limit) : BehaviorTree::DecoratorNode(std::move(child)), limit(limit), limitCount(0) {}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Limiter::update(const float delta)
+{
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::LIMITER);
+
+	if (this->child == nullptr)
+	{
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	if (this->limitCount < this->limit)
+	{
+		// Still can execute this node
+		BehaviorTree::NODE_STATE state = this->child->update(delta);
+		this->limitCount++;
+
+		BT_PROFILE_RETURN(state);
+	}
+
+	BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::FAILURE);
+}
+
+void BehaviorTree::Limiter::reset()
+{
+	this->limitCount = 0;
+
+	BehaviorTree::DecoratorNode::reset();
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::Limiter::clone()
+{
+	std::unique_ptr<BehaviorTree::Node> childCopy = nullptr;
+	if (this->cloneChild(childCopy) == false)
+	{
+		return nullptr;
+	}
+
+	// Copy carries the limit, not the spent count
+	return std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Limiter(std::move(childCopy), this->limit));
+}
+
+
+
+
+BehaviorTree::DelayTime::DelayTime(const float duration, const bool delayOnce) : BehaviorTree::DecoratorNode(nullptr), duration(duration), elapsedTime(0), delayOnce(delayOnce), childUpdateFinished(false) {}
+
+BehaviorTree::DelayTime::DelayTime(std::unique_ptr<BehaviorTree::Node> child, const float duration, const bool delayOnce) : BehaviorTree::DecoratorNode(std::move(child)), duration(duration), elapsedTime(0), delayOnce(delayOnce), childUpdateFinished(false) {}
+
+const BehaviorTree::NODE_STATE BehaviorTree::DelayTime::update(const float delta)
+{
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::DELAY_TIME);
+
+	if (this->child == nullptr)
+	{
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	if (this->duration <= 0)
+	{
+		// No delay at all. Plain pass-through.
+		this->result = this->child->update(delta);
+		BT_PROFILE_RETURN(this->result);
+	}
+
+	if (this->delayOnce && this->childUpdateFinished)
+	{
+		// Delayed and updated once for good. Keep reporting the result.
+		BT_PROFILE_RETURN(this->result);
+	}
+
+	// Consume time first, so one large accumulated delta (an agent ticked
+	// at reduced rate) can end the delay, run the child and start delaying
+	// again, all in this update.
+	this->elapsedTime += delta;
+
+	bool executed = false;
+	while (this->elapsedTime >= this->duration)
+	{
+		if (this->childUpdateFinished == false)
+		{
+			// The child starts where the delay ended; it gets the overshoot
+			this->result = this->child->update(this->elapsedTime - this->duration);
+			executed = true;
+
+			if (this->result == BehaviorTree::NODE_STATE::RUNNING)
+			{
+				// Child is working. Hold the clock at the end of the delay.
+				this->elapsedTime = this->duration;
+				BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::RUNNING);
+			}
+
+			this->childUpdateFinished = true;
+		}
+
+		if (this->delayOnce)
+		{
+			BT_PROFILE_RETURN(this->result);
+		}
+
+		// Cycle complete. Consume one period and delay again; leftover time
+		// can expire further cycles in this same catch-up update.
+		this->elapsedTime -= this->duration;
+		this->childUpdateFinished = false;
+	}
+
+	if (executed)
+	{
+		// At least one cycle fired this update. Report the child's result.
+		BT_PROFILE_RETURN(this->result);
+	}
+
+	// Mid delay
+	BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::RUNNING);
+}
+
+void BehaviorTree::DelayTime::reset()
+{
+	this->elapsedTime = 0;
+	this->childUpdateFinished = false;
+	this->result = BehaviorTree::NODE_STATE::FAILURE;
+
+	BehaviorTree::DecoratorNode::reset();
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::DelayTime::clone()
+{
+	std::unique_ptr<BehaviorTree::Node> childCopy = nullptr;
+	if (this->cloneChild(childCopy) == false)
+	{
+		return nullptr;
+	}
+
+	// Copy carries the duration, not the elapsed clock
+	return std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::DelayTime(std::move(childCopy), this->duration, this->delayOnce));
+}
+
+
+
+
+BehaviorTree::TimeLimit::TimeLimit(const float duration) : BehaviorTree::DecoratorNode(nullptr), duration(duration), elapsedTime(0), failed(false) {}
+
+BehaviorTree::TimeLimit::TimeLimit(std::unique_ptr<BehaviorTree::Node> child, const float duration) : BehaviorTree::DecoratorNode(std::move(child)), duration(duration), elapsedTime(0), failed(false) {}
+
+const BehaviorTree::NODE_STATE BehaviorTree::TimeLimit::update(const float delta)
+{
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::TIME_LIMIT);
+
+	if (this->child == nullptr)
+	{
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	// The child runs under the clock from the first update. Time is added
+	// before the check, so one large accumulated delta (an agent ticked at
+	// reduced rate) expires the window in the same update it is delivered.
+	this->elapsedTime += delta;
+
+	BehaviorTree::NODE_STATE state = this->child->update(delta);
+
+	if (state != BehaviorTree::NODE_STATE::RUNNING)
+	{
+		// Finished in time. The window restarts for the next run.
+		this->elapsedTime = 0;
+		BT_PROFILE_RETURN(state);
+	}
+
+	if (this->elapsedTime >= this->duration)
+	{
+		// Out of time with the child still working. Failed.
+		this->elapsedTime = 0;
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::FAILURE);
+	}
+
+	BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::RUNNING);
+}
+
+void BehaviorTree::TimeLimit::reset()
+{
+	this->elapsedTime = 0;
+	this->failed = false;
+
+	BehaviorTree::DecoratorNode::reset();
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::TimeLimit::clone()
+{
+	std::unique_ptr<BehaviorTree::Node> childCopy = nullptr;
+	if (this->cloneChild(childCopy) == false)
+	{
+		return nullptr;
+	}
+
+	// Copy carries the duration, not the elapsed clock
+	return std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::TimeLimit(std::move(childCopy), this->duration));
+}
+
+
+
+
+BehaviorTree::Memoize::Memoize(BehaviorTree::Blackboard* blackboard) : BehaviorTree::DecoratorNode(nullptr), blackboard(blackboard), cachedState(BehaviorTree::NODE_STATE::SUCCESS), hasCache(false) {}
+
+BehaviorTree::Memoize::Memoize(std::unique_ptr<BehaviorTree::Node> child, BehaviorTree::Blackboard* blackboard) : BehaviorTree::DecoratorNode(std::move(child)), blackboard(blackboard), cachedState(BehaviorTree::NODE_STATE::SUCCESS), hasCache(false) {}
+
+const bool BehaviorTree::Memoize::isCacheFresh() const
+{
+	for (const BehaviorTree::Memoize::SeenEntry& seen : this->seenEntries)
+	{
+		if (this->blackboard->getVersion(seen.keyId) != seen.version)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Memoize::update(const float delta)
+{
+	// Stays LEAF when baked, so profiled as one
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::LEAF);
+
+	if (this->child == nullptr)
+	{
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
+	}
+
+	if (this->hasCache && this->isCacheFresh())
+	{
+		// An enclosing Memoize may be recording; its result depends on this
+		// cache's inputs even though the subtree is skipped. Report them.
+		for (const BehaviorTree::Memoize::SeenEntry& seen : this->seenEntries)
+		{
+			this->blackboard->recordRead(seen.keyId);
+		}
+
+		// Nothing the child read was written since. Skip the whole subtree.
+		BT_PROFILE_RETURN(this->cachedState);
+	}
+
+	this->hasCache = false;
+
+	if (this->blackboard == nullptr)
+	{
+		// No blackboard to watch; pass the child through uncached
+		BT_PROFILE_RETURN(this->child->update(delta));
+	}
+
+	this->blackboard->startReadRecording();
+
+	const BehaviorTree::NODE_STATE state = this->child->update(delta);
+
+	const std::vector<int> readKeys = this->blackboard->stopReadRecording();
+
+	if (state == BehaviorTree::NODE_STATE::SUCCESS || state == BehaviorTree::NODE_STATE::FAILURE)
+	{
+		// Remember the inputs of this evaluation with the versions seen,
+		// so one write to any of them invalidates the cache.
+		this->seenEntries.clear();
+
+		for (const int keyId : readKeys)
+		{
+			this->seenEntries.push_back(BehaviorTree::Memoize::SeenEntry{ keyId, this->blackboard->getVersion(keyId) });
+		}
+
+		this->cachedState = state;
+		this->hasCache = true;
+	}
+
+	BT_PROFILE_RETURN(state);
+}
+
+void BehaviorTree::Memoize::invalidate()
+{
+	this->hasCache = false;
+	this->seenEntries.clear();
+}
+
+void BehaviorTree::Memoize::reset()
+{
+	this->invalidate();
+
+	BehaviorTree::DecoratorNode::reset();
+}
+
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::Memoize::clone()
+{
+	std::unique_ptr<BehaviorTree::Node> childCopy = nullptr;
+	if (this->cloneChild(childCopy) == false)
+	{
+		return nullptr;
+	}
+
+	// Copy carries the blackboard, not the cache
+	return std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Memoize(std::move(childCopy), this->blackboard));
+}
+
+
+
+
+BehaviorTree::TickBudget::TickBudget(const int maxNodeVisits, const float maxMicroseconds)
+: maxNodeVisits(maxNodeVisits)
+, maxMicroseconds(maxMicroseconds)
+{}
+
+
+
+
+BehaviorTree::EventQueue::EventQueue(const int capacity)
+: enqueuePosition(0)
+, dequeuePosition(0)
+{
+	// Round capacity up to a power of two, so positions wrap with a mask
+	std::size_t size = 1;
+	while (size < static_cast<std::size_t>(capacity < 1 ? 1 : capacity))
+	{
+		size <<= 1;
+	}
+
+	this->capacityMask = size - 1;
+	this->cells.reset(new Cell[size]);
+
+	for (std::size_t i = 0; i < size; i++)
+	{
+		// Each cell starts as the free cell of its own position
+		this->cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+const bool BehaviorTree::EventQueue::post(const Event& event)
+{
+	std::size_t position = this->enqueuePosition.load(std::memory_order_relaxed);
+
+	while (true)
+	{
+		Cell& cell = this->cells[position & this->capacityMask];
+		const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+
+		if (sequence == position)
+		{
+			// Cell is free for this position. Claim it against other producers.
+			if (this->enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				cell.event = event;
+
+				// Hand the cell to the consumer
+				cell.sequence.store(position + 1, std::memory_order_release);
+				return true;
+			}
+
+			// Lost the race. position was reloaded by compare_exchange; retry.
+		}
+		else if (sequence < position)
+		{
+			// Cell still holds an unconsumed event from a full lap ago. Full.
+			return false;
+		}
+		else
+		{
+			// Another producer claimed this position. Move to the next one.
+			position = this->enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+const bool BehaviorTree::EventQueue::poll(Event& event)
+{
+	Cell& cell = this->cells[this->dequeuePosition & this->capacityMask];
+	const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+
+	if (sequence != this->dequeuePosition + 1)
+	{
+		// Producer hasn't published this position yet. Empty.
+		return false;
+	}
+
+	event = cell.event;
+
+	// Free the cell for the producer one lap ahead
+	cell.sequence.store(this->dequeuePosition + this->capacityMask + 1, std::memory_order_release);
+	this->dequeuePosition++;
+
+	return true;
+}
+
+
+
+
+BehaviorTree::TreeInstance::TreeInstance()
+: nodeCount(0)
+, rngState(0)
+, runningNodeIndex(-1)
+, lastState(BehaviorTree::NODE_STATE::FAILURE)
+, budgetActive(false)
+, budgetExhausted(false)
+, budgetVisitsLeft(BehaviorTree::TickBudget::UNLIMITED)
+, budgetVisitCount(0)
+, budgetTimed(false)
+, lastTickYielded(false)
+#if defined(BT_DEBUG_ALLOC)
+, lastTickAllocationCount(0)
+#endif
+{}
+
+const BehaviorTree::NODE_STATE BehaviorTree::TreeInstance::getLastState()
+{
+	return this->lastState;
+}
+
+const bool BehaviorTree::TreeInstance::getLastTickYielded()
+{
+	return this->lastTickYielded;
+}
+
+#if defined(BT_DEBUG_ALLOC)
+const unsigned long long BehaviorTree::TreeInstance::getLastTickAllocationCount()
+{
+	return this->lastTickAllocationCount;
+}
+#endif
+
+const bool BehaviorTree::TreeInstance::postEvent(const BehaviorTree::Event& event)
+{
+	if (this->events == nullptr)
+	{
+		// Default constructed instance; no tree, no queue
+		return false;
+	}
+
+	return this->events->post(event);
+}
+
+
+
+
+BehaviorTree::Tree::Tree(std::unique_ptr<BehaviorTree::Node> root, const BehaviorTree::ERROR_POLICY errorPolicy)
+: structure(std::make_shared<Structure>())
+{
+	// Take the ownership of the graph first. Leaf nodes must stay alive.
+	this->structure->root = std::move(root);
+	this->structure->errorPolicy = errorPolicy;
+
+	if (this->structure->root != nullptr)
+	{
+		// Rewrite shapes that cost node visits but can't change results,
+		// once here instead of paying them on every tick. @see optimizeNode
+		this->optimizeNode(this->structure->root, true);
+
+		// Push the policy down the original graph too. Nodes that stay
+		// behind virtual calls (reactive selectors) must follow the same rule.
+		this->structure->root->setErrorPolicy(errorPolicy);
+
+		// Flatten the graph in depth first order. Root becomes index 0.
+		this->bakeNode(this->structure->root.get(), -1);
+
+		// Reject malformed shapes at load. @see isValid
+		this->validateStructure();
+	}
+
+	// State for the single-agent front-end
+	this->defaultInstance = this->createInstance();
+}
+
+BehaviorTree::Tree::Tree(std::shared_ptr<Structure> structure)
+: structure(structure)
+{
+	// State for the single-agent front-end
+	this->defaultInstance = this->createInstance();
+}
+
+BehaviorTree::Tree BehaviorTree::Tree::clone()
+{
+	// Structure is read-only after baking, so the clone just shares it.
+	// Only fresh per-agent state is made; no node is copied or allocated.
+	return Tree(this->structure);
+}
+
+BehaviorTree::TreeInstance BehaviorTree::Tree::createInstance()
+{
+	TreeInstance instance;
+
+	instance.nodeCount = static_cast<int>(this->structure->nodes.size());
+
+	// Size each state stream from the slot counts gathered while baking
+	instance.runningChildren.assign(this->structure->runningChildSlotCount, BehaviorTree::NO_RUNNING_CHILD);
+	instance.counters.assign(this->structure->counterSlotCount, 0);
+	instance.timers.assign(this->structure->timerSlotCount, 0.0f);
+	instance.delayElapsed.assign(this->structure->delaySlotCount, 0.0f);
+	instance.delayFinished.assign(this->structure->delaySlotCount, 0);
+	instance.delayResults.assign(this->structure->delaySlotCount, BehaviorTree::NODE_STATE::FAILURE);
+
+	// Instance gets its own child order, so random composites can shuffle
+	// without disturbing other instances of the same tree.
+	instance.childOrder = this->structure->childIndices;
+
+	// Seed the instance PRNG once. Reused for every shuffle on this instance.
+	instance.rngState = seedRngState();
+
+	// One event queue per instance, so producers on other threads can post
+	// without touching the walk. @see EventQueue
+	instance.events.reset(new EventQueue());
+
+	// Reserve the traversal stack to the tree's depth up front, so the
+	// iterative walk never allocates while ticking. Depth is counted by
+	// chasing parent links; nodes are few and this runs once per instance.
+	int maxDepth = 0;
+	for (int i = 0; i < instance.nodeCount; i++)
+	{
+		int depth = 1;
+
+		for (int parent = this->structure->nodes.at(i).parent; parent != -1; parent = this->structure->nodes.at(parent).parent)
+		{
+			depth++;
+		}
+
+		maxDepth = std::max(maxDepth, depth);
+	}
+
+	instance.traversalStack.reserve(maxDepth);
+
+	return instance;
+}
+
+void BehaviorTree::Tree::optimizeNode(std::unique_ptr<BehaviorTree::Node>& slot, const bool isRoot)
+{
+	if (slot == nullptr)
+	{
+		return;
+	}
+
+	// Children first, so chains fold bottom up in one pass. Only shapes this
+	// tree interprets are entered; user derived nodes, reactive selectors and
+	// other LEAF types keep their subtree exactly as authored.
+	{
+		const std::type_info& typeInfo = typeid(*slot);
+
+		const bool plainComposite =
+			(typeInfo == typeid(BehaviorTree::Selector) && static_cast<BehaviorTree::Selector*>(slot.get())->isReactive() == false) ||
+			(typeInfo == typeid(BehaviorTree::RandomSelector) && static_cast<BehaviorTree::RandomSelector*>(slot.get())->isReactive() == false) ||
+			typeInfo == typeid(BehaviorTree::Sequence) ||
+			typeInfo == typeid(BehaviorTree::RandomSequence);
+
+		const bool plainDecorator =
+			typeInfo == typeid(BehaviorTree::Inverter) ||
+			typeInfo == typeid(BehaviorTree::Succeeder) ||
+			typeInfo == typeid(BehaviorTree::Failer) ||
+			typeInfo == typeid(BehaviorTree::Repeater) ||
+			typeInfo == typeid(BehaviorTree::RepeatUntilFail) ||
+			typeInfo == typeid(BehaviorTree::RepeatUntilSuccess) ||
+			typeInfo == typeid(BehaviorTree::Limiter) ||
+			typeInfo == typeid(BehaviorTree::DelayTime) ||
+			typeInfo == typeid(BehaviorTree::TimeLimit);
+
+		if (plainComposite)
+		{
+			BehaviorTree::CompositeNode* composite = static_cast<BehaviorTree::CompositeNode*>(slot.get());
+
+			for (auto& child : composite->children)
+			{
+				this->optimizeNode(child, false);
+			}
+		}
+		else if (plainDecorator)
+		{
+			this->optimizeNode(static_cast<BehaviorTree::DecoratorNode*>(slot.get())->child, false);
+		}
+	}
+
+	// Fold until nothing applies; each rewrite can expose the next one
+	while (true)
+	{
+		const std::type_info& typeInfo = typeid(*slot);
+
+		if (typeInfo == typeid(BehaviorTree::Inverter))
+		{
+			std::unique_ptr<BehaviorTree::Node>& child = static_cast<BehaviorTree::DecoratorNode*>(slot.get())->child;
+
+			if (child != nullptr && typeid(*child) == typeid(BehaviorTree::Inverter))
+			{
+				std::unique_ptr<BehaviorTree::Node>& grandChild = static_cast<BehaviorTree::DecoratorNode*>(child.get())->child;
+
+				if (grandChild != nullptr)
+				{
+					// Double inversion is the grandchild alone. Promote
+					// through a temporary; slot owns the chain being replaced.
+					std::unique_ptr<BehaviorTree::Node> promoted = std::move(grandChild);
+					slot = std::move(promoted);
+					continue;
+				}
+			}
+		}
+		else if (typeInfo == typeid(BehaviorTree::Succeeder) || typeInfo == typeid(BehaviorTree::Failer))
+		{
+			// These return their constant no matter what the child said, so
+			// a result rewriter in between only costs a node visit
+			std::unique_ptr<BehaviorTree::Node>& child = static_cast<BehaviorTree::DecoratorNode*>(slot.get())->child;
+
+			if (child != nullptr)
+			{
+				const std::type_info& childType = typeid(*child);
+
+				if (childType == typeid(BehaviorTree::Inverter) || childType == typeid(BehaviorTree::Succeeder) || childType == typeid(BehaviorTree::Failer))
+				{
+					std::unique_ptr<BehaviorTree::Node>& grandChild = static_cast<BehaviorTree::DecoratorNode*>(child.get())->child;
+
+					if (grandChild != nullptr)
+					{
+						std::unique_ptr<BehaviorTree::Node> promoted = std::move(grandChild);
+						child = std::move(promoted);
+						continue;
+					}
+				}
+			}
+		}
+		else if (isRoot == false && this->structure->errorPolicy == BehaviorTree::ERROR_POLICY::TERMINATE)
+		{
+			// Under IGNORE a composite absorbs a child ERROR in to its
+			// continue result (Sequence reads it as SUCCESS, Selector as
+			// FAILURE); collapsing would hand the raw ERROR to the
+			// grandparent, which skips to the next sibling instead. Under
+			// TERMINATE the ERROR propagates identically either way, so
+			// only that policy may collapse.
+			const bool plainComposite =
+				(typeInfo == typeid(BehaviorTree::Selector) && static_cast<BehaviorTree::Selector*>(slot.get())->isReactive() == false) ||
+				(typeInfo == typeid(BehaviorTree::RandomSelector) && static_cast<BehaviorTree::RandomSelector*>(slot.get())->isReactive() == false) ||
+				typeInfo == typeid(BehaviorTree::Sequence) ||
+				typeInfo == typeid(BehaviorTree::RandomSequence);
+
+			if (plainComposite)
+			{
+				BehaviorTree::CompositeNode* composite = static_cast<BehaviorTree::CompositeNode*>(slot.get());
+
+				std::unique_ptr<BehaviorTree::Node>* onlyChild = nullptr;
+				int childCount = 0;
+
+				for (auto& child : composite->children)
+				{
+					if (child != nullptr)
+					{
+						onlyChild = &child;
+						childCount++;
+					}
+				}
+
+				if (childCount == 1)
+				{
+					// A composite over one child ticks to the child's state;
+					// shuffling one child changes nothing either
+					std::unique_ptr<BehaviorTree::Node> promoted = std::move(*onlyChild);
+					slot = std::move(promoted);
+					continue;
+				}
+			}
+		}
+
+		break;
+	}
+}
+
+void BehaviorTree::Tree::validateStructure()
+{
+	const int nodeCount = static_cast<int>(this->structure->nodes.size());
+
+	for (int i = 0; i < nodeCount; i++)
+	{
+		const BakedNode& bakedNode = this->structure->nodes.at(i);
+
+		const char* offence = nullptr;
+
+		switch (bakedNode.type)
+		{
+		case BehaviorTree::NODE_TYPE::SELECTOR:
+		case BehaviorTree::NODE_TYPE::RANDOM_SELECTOR:
+		case BehaviorTree::NODE_TYPE::SEQUENCE:
+		case BehaviorTree::NODE_TYPE::RANDOM_SEQUENCE:
+			if (bakedNode.childCount == 0)
+			{
+				offence = "composite has no children";
+			}
+			break;
+		case BehaviorTree::NODE_TYPE::INVERTER:
+		case BehaviorTree::NODE_TYPE::SUCCEEDER:
+		case BehaviorTree::NODE_TYPE::FAILER:
+			if (bakedNode.childCount == 0)
+			{
+				offence = "decorator has no child";
+			}
+			break;
+		case BehaviorTree::NODE_TYPE::REPEATER:
+		case BehaviorTree::NODE_TYPE::REPEAT_UNTIL_FAIL:
+		case BehaviorTree::NODE_TYPE::REPEAT_UNTIL_SUCCESS:
+			if (bakedNode.childCount == 0)
+			{
+				offence = "decorator has no child";
+			}
+			else if (bakedNode.repeat < BehaviorTree::Repeat::REPEAT_INFINITE)
+			{
+				offence = "negative repeat count";
+			}
+			break;
+		case BehaviorTree::NODE_TYPE::LIMITER:
+			if (bakedNode.childCount == 0)
+			{
+				offence = "decorator has no child";
+			}
+			else if (bakedNode.repeat < 0)
+			{
+				offence = "negative execution limit";
+			}
+			break;
+		case BehaviorTree::NODE_TYPE::DELAY_TIME:
+		case BehaviorTree::NODE_TYPE::TIME_LIMIT:
+			if (bakedNode.childCount == 0)
+			{
+				offence = "decorator has no child";
+			}
+			else if (bakedNode.duration < 0.0f)
+			{
+				offence = "negative duration";
+			}
+			break;
+		default:
+			// LEAF. Opaque to the tree; its own update reports problems.
+			break;
+		}
+
+		if (offence != nullptr)
+		{
+			this->structure->valid = false;
+			this->structure->bakeError = "node " + std::to_string(i) + ": " + offence;
+			return;
+		}
+	}
+}
+
+const int BehaviorTree::Tree::bakeNode(BehaviorTree::Node* node, const int parent)
+{
+	// Reserve flat index for this node
+	const int index = static_cast<int>(this->structure->nodes.size());
+	this->structure->nodes.push_back(BakedNode());
+
+	{
+		BakedNode& bakedNode = this->structure->nodes.back();
+		bakedNode.type = BehaviorTree::NODE_TYPE::LEAF;
+		bakedNode.node = node;
+		bakedNode.childStart = -1;
+		bakedNode.childCount = 0;
+		bakedNode.parent = parent;
+		bakedNode.repeat = 0;
+		bakedNode.duration = 0;
+		bakedNode.delayOnce = false;
+		bakedNode.stateSlot = -1;
+		bakedNode.onCompositePath = true;
+	}
+
+	// Find the exact type of node. Derived node that user made stays as LEAF
+	// because its overriden update must run through virtual call.
+	const std::type_info& typeInfo = typeid(*node);
+
+	if (typeInfo == typeid(BehaviorTree::Selector))
+	{
+		if (static_cast<BehaviorTree::Selector*>(node)->isReactive() == false)
+		{
+			// Reactive selectors stay LEAF. Observer aborts need the
+			// virtual update and its node graph.
+			this->structure->nodes.at(index).type = BehaviorTree::NODE_TYPE::SELECTOR;
+		}
+	}
+	else if (typeInfo == typeid(BehaviorTree::RandomSelector))
+	{
+		if (static_cast<BehaviorTree::RandomSelector*>(node)->isReactive() == false)
+		{
+			this->structure->nodes.at(index).type = BehaviorTree::NODE_TYPE::RANDOM_SELECTOR;
+		}
+	}
+	else if (typeInfo == typeid(BehaviorTree::Sequence))
+	{
+		this->structure->nodes.at(index).type = BehaviorTree::NODE_TYPE::SEQUENCE;
+	}
+	else if (typeInfo == typeid(BehaviorTree::RandomSequence))
+	{
+		this->structure->nodes.at(index).type = BehaviorTree::NODE_TYPE::RANDOM_SEQUENCE;
+	}
+	else if (typeInfo == typeid(BehaviorTree::Inverter))
+	{
+		this->structure->nodes.at(index).type = BehaviorTree::NODE_TYPE::INVERTER;
+	}
+	else if (typeInfo == typeid(BehaviorTree::Succeeder))
+	{
+		this->structure->nodes.at(index).type = BehaviorTree::NODE_TYPE::SUCCEEDER;
+	}
+	else if (typeInfo == typeid(BehaviorTree::Failer))
+	{
+		this->structure->nodes.at(index).type = BehaviorTree::NODE_TYPE::FAILER;
+	}
+	else if (typeInfo == typeid(BehaviorTree::Repeater))
+	{
+		this->structure->nodes.at(index).type = BehaviorTree::NODE_TYPE::REPEATER;
+		this->structure->nodes.at(index).repeat = static_cast<BehaviorTree::Repeater*>(node)->repeat;
+	}
+	else if (typeInfo == typeid(BehaviorTree::RepeatUntilFail))
+	{
+		this->structure->nodes.at(index).type = BehaviorTree::NODE_TYPE::REPEAT_UNTIL_FAIL;
+		this->structure->nodes.at(index).repeat = static_cast<BehaviorTree::RepeatUntilFail*>(node)->repeat;
+	}
+	else if (typeInfo == typeid(BehaviorTree::RepeatUntilSuccess))
+	{
+		this->structure->nodes.at(index).type = BehaviorTree::NODE_TYPE::REPEAT_UNTIL_SUCCESS;
+		this->structure->nodes.at(index).repeat = static_cast<BehaviorTree::RepeatUntilSuccess*>(node)->repeat;
+	}
+	else if (typeInfo == typeid(BehaviorTree::Limiter))
+	{
+		this->structure->nodes.at(index).type = BehaviorTree::NODE_TYPE::LIMITER;
+		// Limit shares the repeat slot. Both are 'how many times can child run'.
+		this->structure->nodes.at(index).repeat = static_cast<BehaviorTree::Limiter*>(node)->limit;
+	}
+	else if (typeInfo == typeid(BehaviorTree::DelayTime))
+	{
+		this->structure->nodes.at(index).type = BehaviorTree::NODE_TYPE::DELAY_TIME;
+		this->structure->nodes.at(index).duration = static_cast<BehaviorTree::DelayTime*>(node)->duration;
+		this->structure->nodes.at(index).delayOnce = static_cast<BehaviorTree::DelayTime*>(node)->delayOnce;
+	}
+	else if (typeInfo == typeid(BehaviorTree::TimeLimit))
+	{
+		this->structure->nodes.at(index).type = BehaviorTree::NODE_TYPE::TIME_LIMIT;
+		this->structure->nodes.at(index).duration = static_cast<BehaviorTree::TimeLimit*>(node)->duration;
+	}
+	// Else, LEAF.
+
+	// Hand out a per-instance state slot. Only types with mutable per-agent
+	// state get one; everything else reads the shared structure only.
+	switch (this->structure->nodes.at(index).type)
+	{
+	case BehaviorTree::NODE_TYPE::SELECTOR:
+	case BehaviorTree::NODE_TYPE::RANDOM_SELECTOR:
+	case BehaviorTree::NODE_TYPE::SEQUENCE:
+	case BehaviorTree::NODE_TYPE::RANDOM_SEQUENCE:
+		this->structure->nodes.at(index).stateSlot = this->structure->runningChildSlotCount++;
+		break;
+	case BehaviorTree::NODE_TYPE::LIMITER:
+		this->structure->nodes.at(index).stateSlot = this->structure->counterSlotCount++;
+		break;
+	case BehaviorTree::NODE_TYPE::TIME_LIMIT:
+		this->structure->nodes.at(index).stateSlot = this->structure->timerSlotCount++;
+		break;
+	case BehaviorTree::NODE_TYPE::DELAY_TIME:
+		this->structure->nodes.at(index).stateSlot = this->structure->delaySlotCount++;
+		break;
+	default:
+		break;
+	}
+
+	if (parent != -1)
+	{
+		// Resumable only if parent is a composite and parent's path qualifies too
+		const NODE_TYPE parentType = this->structure->nodes.at(parent).type;
+		const bool parentIsComposite =
+			parentType == BehaviorTree::NODE_TYPE::SELECTOR ||
+			parentType == BehaviorTree::NODE_TYPE::RANDOM_SELECTOR ||
+			parentType == BehaviorTree::NODE_TYPE::SEQUENCE ||
+			parentType == BehaviorTree::NODE_TYPE::RANDOM_SEQUENCE;
+
+		this->structure->nodes.at(index).onCompositePath = parentIsComposite && this->structure->nodes.at(parent).onCompositePath;
+	}
+
+	// Bake children. Child flat indices are collected first and appended to
+	// childIndices in one step, so each node owns a contiguous slice.
+	// LEAF nodes (user nodes and reactive selectors) keep their subtree behind
+	// the virtual call, so their children are not baked.
+	std::vector<int> childFlatIndices;
+
+	BehaviorTree::CompositeNode* compositeNode = (this->structure->nodes.at(index).type == BehaviorTree::NODE_TYPE::LEAF) ? nullptr : dynamic_cast<BehaviorTree::CompositeNode*>(node);
+	if (compositeNode != nullptr)
+	{
+		for (auto& child : compositeNode->children)
+		{
+			if (child != nullptr)
+			{
+				childFlatIndices.push_back(this->bakeNode(child.get(), index));
+			}
+		}
+	}
+	else if (this->structure->nodes.at(index).type != BehaviorTree::NODE_TYPE::LEAF)
+	{
+		BehaviorTree::DecoratorNode* decoratorNode = dynamic_cast<BehaviorTree::DecoratorNode*>(node);
+		if (decoratorNode != nullptr && decoratorNode->child != nullptr)
+		{
+			childFlatIndices.push_back(this->bakeNode(decoratorNode->child.get(), index));
+		}
+	}
+
+	if (childFlatIndices.empty() == false)
+	{
+		this->structure->nodes.at(index).childStart = static_cast<int>(this->structure->childIndices.size());
+		this->structure->nodes.at(index).childCount = static_cast<int>(childFlatIndices.size());
+
+		for (int childFlatIndex : childFlatIndices)
+		{
+			this->structure->childIndices.push_back(childFlatIndex);
+		}
+	}
+
+	return index;
+}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Tree::updateBakedChildren(BehaviorTree::TreeInstance& instance, const int index, const int start, const float delta, const BehaviorTree::NODE_STATE continueCondition)
+{
+	// Mirrors CompositeNode::updateChildren over the flat child index slice.
+	const int childStart = this->structure->nodes.at(index).childStart;
+	const int childCount = this->structure->nodes.at(index).childCount;
+
+	for (int i = start; i < childCount; i++)
+	{
+		// Update child by flat index
+		BehaviorTree::NODE_STATE state = this->updateBakedNode(instance, instance.childOrder.at(childStart + i), delta);
+
+		// Check status
+		if (state == continueCondition)
+		{
+			// If this is selector, state must be FAILURE to continue.
+			// If this is sequence, state must be SUCCESS to continue.
+			continue;
+		}
+		else if (state == BehaviorTree::NODE_STATE::ERROR)
+		{
+			// Error occured.
+			if (this->structure->errorPolicy == BehaviorTree::ERROR_POLICY::IGNORE)
+			{
+				// Can ignore error.
+				continue;
+			}
+			else
+			{
+				// Terminate. Return ERROR.
+				return state;
+			}
+		}
+		else if (state == BehaviorTree::NODE_STATE::RUNNING)
+		{
+			// Remember slot of running child
+			instance.runningChildren.at(this->structure->nodes.at(index).stateSlot) = i;
+			return state;
+		}
+		else
+		{
+			// If this is selector, this is SUCCESS. Return.
+			// If this is sequence, this is FAILURE. Return.
+			return state;
+		}
+	}
+
+	// Iterated all children
+	// If this is selector, every child failed. Return FAILURE.
+	// If this is sequence, every child succeeded. Return SUCCESS.
 	return continueCondition;
 }
 
-BehaviorTree::CompositeNode::~CompositeNode()
+const bool BehaviorTree::Tree::budgetExceeded(BehaviorTree::TreeInstance& instance)
+{
+	if (instance.budgetActive == false)
+	{
+		// Unbudgeted update. Single branch on the hot path.
+		return false;
+	}
+
+	if (instance.budgetExhausted)
+	{
+		// Already out of budget. Keep unwinding.
+		return true;
+	}
+
+	instance.budgetVisitCount++;
+
+	if (instance.budgetVisitsLeft != BehaviorTree::TickBudget::UNLIMITED)
+	{
+		if (instance.budgetVisitsLeft <= 0)
+		{
+			// Visit cap hit
+			instance.budgetExhausted = true;
+			return true;
+		}
+
+		instance.budgetVisitsLeft--;
+	}
+
+	if (instance.budgetTimed && (instance.budgetVisitCount & 31) == 0)
+	{
+		// Reading the clock costs more than a node visit, so only check it
+		// every 32 visits. A timed budget can overrun by up to 31 visits.
+		if (std::chrono::steady_clock::now() >= instance.budgetDeadline)
+		{
+			// Time cap hit
+			instance.budgetExhausted = true;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Tree::updateBakedNode(BehaviorTree::TreeInstance& instance, const int index, const float delta)
+{
+	// Frame phases. ENTER is a node not yet touched this visit; the others
+	// tell which child return the frame is waiting on.
+	static const int PHASE_ENTER = 0;
+
+	//Composites: the running child from last update is in flight.
+	static const int PHASE_RUNNING_CHILD = 1;
+
+	//Composites: iterating children from childSlot on. Decorators: the only
+	//child is in flight. DelayTime: the pass-through child (no delay).
+	static const int PHASE_CHILD = 2;
+
+	//DelayTime: a cycle child (the delay elapsed) is in flight.
+	static const int PHASE_CYCLE_CHILD = 3;
+
+#if defined(BT_PROFILING)
+	BehaviorTree::Profiler* profiler = BehaviorTree::Profiler::getActiveProfiler();
+#endif
+
+	// The walk drives itself with this reusable stack instead of recursing:
+	// a level of tree depth costs one frame here, not a C++ stack frame and
+	// a virtual call, and a pathological tree can't overflow the machine
+	// stack. clear keeps the capacity, so steady state never allocates.
+	std::vector<BehaviorTree::TreeInstance::TraversalFrame>& stack = instance.traversalStack;
+	stack.clear();
+
+	const auto push = [&](const int nodeIndex, const float nodeDelta)
+	{
+		BehaviorTree::TreeInstance::TraversalFrame frame;
+		frame.index = nodeIndex;
+		frame.phase = PHASE_ENTER;
+		frame.childSlot = 0;
+		frame.delta = nodeDelta;
+		frame.childState = BehaviorTree::NODE_STATE::ERROR;
+		frame.executed = false;
+#if defined(BT_PROFILING)
+		if (profiler != nullptr)
+		{
+			frame.profileStart = std::chrono::steady_clock::now();
+
+#if defined(BT_DEBUG_ALLOC)
+			frame.allocStart = AllocationAudit::getCurrentCount();
+#endif
+		}
+#endif
+		stack.push_back(frame);
+	};
+
+	// Result bubbling up the stack. Holds the root's result at the end.
+	BehaviorTree::NODE_STATE result = BehaviorTree::NODE_STATE::ERROR;
+
+	// Pop the top frame with its result and deliver it to the frame below.
+	const auto finish = [&](const BehaviorTree::NODE_STATE state)
+	{
+#if defined(BT_PROFILING)
+		if (profiler != nullptr)
+		{
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - stack.back().profileStart).count();
+			profiler->record(this->structure->nodes.at(stack.back().index).type, state, seconds);
+
+#if defined(BT_DEBUG_ALLOC)
+			// Pin this node's allocations to its ring buffer sample
+			profiler->annotateLastSampleAllocations(AllocationAudit::getCurrentCount() - stack.back().allocStart);
+#endif
+		}
+#endif
+		stack.pop_back();
+
+		if (stack.empty() == false)
+		{
+			stack.back().childState = state;
+		}
+
+		result = state;
+	};
+
+	push(index, delta);
+
+	while (stack.empty() == false)
+	{
+		// Careful: push can grow the stack and move frames; write every
+		// frame field before pushing and don't touch the reference after.
+		BehaviorTree::TreeInstance::TraversalFrame& frame = stack.back();
+		const BakedNode& bakedNode = this->structure->nodes.at(frame.index);
+
+		if (frame.phase == PHASE_ENTER && this->budgetExceeded(instance))
+		{
+			// Out of budget. Yield with RUNNING without touching this node;
+			// composites above record the path, so the next update gets back
+			// here through the normal running child slots.
+			if (bakedNode.onCompositePath)
+			{
+				instance.runningNodeIndex = frame.index;
+			}
+
+			finish(BehaviorTree::NODE_STATE::RUNNING);
+			continue;
+		}
+
+		switch (bakedNode.type)
+		{
+		case BehaviorTree::NODE_TYPE::LEAF:
+		{
+			// Not interpreted. Update through virtual call.
+			const BehaviorTree::NODE_STATE state = bakedNode.node->update(frame.delta);
+
+			if (state == BehaviorTree::NODE_STATE::RUNNING && bakedNode.onCompositePath)
+			{
+				// RUNNING starts here and the path up is all composites. Cache it.
+				instance.runningNodeIndex = frame.index;
+			}
+
+			finish(state);
+			break;
+		}
+		case BehaviorTree::NODE_TYPE::SELECTOR:
+		case BehaviorTree::NODE_TYPE::RANDOM_SELECTOR:
+		case BehaviorTree::NODE_TYPE::SEQUENCE:
+		case BehaviorTree::NODE_TYPE::RANDOM_SEQUENCE:
+		{
+			const bool isSelector =
+				bakedNode.type == BehaviorTree::NODE_TYPE::SELECTOR ||
+				bakedNode.type == BehaviorTree::NODE_TYPE::RANDOM_SELECTOR;
+
+			// If this is selector, FAILURE continues to the next child.
+			// If this is sequence, SUCCESS continues to the next child.
+			const BehaviorTree::NODE_STATE continueCondition = isSelector ? BehaviorTree::NODE_STATE::FAILURE : BehaviorTree::NODE_STATE::SUCCESS;
+
+			int& runningChild = instance.runningChildren.at(bakedNode.stateSlot);
+
+			if (frame.phase == PHASE_ENTER)
+			{
+				if (bakedNode.childCount == 0)
+				{
+					finish(BehaviorTree::NODE_STATE::ERROR);
+					break;
+				}
+
+				if (runningChild != BehaviorTree::NO_RUNNING_CHILD && runningChild < bakedNode.childCount)
+				{
+					// Update running child first
+					frame.phase = PHASE_RUNNING_CHILD;
+					push(instance.childOrder.at(bakedNode.childStart + runningChild), frame.delta);
+					break;
+				}
+
+				if (bakedNode.type == BehaviorTree::NODE_TYPE::RANDOM_SELECTOR || bakedNode.type == BehaviorTree::NODE_TYPE::RANDOM_SEQUENCE)
+				{
+					// Not running. Fisher-Yates over this node's index slice in the
+					// instance's order buffer. unique_ptrs never move, nothing allocates.
+					for (int i = bakedNode.childCount - 1; i > 0; i--)
+					{
+						const int j = static_cast<int>(xorshift32(instance.rngState) % static_cast<unsigned int>(i + 1));
+						std::swap(instance.childOrder.at(bakedNode.childStart + i), instance.childOrder.at(bakedNode.childStart + j));
+					}
+				}
+
+				frame.phase = PHASE_CHILD;
+				frame.childSlot = 0;
+				push(instance.childOrder.at(bakedNode.childStart), frame.delta);
+				break;
+			}
+
+			if (frame.phase == PHASE_RUNNING_CHILD)
+			{
+				const BehaviorTree::NODE_STATE state = frame.childState;
+
+				if (state == BehaviorTree::NODE_STATE::RUNNING)
+				{
+					// Still running. Keep go on.
+					finish(state);
+					break;
+				}
+
+				// Selector stops on SUCCESS, sequence stops on FAILURE.
+				if (state == (isSelector ? BehaviorTree::NODE_STATE::SUCCESS : BehaviorTree::NODE_STATE::FAILURE))
+				{
+					// Done with this child. Reset running child slot and end here.
+					runningChild = BehaviorTree::NO_RUNNING_CHILD;
+					finish(state);
+					break;
+				}
+
+				// Else, continue with the siblings after the running child.
+				const int start = runningChild + 1;
+				runningChild = BehaviorTree::NO_RUNNING_CHILD;
+
+				if (state == BehaviorTree::NODE_STATE::ERROR && this->structure->errorPolicy == BehaviorTree::ERROR_POLICY::TERMINATE)
+				{
+					// Can't ignore error. Return.
+					finish(state);
+					break;
+				}
+
+				frame.phase = PHASE_CHILD;
+				frame.childSlot = start;
+
+				if (start < bakedNode.childCount)
+				{
+					push(instance.childOrder.at(bakedNode.childStart + start), frame.delta);
+				}
+				else
+				{
+					// The running child was the last one
+					finish(continueCondition);
+				}
+
+				break;
+			}
+
+			// PHASE_CHILD. Mirrors CompositeNode::updateChildren over the
+			// flat child index slice.
+			const BehaviorTree::NODE_STATE state = frame.childState;
+
+			if (state == continueCondition ||
+				(state == BehaviorTree::NODE_STATE::ERROR && this->structure->errorPolicy == BehaviorTree::ERROR_POLICY::IGNORE))
+			{
+				frame.childSlot++;
+
+				if (frame.childSlot < bakedNode.childCount)
+				{
+					push(instance.childOrder.at(bakedNode.childStart + frame.childSlot), frame.delta);
+				}
+				else
+				{
+					// Iterated all children.
+					// If this is selector, every child failed. Return FAILURE.
+					// If this is sequence, every child succeeded. Return SUCCESS.
+					finish(continueCondition);
+				}
+
+				break;
+			}
+
+			if (state == BehaviorTree::NODE_STATE::RUNNING)
+			{
+				// Remember slot of running child
+				runningChild = frame.childSlot;
+				finish(state);
+				break;
+			}
+
+			// Selector's SUCCESS, sequence's FAILURE, or ERROR that terminates.
+			finish(state);
+			break;
+		}
+		case BehaviorTree::NODE_TYPE::INVERTER:
+		{
+			if (frame.phase == PHASE_ENTER)
+			{
+				if (bakedNode.childCount == 0)
+				{
+					// Doesn't have child. Return ERROR
+					finish(BehaviorTree::NODE_STATE::ERROR);
+					break;
+				}
+
+				frame.phase = PHASE_CHILD;
+				push(instance.childOrder.at(bakedNode.childStart), frame.delta);
+				break;
+			}
+
+			const BehaviorTree::NODE_STATE state = frame.childState;
+
+			if (state == BehaviorTree::NODE_STATE::RUNNING || state == BehaviorTree::NODE_STATE::ERROR)
+			{
+				finish(state);
+			}
+			else
+			{
+				// If status was SUCCESS or FAILURE, invert result.
+				finish(state == BehaviorTree::NODE_STATE::SUCCESS ? BehaviorTree::NODE_STATE::FAILURE : BehaviorTree::NODE_STATE::SUCCESS);
+			}
+
+			break;
+		}
+		case BehaviorTree::NODE_TYPE::SUCCEEDER:
+		case BehaviorTree::NODE_TYPE::FAILER:
+		{
+			if (frame.phase == PHASE_ENTER)
+			{
+				if (bakedNode.childCount == 0)
+				{
+					finish(BehaviorTree::NODE_STATE::ERROR);
+					break;
+				}
+
+				frame.phase = PHASE_CHILD;
+				push(instance.childOrder.at(bakedNode.childStart), frame.delta);
+				break;
+			}
+
+			// We don't need the child's result
+			finish(bakedNode.type == BehaviorTree::NODE_TYPE::SUCCEEDER ? BehaviorTree::NODE_STATE::SUCCESS : BehaviorTree::NODE_STATE::FAILURE);
+			break;
+		}
+		case BehaviorTree::NODE_TYPE::REPEATER:
+		{
+			if (frame.phase == PHASE_ENTER)
+			{
+				if (bakedNode.repeat == 0 || bakedNode.childCount == 0)
+				{
+					finish(BehaviorTree::NODE_STATE::ERROR);
+					break;
+				}
+
+				// Repeat update for certain amount of times.
+				frame.phase = PHASE_CHILD;
+				frame.childSlot = 0;
+				push(instance.childOrder.at(bakedNode.childStart), frame.delta);
+				break;
+			}
+
+			const BehaviorTree::NODE_STATE state = frame.childState;
+
+			if (state == BehaviorTree::NODE_STATE::SUCCESS || state == BehaviorTree::NODE_STATE::FAILURE)
+			{
+				frame.childSlot++;
+
+				if (frame.childSlot < bakedNode.repeat)
+				{
+					// Keep go on
+					push(instance.childOrder.at(bakedNode.childStart), frame.delta);
+				}
+				else
+				{
+					// Finished repeating. Return SUCCESS
+					finish(BehaviorTree::NODE_STATE::SUCCESS);
+				}
+			}
+			else
+			{
+				finish(state);
+			}
+
+			break;
+		}
+		case BehaviorTree::NODE_TYPE::REPEAT_UNTIL_FAIL:
+		case BehaviorTree::NODE_TYPE::REPEAT_UNTIL_SUCCESS:
+		{
+			const BehaviorTree::NODE_STATE desiredStatus = (bakedNode.type == BehaviorTree::NODE_TYPE::REPEAT_UNTIL_FAIL) ? BehaviorTree::NODE_STATE::FAILURE : BehaviorTree::NODE_STATE::SUCCESS;
+
+			if (frame.phase == PHASE_ENTER)
+			{
+				if (bakedNode.repeat == 0 || bakedNode.childCount == 0)
+				{
+					finish(BehaviorTree::NODE_STATE::ERROR);
+					break;
+				}
+
+				frame.phase = PHASE_CHILD;
+				frame.childSlot = 0;
+				push(instance.childOrder.at(bakedNode.childStart), frame.delta);
+				break;
+			}
+
+			if (frame.childState == desiredStatus)
+			{
+				// Met desired status. Return SUCCESS.
+				finish(BehaviorTree::NODE_STATE::SUCCESS);
+				break;
+			}
+
+			if (instance.budgetExhausted)
+			{
+				// Budget ran out mid loop. Yield instead of reporting a
+				// FAILURE the loop never earned; next update loops again.
+				// A tick budget is the only way out of the infinite loop
+				// besides the desired status. @see TickBudget
+				finish(BehaviorTree::NODE_STATE::RUNNING);
+				break;
+			}
+
+			if (bakedNode.repeat == BehaviorTree::Repeat::REPEAT_INFINITE)
+			{
+				// Loop again
+				push(instance.childOrder.at(bakedNode.childStart), frame.delta);
+				break;
+			}
+
+			frame.childSlot++;
+
+			if (frame.childSlot < bakedNode.repeat)
+			{
+				push(instance.childOrder.at(bakedNode.childStart), frame.delta);
+			}
+			else
+			{
+				// Finished repeating. Haven't met desired status. Return FAILURE
+				finish(BehaviorTree::NODE_STATE::FAILURE);
+			}
+
+			break;
+		}
+		case BehaviorTree::NODE_TYPE::LIMITER:
+		{
+			if (frame.phase == PHASE_ENTER)
+			{
+				if (bakedNode.childCount == 0)
+				{
+					finish(BehaviorTree::NODE_STATE::ERROR);
+					break;
+				}
+
+				if (instance.counters.at(bakedNode.stateSlot) < bakedNode.repeat)
+				{
+					// Still can execute this node
+					frame.phase = PHASE_CHILD;
+					push(instance.childOrder.at(bakedNode.childStart), frame.delta);
+				}
+				else
+				{
+					finish(BehaviorTree::NODE_STATE::FAILURE);
+				}
+
+				break;
+			}
+
+			instance.counters.at(bakedNode.stateSlot)++;
+			finish(frame.childState);
+			break;
+		}
+		case BehaviorTree::NODE_TYPE::DELAY_TIME:
+		{
+			float& elapsedTime = instance.delayElapsed.at(bakedNode.stateSlot);
+			BehaviorTree::NODE_STATE& delayResult = instance.delayResults.at(bakedNode.stateSlot);
+
+			if (frame.phase == PHASE_ENTER)
+			{
+				if (bakedNode.childCount == 0)
+				{
+					finish(BehaviorTree::NODE_STATE::ERROR);
+					break;
+				}
+
+				if (bakedNode.duration <= 0)
+				{
+					// No delay at all. Plain pass-through.
+					frame.phase = PHASE_CHILD;
+					push(instance.childOrder.at(bakedNode.childStart), frame.delta);
+					break;
+				}
+
+				if (bakedNode.delayOnce && instance.delayFinished.at(bakedNode.stateSlot) != 0)
+				{
+					// Delayed and updated once for good. Keep reporting the result.
+					finish(delayResult);
+					break;
+				}
+
+				// Consume time first, so one large accumulated delta (an agent
+				// ticked at reduced rate) can end the delay, run the child and
+				// start delaying again, all in this update.
+				elapsedTime += frame.delta;
+			}
+			else if (frame.phase == PHASE_CHILD)
+			{
+				// Pass-through child returned
+				delayResult = frame.childState;
+				finish(delayResult);
+				break;
+			}
+			else
+			{
+				// PHASE_CYCLE_CHILD. The child of an elapsed delay returned.
+				delayResult = frame.childState;
+				frame.executed = true;
+
+				if (delayResult == BehaviorTree::NODE_STATE::RUNNING)
+				{
+					// Child is working. Hold the clock at the end of the delay.
+					elapsedTime = bakedNode.duration;
+
+					if (bakedNode.onCompositePath)
+					{
+						// RUNNING starts here. Cache for resume.
+						instance.runningNodeIndex = frame.index;
+					}
+
+					finish(BehaviorTree::NODE_STATE::RUNNING);
+					break;
+				}
+
+				instance.delayFinished.at(bakedNode.stateSlot) = 1;
+
+				if (bakedNode.delayOnce)
+				{
+					finish(delayResult);
+					break;
+				}
+
+				// Cycle complete. Consume one period and delay again; leftover
+				// time can expire further cycles in this same catch-up update.
+				elapsedTime -= bakedNode.duration;
+				instance.delayFinished.at(bakedNode.stateSlot) = 0;
+			}
+
+			// Delay loop head, reached on entry and after each finished cycle
+			bool advanced = false;
+
+			while (elapsedTime >= bakedNode.duration)
+			{
+				if (instance.delayFinished.at(bakedNode.stateSlot) == 0)
+				{
+					// The child starts where the delay ended; it gets the overshoot
+					frame.phase = PHASE_CYCLE_CHILD;
+					push(instance.childOrder.at(bakedNode.childStart), elapsedTime - bakedNode.duration);
+					advanced = true;
+					break;
+				}
+
+				if (bakedNode.delayOnce)
+				{
+					finish(delayResult);
+					advanced = true;
+					break;
+				}
+
+				elapsedTime -= bakedNode.duration;
+				instance.delayFinished.at(bakedNode.stateSlot) = 0;
+			}
+
+			if (advanced)
+			{
+				break;
+			}
+
+			if (frame.executed)
+			{
+				// At least one cycle fired this update. Report the child's result.
+				finish(delayResult);
+				break;
+			}
+
+			if (bakedNode.onCompositePath)
+			{
+				// RUNNING starts here. Cache for resume.
+				instance.runningNodeIndex = frame.index;
+			}
+
+			// Mid delay
+			finish(BehaviorTree::NODE_STATE::RUNNING);
+			break;
+		}
+		case BehaviorTree::NODE_TYPE::TIME_LIMIT:
+		{
+			float& elapsedTime = instance.timers.at(bakedNode.stateSlot);
+
+			if (frame.phase == PHASE_ENTER)
+			{
+				if (bakedNode.childCount == 0)
+				{
+					finish(BehaviorTree::NODE_STATE::ERROR);
+					break;
+				}
+
+				// The child runs under the clock from the first update. Time is
+				// added before the check, so one large accumulated delta (an agent
+				// ticked at reduced rate) expires the window in this same update.
+				elapsedTime += frame.delta;
+
+				frame.phase = PHASE_CHILD;
+				push(instance.childOrder.at(bakedNode.childStart), frame.delta);
+				break;
+			}
+
+			const BehaviorTree::NODE_STATE state = frame.childState;
+
+			if (state != BehaviorTree::NODE_STATE::RUNNING)
+			{
+				// Finished in time. The window restarts for the next run.
+				elapsedTime = 0;
+				finish(state);
+				break;
+			}
+
+			if (elapsedTime >= bakedNode.duration)
+			{
+				// Out of time with the child still working. Failed.
+				elapsedTime = 0;
+				finish(BehaviorTree::NODE_STATE::FAILURE);
+				break;
+			}
+
+			if (bakedNode.onCompositePath)
+			{
+				// RUNNING starts here. Cache for resume.
+				instance.runningNodeIndex = frame.index;
+			}
+
+			finish(BehaviorTree::NODE_STATE::RUNNING);
+			break;
+		}
+		default:
+		{
+			finish(BehaviorTree::NODE_STATE::ERROR);
+			break;
+		}
+		}
+	}
+
+	return result;
+}
+
+
+const BehaviorTree::NODE_STATE BehaviorTree::Tree::resumeBakedNode(BehaviorTree::TreeInstance& instance, const int index, const float delta)
+{
+	// Update the cached running node directly. O(1) when it keeps running.
+	BehaviorTree::NODE_STATE state = this->updateBakedNode(instance, index, delta);
+
+	int parent = this->structure->nodes.at(index).parent;
+
+	// Bubble the result up. Every ancestor is a composite, checked at bake.
+	while (parent != -1)
+	{
+		if (state == BehaviorTree::NODE_STATE::RUNNING)
+		{
+			// Still running. Ancestors keep their running child slots.
+			return state;
+		}
+
+		const BakedNode& parentNode = this->structure->nodes.at(parent);
+		int& parentRunningChild = instance.runningChildren.at(parentNode.stateSlot);
+
+		const bool isSelector =
+			parentNode.type == BehaviorTree::NODE_TYPE::SELECTOR ||
+			parentNode.type == BehaviorTree::NODE_TYPE::RANDOM_SELECTOR;
+
+		// Selector stops on SUCCESS, sequence stops on FAILURE.
+		const BehaviorTree::NODE_STATE stopCondition = isSelector ? BehaviorTree::NODE_STATE::SUCCESS : BehaviorTree::NODE_STATE::FAILURE;
+
+		if (state == stopCondition)
+		{
+			// Composite is done with this child. Bubble the state further up.
+			parentRunningChild = BehaviorTree::NO_RUNNING_CHILD;
+		}
+		else if (state == BehaviorTree::NODE_STATE::ERROR && this->structure->errorPolicy == BehaviorTree::ERROR_POLICY::TERMINATE)
+		{
+			// Can't ignore error. Terminate the whole tick.
+			parentRunningChild = BehaviorTree::NO_RUNNING_CHILD;
+			return state;
+		}
+		else
+		{
+			// Composite continues with the siblings after the running child
+			const int start = parentRunningChild + 1;
+			parentRunningChild = BehaviorTree::NO_RUNNING_CHILD;
+			state = this->updateBakedChildren(instance, parent, start, delta, isSelector ? BehaviorTree::NODE_STATE::FAILURE : BehaviorTree::NODE_STATE::SUCCESS);
+		}
+
+		parent = parentNode.parent;
+	}
+
+	return state;
+}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Tree::update(const float delta)
+{
+	// Single-agent front-end. Uses the built-in instance.
+	return this->update(this->defaultInstance, delta);
+}
+
+const int BehaviorTree::Tree::subtreeEnd(const int index)
+{
+	// Bake is depth first, so a subtree is one contiguous index range. It
+	// ends at the first node whose parent lies before the subtree's root.
+	const int count = static_cast<int>(this->structure->nodes.size());
+
+	int end = index + 1;
+	while (end < count && this->structure->nodes.at(end).parent >= index)
+	{
+		end++;
+	}
+
+	return end;
+}
+
+void BehaviorTree::Tree::resetBakedNodeState(BehaviorTree::TreeInstance& instance, const int index)
+{
+	const BakedNode& bakedNode = this->structure->nodes.at(index);
+
+	// Clear whatever per-instance state the node keeps
+	switch (bakedNode.type)
+	{
+	case BehaviorTree::NODE_TYPE::SELECTOR:
+	case BehaviorTree::NODE_TYPE::RANDOM_SELECTOR:
+	case BehaviorTree::NODE_TYPE::SEQUENCE:
+	case BehaviorTree::NODE_TYPE::RANDOM_SEQUENCE:
+		instance.runningChildren.at(bakedNode.stateSlot) = BehaviorTree::NO_RUNNING_CHILD;
+		break;
+	case BehaviorTree::NODE_TYPE::LIMITER:
+		instance.counters.at(bakedNode.stateSlot) = 0;
+		break;
+	case BehaviorTree::NODE_TYPE::TIME_LIMIT:
+		instance.timers.at(bakedNode.stateSlot) = 0.0f;
+		break;
+	case BehaviorTree::NODE_TYPE::DELAY_TIME:
+		instance.delayElapsed.at(bakedNode.stateSlot) = 0.0f;
+		instance.delayFinished.at(bakedNode.stateSlot) = 0;
+		instance.delayResults.at(bakedNode.stateSlot) = BehaviorTree::NODE_STATE::FAILURE;
+		break;
+	case BehaviorTree::NODE_TYPE::LEAF:
+		if (bakedNode.node != nullptr)
+		{
+			bakedNode.node->reset();
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void BehaviorTree::Tree::drainEvents(BehaviorTree::TreeInstance& instance)
+{
+	if (instance.events == nullptr)
+	{
+		return;
+	}
+
+	Event event;
+	while (instance.events->poll(event))
+	{
+		if (event.nodeIndex < 0 || event.nodeIndex >= static_cast<int>(this->structure->nodes.size()))
+		{
+			// Out of range. Dropped.
+			continue;
+		}
+
+		const BakedNode& bakedNode = this->structure->nodes.at(event.nodeIndex);
+
+		switch (event.type)
+		{
+		case BehaviorTree::EVENT_TYPE::RESET_NODE:
+		{
+			this->resetBakedNodeState(instance, event.nodeIndex);
+		}
+			break;
+		case BehaviorTree::EVENT_TYPE::RESET_LIMITER:
+		{
+			if (bakedNode.type == BehaviorTree::NODE_TYPE::LIMITER)
+			{
+				instance.counters.at(bakedNode.stateSlot) = 0;
+			}
+		}
+			break;
+		case BehaviorTree::EVENT_TYPE::EXPIRE_TIME_LIMIT:
+		{
+			if (bakedNode.type == BehaviorTree::NODE_TYPE::TIME_LIMIT)
+			{
+				// Time is up. This walk gives the child its last chance.
+				instance.timers.at(bakedNode.stateSlot) = bakedNode.duration;
+			}
+		}
+			break;
+		case BehaviorTree::EVENT_TYPE::FINISH_DELAY:
+		{
+			if (bakedNode.type == BehaviorTree::NODE_TYPE::DELAY_TIME)
+			{
+				// Delay is over. This walk reaches the child.
+				instance.delayElapsed.at(bakedNode.stateSlot) = bakedNode.duration;
+			}
+		}
+			break;
+		case BehaviorTree::EVENT_TYPE::PREEMPT_BRANCH:
+		{
+			// data carries the preempting branch slot. Applied here, on the
+			// ticking thread, so the preempt never races a walk in flight.
+			this->preempt(instance, event.nodeIndex, event.data);
+		}
+			break;
+		case BehaviorTree::EVENT_TYPE::CUSTOM:
+		{
+			if (bakedNode.type == BehaviorTree::NODE_TYPE::LEAF && bakedNode.node != nullptr)
+			{
+				bakedNode.node->onEvent(event.data);
+			}
+		}
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Tree::update(BehaviorTree::TreeInstance& instance, const float delta)
+{
+	if (this->structure->nodes.empty() || instance.nodeCount != static_cast<int>(this->structure->nodes.size()))
+	{
+		// Baked with nullptr root, or instance wasn't created from this tree
+		instance.lastState = BehaviorTree::NODE_STATE::ERROR;
+		return instance.lastState;
+	}
+
+	if (this->structure->valid == false)
+	{
+		// Rejected by validation at bake. @see getBakeError
+		instance.lastState = BehaviorTree::NODE_STATE::ERROR;
+		return instance.lastState;
+	}
+
+	// Unbudgeted updates can't yield. The budget overload sets this after.
+	instance.lastTickYielded = false;
+
+#if defined(BT_DEBUG_ALLOC)
+	// Audit the whole tick, event handlers included. A nested update
+	// (@see SubtreeRef) keeps the outer audit running and reports only
+	// its own share. @see AllocationAudit
+	const unsigned long long auditStart = AllocationAudit::begin();
+#endif
+
+	// Apply events posted from other threads since the last update. Handled
+	// here, before the walk, so they never race it. @see TreeInstance::postEvent
+	this->drainEvents(instance);
+
+#if defined(BT_PROFILING)
+	// Bind this tree's profiler so the whole walk records here
+	this->profiler.begin();
+#endif
+
+	// Capture running-path cache from last update. Origins re-record below.
+	const int resumeIndex = instance.runningNodeIndex;
+	instance.runningNodeIndex = -1;
+
+	if (resumeIndex > 0 && resumeIndex < static_cast<int>(this->structure->nodes.size()))
+	{
+		// Resume at the deepest RUNNING node instead of descending from root
+		instance.lastState = this->resumeBakedNode(instance, resumeIndex, delta);
+	}
+	else
+	{
+		// Root is always index 0
+		instance.lastState = this->updateBakedNode(instance, 0, delta);
+	}
+
+	if (instance.lastState != BehaviorTree::NODE_STATE::RUNNING)
+	{
+		// Nothing running anymore. Drop whatever origins recorded this tick.
+		instance.runningNodeIndex = -1;
+	}
+
+#if defined(BT_PROFILING)
+	this->profiler.end();
+#endif
+
+#if defined(BT_DEBUG_ALLOC)
+	instance.lastTickAllocationCount = AllocationAudit::end(auditStart);
+#endif
+
+	return instance.lastState;
+}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Tree::update(const float delta, const BehaviorTree::TickBudget& budget)
+{
+	// Single-agent front-end. Uses the built-in instance.
+	return this->update(this->defaultInstance, delta, budget);
+}
+
+const BehaviorTree::NODE_STATE BehaviorTree::Tree::update(BehaviorTree::TreeInstance& instance, const float delta, const BehaviorTree::TickBudget& budget)
+{
+	// Arm the budget on the instance for the span of this walk
+	instance.budgetActive = true;
+	instance.budgetExhausted = false;
+	instance.budgetVisitCount = 0;
+	instance.budgetVisitsLeft = (budget.maxNodeVisits > 0) ? budget.maxNodeVisits : BehaviorTree::TickBudget::UNLIMITED;
+	instance.budgetTimed = budget.maxMicroseconds > 0.0f;
+
+	if (instance.budgetTimed)
+	{
+		instance.budgetDeadline = std::chrono::steady_clock::now() + std::chrono::microseconds(static_cast<long long>(budget.maxMicroseconds));
+	}
+
+	const BehaviorTree::NODE_STATE state = this->update(instance, delta);
+
+	instance.lastTickYielded = instance.budgetExhausted;
+	instance.budgetActive = false;
+
+	return state;
+}
+
+void BehaviorTree::Tree::reset()
+{
+	this->reset(this->defaultInstance);
+
+	if (this->structure->root != nullptr)
+	{
+		// Reset original graph as well. Leaf nodes may have their own state.
+		this->structure->root->reset();
+	}
+}
+
+void BehaviorTree::Tree::reset(BehaviorTree::TreeInstance& instance)
+{
+	// Reset per-agent state streams. Immutable structure stays in Tree.
+	std::fill(instance.runningChildren.begin(), instance.runningChildren.end(), BehaviorTree::NO_RUNNING_CHILD);
+	std::fill(instance.counters.begin(), instance.counters.end(), 0);
+	std::fill(instance.timers.begin(), instance.timers.end(), 0.0f);
+	std::fill(instance.delayElapsed.begin(), instance.delayElapsed.end(), 0.0f);
+	std::fill(instance.delayFinished.begin(), instance.delayFinished.end(), static_cast<unsigned char>(0));
+	std::fill(instance.delayResults.begin(), instance.delayResults.end(), BehaviorTree::NODE_STATE::FAILURE);
+
+	// Restore baked child order
+	instance.childOrder = this->structure->childIndices;
+	instance.lastState = BehaviorTree::NODE_STATE::FAILURE;
+	instance.runningNodeIndex = -1;
+}
+
+void BehaviorTree::Tree::resetActive()
+{
+	this->resetActive(this->defaultInstance);
+}
+
+void BehaviorTree::Tree::resetActive(BehaviorTree::TreeInstance& instance)
+{
+	if (this->structure->nodes.empty() || instance.nodeCount != static_cast<int>(this->structure->nodes.size()))
+	{
+		// Baked with nullptr root, or instance wasn't created from this tree
+		return;
+	}
+
+	// Walk the running child slots from root to the deepest RUNNING node,
+	// clearing state only on that path. Everything off the path never ran
+	// since its last completion and already is in its starting state.
+	int index = 0;
+
+	while (true)
+	{
+		const BakedNode& bakedNode = this->structure->nodes.at(index);
+
+		switch (bakedNode.type)
+		{
+		case BehaviorTree::NODE_TYPE::SELECTOR:
+		case BehaviorTree::NODE_TYPE::RANDOM_SELECTOR:
+		case BehaviorTree::NODE_TYPE::SEQUENCE:
+		case BehaviorTree::NODE_TYPE::RANDOM_SEQUENCE:
+		{
+			const int runningChild = instance.runningChildren.at(bakedNode.stateSlot);
+			if (runningChild == BehaviorTree::NO_RUNNING_CHILD)
+			{
+				// Nothing in flight below this composite
+				instance.runningNodeIndex = -1;
+				instance.lastState = BehaviorTree::NODE_STATE::FAILURE;
+				return;
+			}
+
+			// Clear the slot and descend in to the running branch
+			instance.runningChildren.at(bakedNode.stateSlot) = BehaviorTree::NO_RUNNING_CHILD;
+			index = instance.childOrder.at(bakedNode.childStart + runningChild);
+		}
+			break;
+		case BehaviorTree::NODE_TYPE::DELAY_TIME:
+		{
+			// Clear the delay clock. Same wipe as Tree::reset, one slot only.
+			instance.delayElapsed.at(bakedNode.stateSlot) = 0;
+			instance.delayFinished.at(bakedNode.stateSlot) = 0;
+			instance.delayResults.at(bakedNode.stateSlot) = BehaviorTree::NODE_STATE::FAILURE;
+
+			if (bakedNode.childCount == 0)
+			{
+				instance.runningNodeIndex = -1;
+				instance.lastState = BehaviorTree::NODE_STATE::FAILURE;
+				return;
+			}
+
+			index = instance.childOrder.at(bakedNode.childStart);
+		}
+			break;
+		case BehaviorTree::NODE_TYPE::TIME_LIMIT:
+		{
+			// Clear the elapsed time
+			instance.timers.at(bakedNode.stateSlot) = 0;
+
+			if (bakedNode.childCount == 0)
+			{
+				instance.runningNodeIndex = -1;
+				instance.lastState = BehaviorTree::NODE_STATE::FAILURE;
+				return;
+			}
+
+			index = instance.childOrder.at(bakedNode.childStart);
+		}
+			break;
+		case BehaviorTree::NODE_TYPE::INVERTER:
+		case BehaviorTree::NODE_TYPE::SUCCEEDER:
+		case BehaviorTree::NODE_TYPE::FAILER:
+		case BehaviorTree::NODE_TYPE::REPEATER:
+		case BehaviorTree::NODE_TYPE::REPEAT_UNTIL_FAIL:
+		case BehaviorTree::NODE_TYPE::REPEAT_UNTIL_SUCCESS:
+		case BehaviorTree::NODE_TYPE::LIMITER:
+		{
+			// Limiter counters are kept on purpose; an interrupt doesn't
+			// refund executions. Pass through to the child.
+			if (bakedNode.childCount == 0)
+			{
+				instance.runningNodeIndex = -1;
+				instance.lastState = BehaviorTree::NODE_STATE::FAILURE;
+				return;
+			}
+
+			index = instance.childOrder.at(bakedNode.childStart);
+		}
+			break;
+		case BehaviorTree::NODE_TYPE::LEAF:
+		default:
+		{
+			// The deepest node on the path. Leaf state lives in the node.
+			if (bakedNode.node != nullptr)
+			{
+				bakedNode.node->reset();
+			}
+
+			instance.runningNodeIndex = -1;
+			instance.lastState = BehaviorTree::NODE_STATE::FAILURE;
+			return;
+		}
+			break;
+		}
+	}
+}
+
+const bool BehaviorTree::Tree::preempt(const int selectorIndex, const int branchSlot)
 {
-	// Delete children
-	clearChildren();
+	// Single-agent front-end. Uses the built-in instance.
+	return this->preempt(this->defaultInstance, selectorIndex, branchSlot);
 }
 
+const bool BehaviorTree::Tree::preempt(BehaviorTree::TreeInstance& instance, const int selectorIndex, const int branchSlot)
+{
+	if (this->structure->nodes.empty() || instance.nodeCount != static_cast<int>(this->structure->nodes.size()))
+	{
+		// Baked with nullptr root, or instance wasn't created from this tree
+		return false;
+	}
 
+	if (selectorIndex < 0 || selectorIndex >= static_cast<int>(this->structure->nodes.size()))
+	{
+		return false;
+	}
 
+	const BakedNode& selector = this->structure->nodes.at(selectorIndex);
 
+	if (selector.type != BehaviorTree::NODE_TYPE::SELECTOR)
+	{
+		// Priority lanes need a stable child order; a RANDOM_SELECTOR
+		// reshuffles its lanes, so slots aren't priorities there
+		return false;
+	}
 
-BehaviorTree::Selector::Selector(std::unique_ptr<BehaviorTree::Node> child) 
-: BehaviorTree::CompositeNode(std::move(child)) 
-{}
-
-BehaviorTree::Selector::Selector(std::vector<std::unique_ptr<BehaviorTree::Node>>& children) 
-: BehaviorTree::CompositeNode(children) 
-{}
+	if (branchSlot < 0 || branchSlot >= selector.childCount)
+	{
+		return false;
+	}
 
-BehaviorTree::Selector::~Selector() {}
+	int& runningChild = instance.runningChildren.at(selector.stateSlot);
 
-const BehaviorTree::NODE_STATE BehaviorTree::Selector::update(const float delta)
-{
-	if (this->children.empty())
+	if (runningChild == BehaviorTree::NO_RUNNING_CHILD || branchSlot >= runningChild)
 	{
-		return BehaviorTree::NODE_STATE::ERROR;
+		// Nothing to preempt, or the running branch already has equal or
+		// higher priority
+		return false;
 	}
 
-	int start = 0;
-	
-	// Update running child if there's one.
-	if (this->isRunningChildIndexValid())
+	// Reset only the abandoned path: the running branch's whole subtree,
+	// one contiguous flat range thanks to the depth first bake
+	const int abandoned = instance.childOrder.at(selector.childStart + runningChild);
+	const int end = this->subtreeEnd(abandoned);
+
+	for (int i = abandoned; i < end; i++)
 	{
-		const BehaviorTree::NODE_STATE runningChildstate = BehaviorTree::CompositeNode::updateRunningChild(delta, start);
+		this->resetBakedNodeState(instance, i);
+	}
 
-		if (runningChildstate == BehaviorTree::NODE_STATE::SUCCESS || 
-			runningChildstate == BehaviorTree::NODE_STATE::RUNNING)
-		{
-			// Stop and return
-			return runningChildstate;
-		}
-		else if (runningChildstate == BehaviorTree::NODE_STATE::ERROR)
-		{
-			// It was error.
-			if (BehaviorTree::IGNORE_ERROR == false)
-			{
-				// Can't ignore error. Return.
-				return BehaviorTree::NODE_STATE::ERROR;
-			}
-		}
-		// Else, it was either FAILURE or ERROR that can be ignored.
+	// The next update enters directly at the preempting branch through the
+	// running child slot; higher priority lanes are not re-evaluated. If
+	// the branch fails, the lanes after it run as usual.
+	runningChild = branchSlot;
+
+	if (instance.runningNodeIndex >= abandoned && instance.runningNodeIndex < end)
+	{
+		// The running-path cache pointed in to the abandoned subtree. Move
+		// it to the preempting branch when its path can be resumed, so the
+		// next update doesn't re-descend from the root.
+		const int branchIndex = instance.childOrder.at(selector.childStart + branchSlot);
+		instance.runningNodeIndex = this->structure->nodes.at(branchIndex).onCompositePath ? branchIndex : -1;
 	}
 
-	// Update children
-	return this->updateChildren(start, delta, BehaviorTree::NODE_STATE::FAILURE);
+	return true;
 }
 
+#if defined(BT_PROFILING)
+BehaviorTree::Profiler& BehaviorTree::Tree::getProfiler()
+{
+	return this->profiler;
+}
+#endif
 
+const int BehaviorTree::Tree::getNodeCount()
+{
+	return static_cast<int>(this->structure->nodes.size());
+}
 
+const BehaviorTree::ERROR_POLICY BehaviorTree::Tree::getErrorPolicy()
+{
+	return this->structure->errorPolicy;
+}
 
+const bool BehaviorTree::Tree::isValid()
+{
+	return this->structure->valid;
+}
 
-BehaviorTree::RandomSelector::RandomSelector(std::unique_ptr<BehaviorTree::Node> child) 
-: BehaviorTree::Selector(std::move(child))
-, needShuffle(true) 
-{}
+const std::string& BehaviorTree::Tree::getBakeError()
+{
+	return this->structure->bakeError;
+}
 
-BehaviorTree::RandomSelector::RandomSelector(std::vector<std::unique_ptr<BehaviorTree::Node>>& children)
-: BehaviorTree::Selector(children)
-, needShuffle(true)
-{}
+//State blob magic. 'BTST'.
+static const unsigned int TREE_STATE_MAGIC = 0x42545354;
 
-BehaviorTree::RandomSelector::~RandomSelector() {}
+//State blob format version. Bumped when the layout changes.
+static const unsigned int TREE_STATE_VERSION = 1;
 
-const BehaviorTree::NODE_STATE BehaviorTree::RandomSelector::update(const float delta)
+/**
+*	@name appendStateValue
+*	@brief Append one plain value to a state blob.
+*/
+template<class T>
+static void appendStateValue(std::vector<unsigned char>& buffer, const T& value)
 {
-	if (this->children.empty())
+	const std::size_t offset = buffer.size();
+	buffer.resize(offset + sizeof(T));
+	std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+/**
+*	@name readStateValue
+*	@brief Read one plain value out of a state blob, advancing the cursor.
+*
+*	@return True on success. False if the blob ends short.
+*/
+template<class T>
+static const bool readStateValue(const std::vector<unsigned char>& buffer, std::size_t& cursor, T& value)
+{
+	if (cursor + sizeof(T) > buffer.size())
 	{
-		return BehaviorTree::NODE_STATE::ERROR;
+		return false;
 	}
 
-	// No need to shuffle children if there's only one child
-	if (this->runningChildIndex == BehaviorTree::NO_RUNNING_CHILD && needShuffle)
+	std::memcpy(&value, buffer.data() + cursor, sizeof(T));
+	cursor += sizeof(T);
+
+	return true;
+}
+
+const bool BehaviorTree::Tree::saveState(std::vector<unsigned char>& buffer)
+{
+	return this->saveState(this->defaultInstance, buffer);
+}
+
+const bool BehaviorTree::Tree::saveState(BehaviorTree::TreeInstance& instance, std::vector<unsigned char>& buffer)
+{
+	buffer.clear();
+
+	if (instance.nodeCount != static_cast<int>(this->structure->nodes.size()))
 	{
-		auto engine = std::default_random_engine{};
-		std::shuffle(std::begin(this->children), std::end(this->children), engine);
+		// Instance wasn't created from this tree
+		return false;
 	}
-	
-	BehaviorTree::NODE_STATE state = BehaviorTree::Selector::update(delta);
 
-	if (state == BehaviorTree::NODE_STATE::RUNNING)
+	appendStateValue(buffer, TREE_STATE_MAGIC);
+	appendStateValue(buffer, TREE_STATE_VERSION);
+	appendStateValue(buffer, instance.nodeCount);
+
+	// Per-field state streams, in a fixed order. Counts are implied by the
+	// structure, but stored anyway so a mismatched blob is caught on load.
+	appendStateValue(buffer, static_cast<int>(instance.runningChildren.size()));
+	for (const int runningChild : instance.runningChildren)
 	{
-		// If random selector is still running, don't shuffle
-		this->needShuffle = false;
+		appendStateValue(buffer, runningChild);
 	}
-	else
+
+	appendStateValue(buffer, static_cast<int>(instance.counters.size()));
+	for (const int counter : instance.counters)
 	{
-		// If random selector is not running, shuffle it!
-		this->needShuffle = true;
+		appendStateValue(buffer, counter);
 	}
 
-	return state;
+	appendStateValue(buffer, static_cast<int>(instance.timers.size()));
+	for (const float timer : instance.timers)
+	{
+		appendStateValue(buffer, timer);
+	}
+
+	appendStateValue(buffer, static_cast<int>(instance.delayElapsed.size()));
+	for (std::size_t i = 0; i < instance.delayElapsed.size(); i++)
+	{
+		appendStateValue(buffer, instance.delayElapsed.at(i));
+		appendStateValue(buffer, instance.delayFinished.at(i));
+		appendStateValue(buffer, static_cast<unsigned char>(instance.delayResults.at(i)));
+	}
+
+	appendStateValue(buffer, static_cast<int>(instance.childOrder.size()));
+	for (const int childIndex : instance.childOrder)
+	{
+		appendStateValue(buffer, childIndex);
+	}
+
+	appendStateValue(buffer, instance.rngState);
+	appendStateValue(buffer, instance.runningNodeIndex);
+	appendStateValue(buffer, static_cast<unsigned char>(instance.lastState));
+
+	return true;
 }
 
+const bool BehaviorTree::Tree::loadState(const std::vector<unsigned char>& buffer)
+{
+	return this->loadState(this->defaultInstance, buffer);
+}
 
+const bool BehaviorTree::Tree::loadState(BehaviorTree::TreeInstance& instance, const std::vector<unsigned char>& buffer)
+{
+	const int nodeCount = static_cast<int>(this->structure->nodes.size());
 
+	if (instance.nodeCount != nodeCount)
+	{
+		// Instance wasn't created from this tree
+		return false;
+	}
 
-BehaviorTree::Sequence::Sequence(std::unique_ptr<BehaviorTree::Node> child)
-: BehaviorTree::CompositeNode(std::move(child))
-{}
+	std::size_t cursor = 0;
 
-BehaviorTree::Sequence::Sequence(std::vector<std::unique_ptr<BehaviorTree::Node>>& children)
-: BehaviorTree::CompositeNode(children)
-{}
+	// Everything is parsed and validated in to locals first; the instance is
+	// only written once the whole blob checked out, so a corrupt or
+	// mismatched blob can't leave an agent half-restored.
+	unsigned int magic = 0;
+	unsigned int version = 0;
+	int blobNodeCount = 0;
 
-BehaviorTree::Sequence::~Sequence() {}
+	if (readStateValue(buffer, cursor, magic) == false || magic != TREE_STATE_MAGIC)
+	{
+		return false;
+	}
 
-const BehaviorTree::NODE_STATE BehaviorTree::Sequence::update(const float delta)
-{
-	if (this->children.empty())
+	if (readStateValue(buffer, cursor, version) == false || version != TREE_STATE_VERSION)
 	{
-		return BehaviorTree::NODE_STATE::ERROR;
+		return false;
 	}
 
-	int start = 0;
+	if (readStateValue(buffer, cursor, blobNodeCount) == false || blobNodeCount != nodeCount)
+	{
+		return false;
+	}
 
-	// Update running child if there's one.
-	if (this->isRunningChildIndexValid())
+	int count = 0;
+
+	std::vector<int> runningChildren;
+	if (readStateValue(buffer, cursor, count) == false || count != this->structure->runningChildSlotCount)
 	{
-		const BehaviorTree::NODE_STATE runningChildstate = BehaviorTree::CompositeNode::updateRunningChild(delta, start);
+		return false;
+	}
+	runningChildren.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		if (readStateValue(buffer, cursor, runningChildren.at(i)) == false || runningChildren.at(i) < BehaviorTree::NO_RUNNING_CHILD)
+		{
+			return false;
+		}
+	}
 
-		if (runningChildstate == BehaviorTree::NODE_STATE::FAILURE ||
-			runningChildstate == BehaviorTree::NODE_STATE::RUNNING)
+	std::vector<int> counters;
+	if (readStateValue(buffer, cursor, count) == false || count != this->structure->counterSlotCount)
+	{
+		return false;
+	}
+	counters.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		if (readStateValue(buffer, cursor, counters.at(i)) == false)
 		{
-			// If failed, stop sequence.
-			// If it's still running, keep running.
-			return runningChildstate;
+			return false;
 		}
-		else if (runningChildstate == BehaviorTree::NODE_STATE::ERROR)
+	}
+
+	std::vector<float> timers;
+	if (readStateValue(buffer, cursor, count) == false || count != this->structure->timerSlotCount)
+	{
+		return false;
+	}
+	timers.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		if (readStateValue(buffer, cursor, timers.at(i)) == false)
 		{
-			// Error occured
-			if (BehaviorTree::IGNORE_ERROR == false)
-			{
-				// Can't ignore error. Return.
-				return runningChildstate;
-			}
-			// Else, this error can be ignored and considered as SUCCESS. keep go on.
+			return false;
 		}
-		// Else, if status is SUCCESS, keep go on.
 	}
 
-	// Update children
-	return this->updateChildren(start, delta, BehaviorTree::NODE_STATE::SUCCESS);
-}
+	std::vector<float> delayElapsed;
+	std::vector<unsigned char> delayFinished;
+	std::vector<BehaviorTree::NODE_STATE> delayResults;
+	if (readStateValue(buffer, cursor, count) == false || count != this->structure->delaySlotCount)
+	{
+		return false;
+	}
+	delayElapsed.resize(count);
+	delayFinished.resize(count);
+	delayResults.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		unsigned char result = 0;
 
+		if (readStateValue(buffer, cursor, delayElapsed.at(i)) == false ||
+			readStateValue(buffer, cursor, delayFinished.at(i)) == false ||
+			readStateValue(buffer, cursor, result) == false ||
+			result > static_cast<unsigned char>(BehaviorTree::NODE_STATE::ERROR))
+		{
+			return false;
+		}
 
+		delayResults.at(i) = static_cast<BehaviorTree::NODE_STATE>(result);
+	}
 
+	std::vector<int> childOrder;
+	if (readStateValue(buffer, cursor, count) == false || count != static_cast<int>(this->structure->childIndices.size()))
+	{
+		return false;
+	}
+	childOrder.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		if (readStateValue(buffer, cursor, childOrder.at(i)) == false || childOrder.at(i) < 0 || childOrder.at(i) >= nodeCount)
+		{
+			return false;
+		}
+	}
 
-BehaviorTree::RandomSequence::RandomSequence(std::unique_ptr<BehaviorTree::Node> child) 
-: BehaviorTree::Sequence(std::move(child))
-{}
+	// Every node's slice must be a permutation of the structure's slice: each
+	// entry a child of the owning node, no index twice. A forged slice could
+	// point a composite at an ancestor and make the iterative walk cycle.
+	// Every non-root node sits in exactly one slice, so a single seen pass
+	// catches duplicates across the whole array too.
+	std::vector<unsigned char> seen(nodeCount, 0);
+	for (int i = 0; i < nodeCount; i++)
+	{
+		const BakedNode& owner = this->structure->nodes.at(i);
 
-BehaviorTree::RandomSequence::RandomSequence(std::vector<std::unique_ptr<BehaviorTree::Node>>& children)
-: BehaviorTree::Sequence(children)
-{}
+		for (int slot = 0; slot < owner.childCount; slot++)
+		{
+			const int childIndex = childOrder.at(owner.childStart + slot);
 
-BehaviorTree::RandomSequence::~RandomSequence() {}
+			if (this->structure->nodes.at(childIndex).parent != i || seen.at(childIndex) != 0)
+			{
+				return false;
+			}
 
-const BehaviorTree::NODE_STATE BehaviorTree::RandomSequence::update(const float delta)
-{
-	if (this->children.empty())
+			seen.at(childIndex) = 1;
+		}
+	}
+
+	unsigned int rngState = 0;
+	int runningNodeIndex = -1;
+	unsigned char lastState = 0;
+
+	// xorshift state must not be 0
+	if (readStateValue(buffer, cursor, rngState) == false || rngState == 0)
 	{
-		return BehaviorTree::NODE_STATE::ERROR;
+		return false;
 	}
 
-	if (this->runningChildIndex == BehaviorTree::NO_RUNNING_CHILD && needShuffle)
+	if (readStateValue(buffer, cursor, runningNodeIndex) == false || runningNodeIndex < -1 || runningNodeIndex >= nodeCount)
 	{
-		auto engine = std::default_random_engine{};
-		std::shuffle(std::begin(this->children), std::end(this->children), engine);
+		return false;
 	}
 
-	BehaviorTree::NODE_STATE state = BehaviorTree::Sequence::update(delta);
+	if (runningNodeIndex != -1 && this->structure->nodes.at(runningNodeIndex).onCompositePath == false)
+	{
+		// The resume walk reads a running child slot from every ancestor, so
+		// a cached index under a decorator would step out of the state
+		// streams on the next update. No save ever writes one; reject it.
+		return false;
+	}
 
-	if (state == BehaviorTree::NODE_STATE::RUNNING)
+	if (readStateValue(buffer, cursor, lastState) == false || lastState > static_cast<unsigned char>(BehaviorTree::NODE_STATE::ERROR))
 	{
-		// If random selector is still running, don't shuffle
-		this->needShuffle = false;
+		return false;
 	}
-	else
+
+	if (cursor != buffer.size())
 	{
-		// If random selector is not running, shuffle it!
-		this->needShuffle = true;
+		// Trailing bytes. Not a blob this version wrote.
+		return false;
 	}
 
-	return state;
-}
+	instance.runningChildren = std::move(runningChildren);
+	instance.counters = std::move(counters);
+	instance.timers = std::move(timers);
+	instance.delayElapsed = std::move(delayElapsed);
+	instance.delayFinished = std::move(delayFinished);
+	instance.delayResults = std::move(delayResults);
+	instance.childOrder = std::move(childOrder);
+	instance.rngState = rngState;
+	instance.runningNodeIndex = runningNodeIndex;
+	instance.lastState = static_cast<BehaviorTree::NODE_STATE>(lastState);
 
+	return true;
+}
 
 
 
 
-BehaviorTree::DecoratorNode::DecoratorNode(std::unique_ptr<BehaviorTree::Node> child)
+BehaviorTree::SubtreeRef::SubtreeRef(std::shared_ptr<BehaviorTree::Tree> subtree)
+: Node()
+, subtree(std::move(subtree))
 {
-	addChild(std::move(child));
+	if (this->subtree != nullptr)
+	{
+		// Per-agent state for the shared structure
+		this->instance = this->subtree->createInstance();
+	}
 }
 
-BehaviorTree::DecoratorNode::~DecoratorNode()
+const BehaviorTree::NODE_STATE BehaviorTree::SubtreeRef::update(const float delta)
 {
-	// Unique ptr will release for us
-	this->child = nullptr;
-}
+	BT_PROFILE_SCOPE(BehaviorTree::NODE_TYPE::LEAF);
 
-void BehaviorTree::DecoratorNode::addChild(std::unique_ptr<BehaviorTree::Node> child, const bool overwrite)
-{
-	if (child == nullptr)
-	{
-		this->child = std::move(child);
-	}
-	else
+	if (this->subtree == nullptr)
 	{
-		if (overwrite)
-		{
-			// unique_ptr will release for us
-			this->child = nullptr;
-			// move ptr
-			this->child = std::move(child);
-		}
+		// Detached ref, same rule as a decorator without a child
+		BT_PROFILE_RETURN(BehaviorTree::NODE_STATE::ERROR);
 	}
-}
-
-
 
+	BT_PROFILE_RETURN(this->subtree->update(this->instance, delta));
+}
 
-BehaviorTree::Inverter::Inverter() : BehaviorTree::DecoratorNode(nullptr) {}
-
-BehaviorTree::Inverter::Inverter(std::unique_ptr<BehaviorTree::Node> child) : BehaviorTree::DecoratorNode(std::move(child)) {}
-
-const BehaviorTree::NODE_STATE BehaviorTree::Inverter::update(const float delta)
+void BehaviorTree::SubtreeRef::reset()
 {
-	// Update child
-	if (this->child == nullptr)
+	if (this->subtree != nullptr)
 	{
-		// Doesn't have child. Return ERROR
-		return BehaviorTree::NODE_STATE::ERROR;
+		// Only this agent's state resets. The structure is shared.
+		this->subtree->reset(this->instance);
 	}
+}
 
-	BehaviorTree::NODE_STATE state = this->child->update(delta);
+void BehaviorTree::SubtreeRef::setSubtree(std::shared_ptr<BehaviorTree::Tree> subtree)
+{
+	this->subtree = std::move(subtree);
 
-	if (state == BehaviorTree::NODE_STATE::RUNNING || state == BehaviorTree::NODE_STATE::ERROR)
-	{
-		return state;
-	}
-	else
+	if (this->subtree != nullptr)
 	{
-		// If status was SUCCESS or FAILURE, invert result.
-		return state == BehaviorTree::NODE_STATE::SUCCESS ? BehaviorTree::NODE_STATE::FAILURE : BehaviorTree::NODE_STATE::SUCCESS;
+		// State streams are sized for one structure; make fresh ones
+		this->instance = this->subtree->createInstance();
 	}
-
 }
 
+std::shared_ptr<BehaviorTree::Tree> BehaviorTree::SubtreeRef::getSubtree()
+{
+	return this->subtree;
+}
 
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::SubtreeRef::clone()
+{
+	// Shares the subtree; the new ref's constructor makes a fresh instance
+	return std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::SubtreeRef(this->subtree));
+}
 
 
 
-BehaviorTree::Succeeder::Succeeder() : BehaviorTree::DecoratorNode(nullptr) {}
 
-BehaviorTree::Succeeder::Succeeder(std::unique_ptr<BehaviorTree::Node> child) : BehaviorTree::DecoratorNode(std::move(child)) {}
+std::unordered_map<int, std::unique_ptr<BehaviorTree::Node>>& BehaviorTree::ArchetypeRegistry::getPrototypes()
+{
+	static std::unordered_map<int, std::unique_ptr<BehaviorTree::Node>> prototypes;
+	return prototypes;
+}
 
-const BehaviorTree::NODE_STATE BehaviorTree::Succeeder::update(const float delta)
+const bool BehaviorTree::ArchetypeRegistry::registerArchetype(const int id, std::unique_ptr<BehaviorTree::Node> prototype)
 {
-	if (this->child == nullptr)
+	if (prototype == nullptr)
 	{
-		return BehaviorTree::NODE_STATE::ERROR;
+		return false;
 	}
 
-	// Update child. We don't need the result
-	this->child->update(delta);
-	// Always return SUCCSS.
-	return BehaviorTree::NODE_STATE::SUCCESS;
-}
+	auto& prototypes = getPrototypes();
+	if (prototypes.find(id) != prototypes.end())
+	{
+		// ID taken. Unregister first to replace a prototype.
+		return false;
+	}
 
+	prototypes.emplace(id, std::move(prototype));
 
+	return true;
+}
 
+const bool BehaviorTree::ArchetypeRegistry::unregisterArchetype(const int id)
+{
+	return getPrototypes().erase(id) > 0;
+}
 
+std::unique_ptr<BehaviorTree::Node> BehaviorTree::ArchetypeRegistry::spawn(const int id)
+{
+	auto& prototypes = getPrototypes();
 
-BehaviorTree::Failer::Failer() : BehaviorTree::DecoratorNode(nullptr) {}
+	auto it = prototypes.find(id);
+	if (it == prototypes.end())
+	{
+		return nullptr;
+	}
 
-BehaviorTree::Failer::Failer(std::unique_ptr<BehaviorTree::Node> child) : BehaviorTree::DecoratorNode(std::move(child)) {}
+	return it->second->clone();
+}
 
-const BehaviorTree::NODE_STATE BehaviorTree::Failer::update(const float delta)
+std::unique_ptr<BehaviorTree::Tree> BehaviorTree::ArchetypeRegistry::spawnTree(const int id, const BehaviorTree::ERROR_POLICY errorPolicy)
 {
-	if (this->child == nullptr)
+	std::unique_ptr<BehaviorTree::Node> root = spawn(id);
+	if (root == nullptr)
 	{
-		return BehaviorTree::NODE_STATE::ERROR;
+		return nullptr;
 	}
 
-	// Update child. We don't need the result
-	this->child->update(delta);
-	// Always return FAILURE.
-	return BehaviorTree::NODE_STATE::FAILURE;
+	return std::unique_ptr<BehaviorTree::Tree>(new BehaviorTree::Tree(std::move(root), errorPolicy));
 }
 
 
 
 
-BehaviorTree::Repeat::Repeat(const int repeat) : BehaviorTree::DecoratorNode(nullptr)
+void BehaviorTree::Batch::update(BehaviorTree::Tree& tree, std::vector<BehaviorTree::TreeInstance>& instances, const float delta)
 {
-	if (repeat < 0)
-	{
-		this->repeat = 0;
-	}
+	BehaviorTree::Batch::update(tree, instances.data(), static_cast<int>(instances.size()), delta);
 }
 
-BehaviorTree::Repeat::Repeat(std::unique_ptr<BehaviorTree::Node> child, const int repeat) : BehaviorTree::DecoratorNode(std::move(child))
+void BehaviorTree::Batch::update(BehaviorTree::Tree& tree, BehaviorTree::TreeInstance* instances, const int count, const float delta)
 {
-	if (repeat < 0)
+	if (instances == nullptr)
 	{
-		this->repeat = 0;
+		return;
+	}
+
+	// Shared structure is read once for the whole batch. Per-agent state
+	// is iterated linearly, instance by instance.
+	for (int i = 0; i < count; i++)
+	{
+		tree.update(instances[i], delta);
 	}
 }
 
-void BehaviorTree::Repeat::setRepeat(const int repeat)
+
+
+BehaviorTree::Scheduler::Scheduler(const int workerCount, const int phaseBucketCount)
+: frameCount(0)
+, remainingJobs(0)
+, shutdown(false)
+, phaseBucketCount((phaseBucketCount < 1) ? 1 : phaseBucketCount)
 {
-	if (repeat < 0)
+	this->bucketPopulations.resize(this->phaseBucketCount, 0);
+
+	int count = workerCount;
+	if (count <= 0)
 	{
-		this->repeat = 0;
+		// Fall back to hardware concurrency. Guarantee at least one worker.
+		count = static_cast<int>(std::thread::hardware_concurrency());
+		if (count <= 0)
+		{
+			count = 1;
+		}
 	}
-	else
+
+	for (int i = 0; i < count; i++)
 	{
-		this->repeat = repeat;
+		this->workers.push_back(std::unique_ptr<Worker>(new Worker()));
 	}
-}
 
-const int BehaviorTree::Repeat::getRepeat()
-{
-	return this->repeat;
+	for (int i = 0; i < count; i++)
+	{
+		this->threads.push_back(std::thread(&BehaviorTree::Scheduler::workerLoop, this, i));
+	}
 }
 
+BehaviorTree::Scheduler::~Scheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->frameMutex);
+		this->shutdown = true;
+	}
 
+	// Wake every worker so they can observe shutdown
+	this->frameStartSignal.notify_all();
 
+	for (auto& thread : this->threads)
+	{
+		thread.join();
+	}
+}
 
-BehaviorTree::Repeater::Repeater(const int repeat) : BehaviorTree::Repeat(repeat) 
+//Accumulation period of a tick rate in seconds. 0 ticks every frame.
+static const float tickRatePeriod(const BehaviorTree::Scheduler::TICK_RATE rate)
 {
-	if (repeat == BehaviorTree::Repeat::REPEAT_INFINITE)
+	switch (rate)
 	{
-		// Repeater can't have infinite because it faills to infinite loop
-		this->repeat = 0;
+	case BehaviorTree::Scheduler::TICK_RATE::TEN_HZ:
+		return 0.1f;
+	case BehaviorTree::Scheduler::TICK_RATE::ONE_HZ:
+		return 1.0f;
+	case BehaviorTree::Scheduler::TICK_RATE::EVERY_FRAME:
+	default:
+		return 0.0f;
 	}
 }
 
-BehaviorTree::Repeater::Repeater(std::unique_ptr<BehaviorTree::Node> child, const int repeat) : BehaviorTree::Repeat(std::move(child), repeat)
+//First due threshold of a phase bucket. Bucket 0 waits the whole period,
+//later buckets come due earlier by their share of it, so pairs registered
+//together spread across the period instead of spiking one frame.
+static const float phaseDueThreshold(const BehaviorTree::Scheduler::TICK_RATE rate, const int bucket, const int bucketCount)
 {
-	if (repeat == BehaviorTree::Repeat::REPEAT_INFINITE)
+	const float period = tickRatePeriod(rate);
+
+	if (bucket <= 0 || bucketCount <= 1)
 	{
-		// Repeater can't have infinite because it faills to infinite loop
-		this->repeat = 0;
+		return period;
 	}
+
+	return period - period * (static_cast<float>(bucket) / static_cast<float>(bucketCount));
 }
 
-const BehaviorTree::NODE_STATE BehaviorTree::Repeater::update(const float delta)
+void BehaviorTree::Scheduler::addTree(BehaviorTree::Tree* tree, BehaviorTree::TreeInstance* instance, const BehaviorTree::Scheduler::TICK_RATE rate)
 {
-	if (this->repeat == 0)
+	if (tree == nullptr || instance == nullptr)
 	{
-		return BehaviorTree::NODE_STATE::ERROR;
+		return;
 	}
 
-	// Repeat update for certain amount of times.
-	for (int i = 0; i < repeat; i++)
+	Job job;
+	job.tree = tree;
+	job.instance = instance;
+	job.rate = rate;
+	job.accumulatedDelta = 0.0f;
+	job.jobDelta = 0.0f;
+
+	if (rate == TICK_RATE::EVERY_FRAME)
 	{
-		// Update child.
-		BehaviorTree::NODE_STATE state = this->child->update(delta);
-		if (state == BehaviorTree::NODE_STATE::SUCCESS || state == BehaviorTree::NODE_STATE::FAILURE)
-		{
-			// If status was SUCCESS or FAILURE, keep go on
-			continue;
-		}
-		else
-		{
-			return state;
-		}
+		// Ticked every frame; phase doesn't apply
+		job.phaseBucket = -1;
+		job.dueThreshold = 0.0f;
 	}
-	
-	// Finished repeating. Return SUCCESS
-	return BehaviorTree::NODE_STATE::SUCCESS;
+	else
+	{
+		// Fill the emptiest bucket, so same-frame registrations spread
+		job.phaseBucket = this->pickPhaseBucket();
+		job.dueThreshold = phaseDueThreshold(rate, job.phaseBucket, this->phaseBucketCount);
+		this->bucketPopulations.at(job.phaseBucket)++;
+	}
+
+	this->registeredJobs.push_back(job);
 }
 
+const bool BehaviorTree::Scheduler::removeTree(BehaviorTree::TreeInstance* instance)
+{
+	for (auto it = this->registeredJobs.begin(); it != this->registeredJobs.end(); ++it)
+	{
+		if (it->instance == instance)
+		{
+			if (it->phaseBucket != -1)
+			{
+				this->bucketPopulations.at(it->phaseBucket)--;
+			}
+
+			this->registeredJobs.erase(it);
 
+			// Removals can empty some buckets while others stay full.
+			// Rebalance when the gap grew past a doubling.
+			int min = this->registeredJobs.empty() ? 0 : static_cast<int>(this->registeredJobs.size());
+			int max = 0;
+			for (const int population : this->bucketPopulations)
+			{
+				min = std::min(min, population);
+				max = std::max(max, population);
+			}
 
+			if (max > 2 * min + 1)
+			{
+				this->rebalancePhaseBuckets();
+			}
 
-BehaviorTree::RepeatUntil::RepeatUntil(const int repeat, const BehaviorTree::NODE_STATE conditionStatus) : BehaviorTree::Repeat(repeat), desiredStatus(conditionStatus) {}
+			return true;
+		}
+	}
 
-BehaviorTree::RepeatUntil::RepeatUntil(std::unique_ptr<BehaviorTree::Node> child, const int repeat, const BehaviorTree::NODE_STATE conditionStatus) : BehaviorTree::Repeat(std::move(child), repeat), desiredStatus(conditionStatus) {}
+	return false;
+}
 
-const BehaviorTree::NODE_STATE BehaviorTree::RepeatUntil::update(const float delta)
+const int BehaviorTree::Scheduler::pickPhaseBucket()
 {
-	if (this->repeat == 0)
-	{
-		return BehaviorTree::NODE_STATE::ERROR;
-	}
+	int bucket = 0;
 
-	if (this->repeat == BehaviorTree::Repeat::REPEAT_INFINITE)
+	for (int i = 1; i < this->phaseBucketCount; i++)
 	{
-		BehaviorTree::NODE_STATE state;
-		// Run infitie loop until status is failure
-		do
+		if (this->bucketPopulations.at(i) < this->bucketPopulations.at(bucket))
 		{
-			// Update child.
-			state = this->child->update(delta);
-		} while (state != this->desiredStatus);
-
-		// Finished repeating. Return SUCCESS
-		return BehaviorTree::NODE_STATE::SUCCESS;
+			bucket = i;
+		}
 	}
-	else
+
+	return bucket;
+}
+
+void BehaviorTree::Scheduler::rebalancePhaseBuckets()
+{
+	std::fill(this->bucketPopulations.begin(), this->bucketPopulations.end(), 0);
+
+	int dealt = 0;
+	for (Job& job : this->registeredJobs)
 	{
-		// Repeat update for certain amount of times.
-		for (int i = 0; i < this->repeat; i++)
+		if (job.phaseBucket == -1)
 		{
-			// Update child.
-			BehaviorTree::NODE_STATE state = this->child->update(delta);
-			if (state == this->desiredStatus)
-			{
-				// Failed. return success.
-				return BehaviorTree::NODE_STATE::SUCCESS;
-			}
-			// Else, continue.
+			continue;
 		}
 
-		// Finished repeating. Haven't failed. Return FAILURE
-		return BehaviorTree::NODE_STATE::FAILURE;
+		// Round robin gives even populations. Gathered time is kept; only
+		// the due offset moves, so the pair still receives every second it
+		// actually waited.
+		job.phaseBucket = dealt % this->phaseBucketCount;
+		job.dueThreshold = phaseDueThreshold(job.rate, job.phaseBucket, this->phaseBucketCount);
+		this->bucketPopulations.at(job.phaseBucket)++;
+		dealt++;
 	}
 }
 
+const bool BehaviorTree::Scheduler::stealJob(const int thiefIndex, Job& job)
+{
+	const int workerCount = static_cast<int>(this->workers.size());
 
+	for (int i = 0; i < workerCount; i++)
+	{
+		if (i == thiefIndex)
+		{
+			continue;
+		}
 
+		Worker& victim = *this->workers.at(i);
+		std::lock_guard<std::mutex> lock(victim.jobsMutex);
 
+		if (victim.jobs.empty() == false)
+		{
+			// Steal from the back. Owner pops from the front.
+			job = victim.jobs.back();
+			victim.jobs.pop_back();
+			return true;
+		}
+	}
 
+	return false;
+}
 
-BehaviorTree::RepeatUntilFail::RepeatUntilFail(const int repeat) : BehaviorTree::RepeatUntil(repeat, BehaviorTree::NODE_STATE::FAILURE) {}
-
-BehaviorTree::RepeatUntilFail::RepeatUntilFail(std::unique_ptr<BehaviorTree::Node> child, const int repeat) : BehaviorTree::RepeatUntil(std::move(child), repeat, BehaviorTree::NODE_STATE::FAILURE) {}
-
-
+void BehaviorTree::Scheduler::workerLoop(const int workerIndex)
+{
+	Worker& self = *this->workers.at(workerIndex);
+	int lastFrameCount = 0;
 
+	while (true)
+	{
+		{
+			// Wait for a new frame or shutdown
+			std::unique_lock<std::mutex> lock(this->frameMutex);
+			this->frameStartSignal.wait(lock, [this, lastFrameCount]
+			{
+				return this->shutdown || this->frameCount != lastFrameCount;
+			});
 
+			if (this->shutdown)
+			{
+				return;
+			}
 
-BehaviorTree::RepeatUntilSuccess::RepeatUntilSuccess(const int repeat) : BehaviorTree::RepeatUntil(repeat, BehaviorTree::NODE_STATE::SUCCESS) {}
+			lastFrameCount = this->frameCount;
+		}
 
-BehaviorTree::RepeatUntilSuccess::RepeatUntilSuccess(std::unique_ptr<BehaviorTree::Node> child, const int repeat) : BehaviorTree::RepeatUntil(std::move(child), repeat, BehaviorTree::NODE_STATE::SUCCESS) {}
+		while (true)
+		{
+			Job job;
+			bool hasJob = false;
 
+			{
+				// Own jobs first
+				std::lock_guard<std::mutex> lock(self.jobsMutex);
+				if (self.jobs.empty() == false)
+				{
+					job = self.jobs.front();
+					self.jobs.pop_front();
+					hasJob = true;
+				}
+			}
 
+			if (hasJob == false)
+			{
+				// Own deque drained. Steal from a busy worker.
+				hasJob = this->stealJob(workerIndex, job);
+			}
 
+			if (hasJob == false)
+			{
+				// Nothing left this frame
+				break;
+			}
 
-BehaviorTree::Limiter::Limiter(const int limit) : BehaviorTree::DecoratorNode(nullptr), limit(limit), limitCount(0) {}
+			// This worker owns the instance for this frame. Reduced-rate
+			// jobs carry the time of the frames they skipped.
+			job.tree->update(*job.instance, job.jobDelta);
 
-BehaviorTree::Limiter::Limiter(std::unique_ptr<BehaviorTree::Node> child, const int limit) : BehaviorTree::DecoratorNode(std::move(child)), limit(limit), limitCount(0) {}
+			if (this->remainingJobs.fetch_sub(1) == 1)
+			{
+				// Last job of the frame. Wake the main thread.
+				std::lock_guard<std::mutex> lock(this->frameMutex);
+				this->frameDoneSignal.notify_all();
+			}
+		}
+	}
+}
 
-const BehaviorTree::NODE_STATE BehaviorTree::Limiter::update(const float delta)
+void BehaviorTree::Scheduler::update(const float delta)
 {
-	if (this->child == nullptr)
+	const int registeredCount = static_cast<int>(this->registeredJobs.size());
+	if (registeredCount == 0)
 	{
-		return BehaviorTree::NODE_STATE::ERROR;
+		return;
 	}
 
-	if (this->limitCount < this->limit)
+	// Gather time and count the jobs due this frame. Reduced-rate jobs
+	// gather time until their period elapsed and get the whole of it.
+	const int workerCount = static_cast<int>(this->workers.size());
+	int jobCount = 0;
+
+	for (int i = 0; i < registeredCount; i++)
 	{
-		// Still can execute this node
-		BehaviorTree::NODE_STATE state = this->child->update(delta);
-		this->limitCount++;
+		Job& registered = this->registeredJobs.at(i);
+		registered.accumulatedDelta += delta;
+
+		if (registered.rate == TICK_RATE::EVERY_FRAME || registered.accumulatedDelta >= registered.dueThreshold)
+		{
+			jobCount++;
+		}
+	}
 
-		return state;
+	if (jobCount == 0)
+	{
+		// Every pair is reduced rate and none came due this frame
+		return;
 	}
 
-	return BehaviorTree::NODE_STATE::FAILURE;
-}
+	{
+		// Publish the frame size before any job is reachable. A worker that
+		// finished the last frame can still be inside its pop/steal loop and
+		// grab one of this frame's jobs the moment it is dealt; counting up
+		// front keeps its decrement from landing on a stale zero and being
+		// erased by the store, which would leave the frame barrier hanging.
+		std::lock_guard<std::mutex> lock(this->frameMutex);
+		this->remainingJobs.store(jobCount);
+	}
 
+	// Deal due jobs round robin to worker deques
+	int dealt = 0;
 
+	for (int i = 0; i < registeredCount; i++)
+	{
+		Job& registered = this->registeredJobs.at(i);
 
+		if (registered.rate != TICK_RATE::EVERY_FRAME && registered.accumulatedDelta < registered.dueThreshold)
+		{
+			// Not due yet. Keep gathering time.
+			continue;
+		}
 
-BehaviorTree::DelayTime::DelayTime(const float duration, const bool delayOnce) : BehaviorTree::DecoratorNode(nullptr), duration(duration), elapsedTime(0), delayOnce(delayOnce), childUpdateFinished(false) {}
+		registered.jobDelta = registered.accumulatedDelta;
+		registered.accumulatedDelta = 0.0f;
 
-BehaviorTree::DelayTime::DelayTime(std::unique_ptr<BehaviorTree::Node> child, const float duration, const bool delayOnce) : BehaviorTree::DecoratorNode(std::move(child)), duration(duration), elapsedTime(0), delayOnce(delayOnce), childUpdateFinished(false) {}
+		// The bucket offset only staggers the first tick. From here the
+		// whole period keeps the phases apart.
+		registered.dueThreshold = tickRatePeriod(registered.rate);
 
-const BehaviorTree::NODE_STATE BehaviorTree::DelayTime::update(const float delta)
-{
-	if (this->child == nullptr)
-	{
-		return BehaviorTree::NODE_STATE::ERROR;
+		Worker& worker = *this->workers.at(dealt % workerCount);
+		std::lock_guard<std::mutex> lock(worker.jobsMutex);
+		worker.jobs.push_back(registered);
+		dealt++;
 	}
 
-	if (this->elapsedTime >= 0 && this->elapsedTime < this->duration)
 	{
-		// Delaying
-		this->elapsedTime += delta;
-		return BehaviorTree::NODE_STATE::RUNNING;
+		// Open the frame. The counter bumps only after the deques are filled
+		// so a spuriously woken worker can't drain an empty frame and sleep
+		// through the real one.
+		std::lock_guard<std::mutex> lock(this->frameMutex);
+		this->frameCount++;
 	}
-	else
-	{
-		// Finished delaying
-		if (this->childUpdateFinished == false)
-		{
-			// Haven't finished child update yet
-			result = this->child->update(delta);
 
-			if (result != BehaviorTree::NODE_STATE::RUNNING)
-			{
-				// Either SUCCESS, FAILURE or ERROR. Update finished
-				this->childUpdateFinished = true;
+	this->frameStartSignal.notify_all();
 
-				if(this->delayOnce == false)
-				{
-					// Delay again
-					this->elapsedTime = 0;
-					this->childUpdateFinished = false;
-				}
-				// Else, only delaying once.
-			}
-		}
-		// Else, finished updating
-		return result;
+	{
+		// Block until the whole frame is ticked
+		std::unique_lock<std::mutex> lock(this->frameMutex);
+		this->frameDoneSignal.wait(lock, [this]
+		{
+			return this->remainingJobs.load() == 0;
+		});
 	}
 }
 
+const int BehaviorTree::Scheduler::getWorkerCount()
+{
+	return static_cast<int>(this->workers.size());
+}
 
+const int BehaviorTree::Scheduler::getPhaseBucketCount()
+{
+	return this->phaseBucketCount;
+}
 
-
-BehaviorTree::TimeLimit::TimeLimit(const float duration) : BehaviorTree::DecoratorNode(nullptr), duration(duration), elapsedTime(0), failed(false) {}
-
-BehaviorTree::TimeLimit::TimeLimit(std::unique_ptr<BehaviorTree::Node> child, const float duration) : BehaviorTree::DecoratorNode(std::move(child)), duration(duration), elapsedTime(0), failed(false) {}
-
-const BehaviorTree::NODE_STATE BehaviorTree::TimeLimit::update(const float delta)
+const int BehaviorTree::Scheduler::getPhaseBucketPopulation(const int bucket)
 {
-	if (this->child == nullptr)
+	if (bucket < 0 || bucket >= this->phaseBucketCount)
 	{
-		return BehaviorTree::NODE_STATE::ERROR;
+		return 0;
 	}
 
-	// Haven't failed yet
-	if (this->elapsedTime >= this->duration)
-	{
-		// Check if finished
-		BehaviorTree::NODE_STATE state = this->child->update(delta);
-		if (state == BehaviorTree::NODE_STATE::RUNNING)
-		{
-			// Failed
-			this->elapsedTime = 0;
-			return BehaviorTree::NODE_STATE::FAILURE;
-		}
-		else
-		{
-			return state;
-		}
-	}
-	else
-	{
-		// Add time
-		this->elapsedTime += delta;
-	}
-}
\ No newline at end of file
+	return this->bucketPopulations.at(bucket);
+}
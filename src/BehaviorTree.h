@@ -28,8 +28,19 @@
 
 #include <vector>
 #include <algorithm>
+#include <unordered_map>
+#include <string>
+#include <cstddef>
+#include <new>
 #include <random>
 #include <memory>
+#include <typeinfo>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
 
 /**
 *	@mainpage Behavior Tree Documentaion
@@ -50,13 +61,23 @@ namespace BehaviorTree
 	const static int NO_RUNNING_CHILD = -1;
 
 	/**
-	*	Set this true to ignore ERROR status while updating beahvior tree. 
-	*	If it's true, ERROR will be same as FAILURE status in Selector and Random Selector.
-	*	If it's true, ERROR will be same as SUCCESS status in Sequence and Random Sequence.
-	*	Set this false to behavior tree terminate when ERROR is occured.
-	*	True by default.
+	*	@enum ERROR_POLICY
+	*	@brief What a composite does when a child reports ERROR.
+	*
+	*	@details With IGNORE, ERROR is treated same as FAILURE in Selector and
+	*	Random Selector, and same as SUCCESS in Sequence and Random Sequence,
+	*	so the tick continues. With TERMINATE, the whole update stops and
+	*	returns ERROR. The policy is fixed per tree when the tree is built
+	*	(@see Tree::Tree, Node::setErrorPolicy), so the read costs one member
+	*	load and trees with different policies can tick concurrently.
+	*	IGNORE is the default, same as the old global IGNORE_ERROR flag this
+	*	replaces.
 	*/
-	static bool IGNORE_ERROR = true;
+	enum class ERROR_POLICY
+	{
+		IGNORE = 0,
+		TERMINATE
+	};
 
 	/**
 	*	@enum BehaviorTree::NODE_STATUS
@@ -91,6 +112,20 @@ namespace BehaviorTree
 	public:
 		//default virtual destructor
 		virtual ~Node() {};
+
+		/**
+		*	@name operator new
+		*	@brief Allocates from the active NodePool if one is bound, else from
+		*	the global heap. Inherited by every node class. @see NodePool
+		*/
+		static void* operator new(std::size_t size);
+
+		/**
+		*	@name operator delete
+		*	@brief No-op for pooled nodes; pooled memory is reclaimed in one step
+		*	by NodePool. Heap nodes are freed normally.
+		*/
+		static void operator delete(void* ptr);
 	public:
 		/**
 		*	@name update
@@ -111,6 +146,547 @@ namespace BehaviorTree
 		*	@brief Reset node
 		*/
 		virtual void reset() { return; };
+
+		/**
+		*	@name setErrorPolicy
+		*	@brief Set how ERROR from children is handled below this node.
+		*
+		*	@details Composites store the policy and pass it on; decorators
+		*	pass it through; leaves ignore it. Tree pushes its policy down the
+		*	whole graph while baking, so set it before building a Tree only if
+		*	the graph is updated directly. @see ERROR_POLICY
+		*	@param errorPolicy Policy to apply to this node's subtree.
+		*/
+		virtual void setErrorPolicy(const ERROR_POLICY errorPolicy) { return; };
+
+		/**
+		*	@name onEvent
+		*	@brief Receive a CUSTOM event posted to this node's index.
+		*
+		*	@details Called while the posting instance's queue is drained at
+		*	the start of Tree::update, on the ticking thread. Override on leaf
+		*	nodes that wait on external systems, for example to satisfy a
+		*	condition. The base does nothing. @see Event @see TreeInstance::postEvent
+		*	@param data User payload of the event.
+		*/
+		virtual void onEvent(const int data) { return; };
+
+		/**
+		*	@name clone
+		*	@brief Deep-copy this node and its subtree with runtime state zeroed.
+		*
+		*	@details Composites copy their children, decorators copy their
+		*	parameters (repeat count, duration, limit) but not counters or
+		*	clocks, so the copy behaves like a freshly built graph. Copies
+		*	allocate through Node::operator new; clone with a NodePool bound
+		*	to stamp a whole archetype in to the arena. @see ArchetypeRegistry
+		*	The base returns nullptr: leaf types must override clone to take
+		*	part, and a subtree holding a leaf that doesn't is not clonable.
+		*	@return The copy. nullptr if the subtree can't be cloned.
+		*/
+		virtual std::unique_ptr<Node> clone() { return nullptr; };
+	};
+
+	/**
+	*	@class Blackboard
+	*	@brief Shared data store for the nodes of one agent or squad.
+	*
+	*	@details Without a shared store, every condition leaf calls back in to
+	*	game systems and recomputes values a sibling just computed. The
+	*	blackboard holds such values once per tick: keys are interned to dense
+	*	int IDs at startup (@see internKey), so a lookup is one vector index,
+	*	no hashing and no string compare on the hot path. Each entry carries
+	*	a type tag and a version counter that every write bumps; readers that
+	*	remember the version they saw can skip whole re-evaluations when
+	*	nothing changed. @see BlackboardCondition
+	*	@note Not thread safe. Share a blackboard only between trees that
+	*	tick on the same thread.
+	*/
+	class Blackboard
+	{
+	public:
+		/**
+		*	@enum ENTRY_TYPE
+		*	@brief Type tag of one blackboard entry.
+		*/
+		enum class ENTRY_TYPE
+		{
+			EMPTY = 0,
+			BOOL,
+			INT,
+			FLOAT,
+			POINTER
+		};
+	private:
+		/**
+		*	@struct Entry
+		*	@brief One typed slot with its version counter.
+		*/
+		struct Entry
+		{
+			//Type tag. EMPTY until the first write.
+			ENTRY_TYPE type;
+
+			//Bumped on every write. 0 means never written.
+			int version;
+
+			//The value. Only the field matching the type tag is meaningful.
+			bool boolValue;
+			int intValue;
+			float floatValue;
+			void* pointerValue;
+
+			Entry();
+		};
+
+		//Entries indexed by interned key ID. Grows on first write of a key.
+		std::vector<Entry> entries;
+
+		/**
+		*	@name entryAt
+		*	@brief Get the entry of a key for writing, growing the storage.
+		*
+		*	@param keyId Interned key ID.
+		*	@return The entry.
+		*/
+		Entry& entryAt(const int keyId);
+
+		/**
+		*	@name findEntry
+		*	@brief Get the entry of a key for reading.
+		*
+		*	@param keyId Interned key ID.
+		*	@return The entry. nullptr if the key was never written here.
+		*/
+		const Entry* findEntry(const int keyId) const;
+
+		//One set of read key IDs per active recording, innermost last. The
+		//get calls note a key in every level, each level without duplicates,
+		//so an enclosing recording sees its nested recordings' reads too.
+		mutable std::vector<std::vector<int>> recordingStack;
+	public:
+		//Default constructor. Starts with no entries.
+		Blackboard();
+
+		//Disable copy constructor
+		Blackboard(Blackboard const&) = delete;
+
+		//Disable assign operator
+		void operator=(Blackboard const&) = delete;
+
+		//Default destructor
+		~Blackboard() = default;
+
+		/**
+		*	@name internKey
+		*	@brief Turn a key name in to its process wide dense int ID.
+		*
+		*	@details The same name always returns the same ID. Intern keys
+		*	once at startup and pass the IDs around; interning itself hashes
+		*	the string and is not meant for the per-tick path.
+		*	@param name Key name.
+		*	@return Interned ID of the key.
+		*/
+		static const int internKey(const char* name);
+
+		/**
+		*	@name setBool
+		*	@brief Write a bool entry. Bumps the entry's version.
+		*
+		*	@param keyId Interned key ID.
+		*	@param value Value to write.
+		*/
+		void setBool(const int keyId, const bool value);
+
+		/**
+		*	@name setInt
+		*	@brief Write an int entry. Bumps the entry's version.
+		*
+		*	@param keyId Interned key ID.
+		*	@param value Value to write.
+		*/
+		void setInt(const int keyId, const int value);
+
+		/**
+		*	@name setFloat
+		*	@brief Write a float entry. Bumps the entry's version.
+		*
+		*	@param keyId Interned key ID.
+		*	@param value Value to write.
+		*/
+		void setFloat(const int keyId, const float value);
+
+		/**
+		*	@name setPointer
+		*	@brief Write a pointer entry. Bumps the entry's version.
+		*	@note The blackboard doesn't own what the pointer points at.
+		*
+		*	@param keyId Interned key ID.
+		*	@param value Value to write.
+		*/
+		void setPointer(const int keyId, void* value);
+
+		/**
+		*	@name getBool
+		*	@brief Read a bool entry.
+		*
+		*	@param keyId Interned key ID.
+		*	@param defaultValue Returned if the entry is missing or another type.
+		*	@return The value.
+		*/
+		const bool getBool(const int keyId, const bool defaultValue = false) const;
+
+		/**
+		*	@name getInt
+		*	@brief Read an int entry.
+		*
+		*	@param keyId Interned key ID.
+		*	@param defaultValue Returned if the entry is missing or another type.
+		*	@return The value.
+		*/
+		const int getInt(const int keyId, const int defaultValue = 0) const;
+
+		/**
+		*	@name getFloat
+		*	@brief Read a float entry.
+		*
+		*	@param keyId Interned key ID.
+		*	@param defaultValue Returned if the entry is missing or another type.
+		*	@return The value.
+		*/
+		const float getFloat(const int keyId, const float defaultValue = 0.0f) const;
+
+		/**
+		*	@name getPointer
+		*	@brief Read a pointer entry.
+		*
+		*	@param keyId Interned key ID.
+		*	@param defaultValue Returned if the entry is missing or another type.
+		*	@return The value.
+		*/
+		void* getPointer(const int keyId, void* defaultValue = nullptr) const;
+
+		/**
+		*	@name getType
+		*	@brief Get the type tag of an entry.
+		*
+		*	@param keyId Interned key ID.
+		*	@return Type of the entry. EMPTY if it was never written here.
+		*/
+		const ENTRY_TYPE getType(const int keyId) const;
+
+		/**
+		*	@name getVersion
+		*	@brief Get the version counter of an entry.
+		*
+		*	@param keyId Interned key ID.
+		*	@return Times the entry was written. 0 if never.
+		*/
+		const int getVersion(const int keyId) const;
+
+		/**
+		*	@name startReadRecording
+		*	@brief Start noting which keys the get calls touch.
+		*
+		*	@details Lets a caller learn the inputs of a subtree without the
+		*	subtree declaring them: record around one evaluation, then watch
+		*	the versions of the keys that came back. @see Memoize
+		*	@note Recordings nest. A read lands in every recording that is
+		*	active, so an enclosing recording also sees the keys a nested one
+		*	collected for itself.
+		*/
+		void startReadRecording();
+
+		/**
+		*	@name stopReadRecording
+		*	@brief Stop the innermost recording and get the keys it saw.
+		*
+		*	@return Key IDs read since that recording started, without
+		*	duplicates. Empty if no recording was active.
+		*/
+		const std::vector<int> stopReadRecording();
+
+		/**
+		*	@name recordRead
+		*	@brief Note a key as read in every active recording.
+		*
+		*	@details The get calls record on their own; call this for reads
+		*	that never happen, like a Memoize answering from its cache while
+		*	an enclosing one is recording - the enclosing result still depends
+		*	on the skipped subtree's keys. Does nothing while no recording is
+		*	active.
+		*	@param keyId Interned key ID.
+		*/
+		void recordRead(const int keyId) const;
+	};
+
+	/**
+	*	@class Condition
+	*	@brief A condition leaf with a cached result and a dirty flag.
+	*
+	*	@details Inherit and implement evaluate. The condition only re-evaluates
+	*	when it's dirty; otherwise update returns the cached result without
+	*	calling evaluate. Gameplay systems call markDirty when the underlying
+	*	value changed, so trees can tick at a low rate and still react to
+	*	condition flips. A reactive Selector watches its branches' dirty
+	*	conditions to abort a lower priority running branch. @see Selector::setReactive
+	*/
+	class Condition : public Node
+	{
+	private:
+		//True if the condition must re-evaluate on next update.
+		bool dirty;
+
+		//Cached evaluation result.
+		bool lastResult;
+	protected:
+		//Default constructor. Starts dirty so first update evaluates.
+		Condition();
+
+		/**
+		*	@name evaluate
+		*	@brief Evaluate the condition.
+		*	@note Pure virtual function. Only called when the condition is dirty.
+		*
+		*	@return True if the condition holds.
+		*/
+		virtual const bool evaluate() = 0;
+	public:
+		//Disable copy constructor
+		Condition(Condition const&) = delete;
+
+		//Disable assign operator
+		void operator=(Condition const&) = delete;
+
+		//Default destructor
+		virtual ~Condition() = default;
+
+		// @copydoc Node::update(const float delta = 0)
+		virtual const NODE_STATE update(const float delta = 0) override;
+
+		/**
+		*	@name markDirty
+		*	@brief Flag the condition for re-evaluation on next update.
+		*/
+		void markDirty();
+
+		/**
+		*	@name isDirty
+		*	@brief Check if the condition will re-evaluate on next update.
+		*	@note Virtual so conditions with an own change source (@see
+		*	BlackboardCondition) can fold it in for the reactive Selector.
+		*
+		*	@return True if the condition is dirty.
+		*/
+		virtual const bool isDirty();
+
+		/**
+		*	@name getLastResult
+		*	@brief Get cached evaluation result without re-evaluating.
+		*
+		*	@return Last evaluation result. False if never evaluated.
+		*/
+		const bool getLastResult();
+
+		// @copydoc Node::reset()
+		virtual void reset() override;
+	};
+
+	/**
+	*	@class BatchCondition
+	*	@brief Evaluates a block of numeric threshold conditions in one leaf.
+	*
+	*	@details Guard chains like 'health < X, distance < Y, ammo > Z' are
+	*	usually one Node subclass per comparison, each reached through its own
+	*	virtual call. BatchCondition holds the whole chain as flat arrays
+	*	(values, thresholds, comparators side by side) and evaluates every
+	*	comparison per update in one pass, with SIMD where the build has SSE2
+	*	and a scalar loop elsewhere. update returns SUCCESS if any comparison
+	*	holds, so the node drops in where a Selector over condition leaves
+	*	was; getFirstPassingIndex tells which comparison it was, and
+	*	getConditionResult reads any individual outcome.
+	*	@note Value pointers must stay valid while the node is used. Values
+	*	are re-read every update; there is no dirty flag on this node.
+	*/
+	class BatchCondition : public Node
+	{
+	public:
+		/**
+		*	@enum COMPARATOR
+		*	@brief How a value is compared against its threshold.
+		*/
+		enum class COMPARATOR
+		{
+			LESS = 0,
+			LESS_EQUAL,
+			GREATER,
+			GREATER_EQUAL,
+			EQUAL,
+			NOT_EQUAL
+		};
+	private:
+		//Where each value is read from, one per condition.
+		std::vector<const float*> valuePointers;
+
+		//Values gathered from the pointers this update. Padded to SIMD width.
+		std::vector<float> gatheredValues;
+
+		//Threshold per condition. Padded to SIMD width.
+		std::vector<float> thresholds;
+
+		//Comparator select masks, one stream per comparator, all ones for
+		//lanes using that comparator and zero elsewhere. Three vector
+		//compares (<, <=, ==) and their complements cover all six
+		//comparators, blended by these masks. Padded lanes are zero in
+		//every stream, so they can never pass.
+		std::vector<unsigned int> lessMasks;
+		std::vector<unsigned int> lessEqualMasks;
+		std::vector<unsigned int> greaterMasks;
+		std::vector<unsigned int> greaterEqualMasks;
+		std::vector<unsigned int> equalMasks;
+		std::vector<unsigned int> notEqualMasks;
+
+		//Outcome of each condition from the last update.
+		std::vector<unsigned char> results;
+
+		//Number of conditions added.
+		int conditionCount;
+
+		//Index of the first passing condition from the last update. -1 if none.
+		int firstPassingIndex;
+	public:
+		//Default constructor. Starts empty; update returns ERROR until a
+		//condition is added.
+		BatchCondition();
+
+		//Disable copy constructor
+		BatchCondition(BatchCondition const&) = delete;
+
+		//Disable assign operator
+		void operator=(BatchCondition const&) = delete;
+
+		//Default destructor
+		virtual ~BatchCondition() = default;
+
+		/**
+		*	@name addCondition
+		*	@brief Append one comparison to the block.
+		*
+		*	@param value Where to read the value each update. Must outlive the node.
+		*	@param comparator How to compare the value against the threshold.
+		*	@param threshold Threshold to compare against.
+		*/
+		void addCondition(const float* value, const COMPARATOR comparator, const float threshold);
+
+		/**
+		*	@name update
+		*	@brief Re-read every value and evaluate all comparisons at once.
+		*
+		*	@param const float delta = 0 An elapsed time for current frame.
+		*	@return SUCCESS if any comparison holds, FAILURE if none does,
+		*	ERROR if the block is empty.
+		*/
+		virtual const NODE_STATE update(const float delta = 0) override;
+
+		/**
+		*	@name getConditionCount
+		*	@brief Get number of comparisons in the block.
+		*
+		*	@return Number of conditions added.
+		*/
+		const int getConditionCount();
+
+		/**
+		*	@name getFirstPassingIndex
+		*	@brief Get which comparison passed first on the last update.
+		*
+		*	@details Conditions keep the order they were added in, so this is
+		*	what a Selector over separate condition leaves would have picked.
+		*	@return Index of the first passing condition. -1 if none passed
+		*	or the node was never updated.
+		*/
+		const int getFirstPassingIndex();
+
+		/**
+		*	@name getConditionResult
+		*	@brief Get one comparison's outcome from the last update.
+		*
+		*	@param index Index of the condition, in the order they were added.
+		*	@return True if that comparison held. False if it didn't or index is bad.
+		*/
+		const bool getConditionResult(const int index);
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
+	};
+
+	/**
+	*	@class BlackboardCondition
+	*	@brief A condition that compares one blackboard entry to a threshold.
+	*
+	*	@details Reads the entry through the blackboard's version counter: if
+	*	the version is the one seen at the last evaluation, update returns the
+	*	cached result without touching the value at all. A write to the entry
+	*	makes the condition dirty, which the reactive Selector observes for
+	*	its aborts (@see Selector::setReactive), so writing the blackboard is
+	*	all a game system does to both wake higher priority branches and
+	*	re-evaluate guards. BOOL entries compare as 1 or 0, INT entries as
+	*	float; EMPTY and POINTER entries never pass.
+	*/
+	class BlackboardCondition : public Condition
+	{
+	private:
+		//Blackboard the entry lives in. Not owned.
+		Blackboard* blackboard;
+
+		//Interned key ID of the observed entry.
+		int keyId;
+
+		//How the entry is compared against the threshold.
+		BatchCondition::COMPARATOR comparator;
+
+		//Threshold to compare against.
+		float threshold;
+
+		//Entry version at the last evaluation. -1 before the first one.
+		int seenVersion;
+	protected:
+		// @copydoc Condition::evaluate()
+		virtual const bool evaluate() override;
+	public:
+		/**
+		*	@name BlackboardCondition
+		*	@brief Constructor.
+		*
+		*	@param blackboard Blackboard to read. Must outlive the node.
+		*	@param keyId Interned key ID of the entry to observe.
+		*	@param comparator How to compare the entry against the threshold.
+		*	@param threshold Threshold to compare against.
+		*/
+		BlackboardCondition(Blackboard* blackboard, const int keyId, const BatchCondition::COMPARATOR comparator, const float threshold);
+
+		//Disable copy constructor
+		BlackboardCondition(BlackboardCondition const&) = delete;
+
+		//Disable assign operator
+		void operator=(BlackboardCondition const&) = delete;
+
+		//Default destructor
+		virtual ~BlackboardCondition() = default;
+
+		// @copydoc Node::update(const float delta = 0)
+		virtual const NODE_STATE update(const float delta = 0) override;
+
+		// @copydoc Condition::isDirty()
+		virtual const bool isDirty() override;
+
+		/**
+		*	@name clone
+		*	@brief Copy the condition. The copy reads the same blackboard.
+		*
+		*	@return The copy. Starts unevaluated.
+		*/
+		virtual std::unique_ptr<Node> clone() override;
 	};
 
 	/**
@@ -150,15 +726,56 @@ namespace BehaviorTree
 		//Maximum number of children that this node can take. -1 if it's infinite. Can not be 0.
 		int maxChildrenSize;
 
+		//How ERROR from children is handled. Fixed per tree at bake. @see ERROR_POLICY
+		ERROR_POLICY errorPolicy;
+
 		//child node that is running. nullptr if none running.
 		int runningChildIndex;
 
 		// Check if running child index is valid.
 		const bool isRunningChildIndexValid();
 
-		//Holds the children. 
+		//Holds the children.
 		std::vector<std::unique_ptr<Node>> children;
 
+		//Update order indirection. Children are visited through this index
+		//array when it's not empty, so random composites shuffle indices
+		//instead of moving the owning unique_ptrs. Empty means natural order.
+		std::vector<int> updateOrder;
+
+		/**
+		*	@name childAt
+		*	@brief Get child for given update slot, mapped through updateOrder.
+		*
+		*	@param i Update slot in [0, children size).
+		*	@return Child node. Can be nullptr.
+		*/
+		Node* childAt(const int i);
+
+		/**
+		*	@name shuffleUpdateOrder
+		*	@brief Shuffle the update order index array with a fast PRNG.
+		*	@note Reuses the permutation buffer across ticks. Only resizes when
+		*	children were added or removed. unique_ptrs never move.
+		*
+		*	@param rngState Per-node PRNG state. Must not be 0.
+		*/
+		void shuffleUpdateOrder(unsigned int& rngState);
+
+		/**
+		*	@name primeUpdateOrder
+		*	@brief Build the identity permutation at the current children size.
+		*
+		*	@details Composites that shuffle call this at construction, so the
+		*	permutation buffer is already sized before the first update. Once
+		*	the buffer exists, addChild keeps it sized, and ticking never has
+		*	to grow it. @see AllocationAudit
+		*/
+		void primeUpdateOrder();
+
+		//Tree bakes composite children in to flat array. @see Tree
+		friend class Tree;
+
 		/**
 		*	@name updateRunningChild
 		*	@brief Update running child if there is one.
@@ -167,6 +784,16 @@ namespace BehaviorTree
 		const BehaviorTree::NODE_STATE updateRunningChild(const float delta, int& nextIndex);
 
 		const BehaviorTree::NODE_STATE updateChildren(const int start, const float delta, const BehaviorTree::NODE_STATE continueCondition);
+
+		/**
+		*	@name cloneChildrenInto
+		*	@brief Copy this composite's children and settings in to a fresh
+		*	copy of the same type. Shared by the composite clone overrides.
+		*
+		*	@param copy Freshly constructed composite to fill.
+		*	@return True on success. False if any child isn't clonable.
+		*/
+		const bool cloneChildrenInto(CompositeNode& copy);
 	public:
 		//Default destructor.
 		virtual ~CompositeNode();
@@ -211,9 +838,40 @@ namespace BehaviorTree
 		*
 		*	@param maxChildren Number of children that this node can take. Infinit if it's -1.
 		*	@param cleanUpRemains Deletes remaing children instances if exists. Else, just removes it from children vector.
-		*	@return True if successfully sets maximum child size. 
+		*	@return True if successfully sets maximum child size.
 		*/
 		const bool setMaxChildrenSize(const int maxChildrenSize, const bool cleanUpRemains);
+
+		/**
+		*	@name getUpdateOrder
+		*	@brief Get the update order index array.
+		*
+		*	@return Index array that children are visited through. Empty if
+		*	children are visited in natural order.
+		*/
+		const std::vector<int>& getUpdateOrder();
+
+		/**
+		*	@name setErrorPolicy
+		*	@brief Store the policy and push it down to every child.
+		*
+		*	@param errorPolicy Policy to apply to this node's subtree.
+		*/
+		virtual void setErrorPolicy(const ERROR_POLICY errorPolicy) override;
+
+		/**
+		*	@name reset
+		*	@brief Clear the running child slot and reset every child.
+		*/
+		virtual void reset() override;
+
+		/**
+		*	@name getErrorPolicy
+		*	@brief Get how this composite handles ERROR from children.
+		*
+		*	@return This composite's error policy. IGNORE by default.
+		*/
+		const ERROR_POLICY getErrorPolicy();
 	};
 
 	/**
@@ -224,6 +882,23 @@ namespace BehaviorTree
 	*/
 	class Selector : public CompositeNode
 	{
+	private:
+		//True if this selector aborts a running lower priority branch when a
+		//higher priority branch's observed condition flips to viable.
+		bool reactive;
+
+		/**
+		*	@name getBranchGuard
+		*	@brief Get the observed condition guarding a branch.
+		*
+		*	@details A branch is guarded if the child itself is a Condition, or
+		*	if the child is a Sequence whose first child is a Condition. Other
+		*	shapes are not observed.
+		*
+		*	@param i Update slot of the branch.
+		*	@return The guarding condition, or nullptr if the branch isn't observed.
+		*/
+		Condition* getBranchGuard(const int i);
 	public:
 		/**
 		*	@name Selector
@@ -252,7 +927,53 @@ namespace BehaviorTree
 
 		// @copydoc Node::update(const float delta = 0)
 		virtual const NODE_STATE update(const float delta = 0) override;
-	};
+
+		/**
+		*	@name setReactive
+		*	@brief Turn observer aborts on or off. Off by default.
+		*
+		*	@details While a lower priority branch is RUNNING, a reactive
+		*	selector checks higher priority branches whose guarding Condition
+		*	was marked dirty. If one re-evaluates to true, the running branch
+		*	is reset and the selector re-enters at that branch. Branches whose
+		*	conditions didn't flip are not re-evaluated.
+		*
+		*	@param reactive True to abort running branches on condition flips.
+		*/
+		void setReactive(const bool reactive);
+
+		/**
+		*	@name isReactive
+		*	@brief Check if observer aborts are on.
+		*
+		*	@return True if this selector is reactive.
+		*/
+		const bool isReactive();
+
+		/**
+		*	@name preempt
+		*	@brief Abort the running branch in favor of a higher priority one.
+		*
+		*	@details Child order is the priority lane: slot 0 is the highest.
+		*	When a branch of lower priority than the given slot is running,
+		*	only that branch's subtree is reset and the next update enters
+		*	directly at the given slot - branches of higher priority are not
+		*	re-evaluated, and nothing outside the abandoned path is touched.
+		*	This is the imperative version of the reactive selector's
+		*	condition-driven aborts, for gameplay systems that decide the
+		*	preemption themselves. @see setReactive
+		*	@note For a baked tree, preempt through Tree instead. @see Tree::preempt
+		*
+		*	@param childIndex Slot of the preempting branch.
+		*	@return True if a running lower priority branch was preempted.
+		*	False if the slot is out of range, nothing is running, or the
+		*	running branch already has equal or higher priority.
+		*/
+		const bool preempt(const int childIndex);
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
+	};
 
 	/**
 	*	@class RandomSelector
@@ -264,6 +985,9 @@ namespace BehaviorTree
 	{
 	private:
 		bool needShuffle;
+
+		//Per-node PRNG state. Seeded once at construction.
+		unsigned int rngState;
 	public:
 		/**
 		*	@name RandomSelector
@@ -286,6 +1010,9 @@ namespace BehaviorTree
 
 		// @copydoc Node::update(const float delta = 0)
 		virtual const NODE_STATE update(const float delta = 0) override;
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
 	};
 
 	/**
@@ -316,6 +1043,9 @@ namespace BehaviorTree
 
 		// @copydoc Node::update(const float delta = 0)
 		virtual const NODE_STATE update(const float delta = 0) override;
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
 	};
 
 	/**
@@ -328,6 +1058,9 @@ namespace BehaviorTree
 	{
 	private:
 		bool needShuffle;
+
+		//Per-node PRNG state. Seeded once at construction.
+		unsigned int rngState;
 	public:
 		/**
 		*	@name RandomSequence
@@ -350,6 +1083,126 @@ namespace BehaviorTree
 
 		// @copydoc Node::update(const float delta = 0)
 		virtual const NODE_STATE update(const float delta = 0) override;
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
+	};
+
+	/**
+	*	@class Parallel
+	*	@brief Executes every child each update and combines results by vote.
+	*
+	*	@details Concurrent behaviors (move while aiming) don't fit Selector
+	*	or Sequence; faking them with interleaved sequences doubles tree
+	*	depth. Parallel updates all of its children every update and finishes
+	*	when a vote policy is met: with REQUIRE_ONE one child's result
+	*	decides, with REQUIRE_ALL every child must agree. The success policy
+	*	is checked before the failure policy. Children that finished early
+	*	keep their result and are not updated again until the parallel itself
+	*	finishes; children still RUNNING when it finishes are reset.
+	*	With setConcurrent, still running children are dispatched each as a
+	*	task on an own thread and joined before update returns, for the case
+	*	where children are heavyweight subtrees. @see setConcurrent
+	*	@note Parallel stays LEAF when baked; its subtree runs through the
+	*	virtual update, like a reactive Selector's. Per-child progress lives
+	*	in the node, so don't share one Parallel between instances that tick
+	*	simultaneously.
+	*/
+	class Parallel : public CompositeNode
+	{
+	public:
+		/**
+		*	@enum POLICY
+		*	@brief How many children must agree for a result to win.
+		*/
+		enum class POLICY
+		{
+			//One child with the result finishes the parallel.
+			REQUIRE_ONE = 0,
+
+			//Every child must have the result.
+			REQUIRE_ALL
+		};
+	private:
+		//How many children must succeed for SUCCESS.
+		POLICY successPolicy;
+
+		//How many children must fail for FAILURE.
+		POLICY failurePolicy;
+
+		//True if still running children are updated on own threads.
+		bool concurrent;
+
+		//Result of each child for the current run. Sized on update.
+		std::vector<NODE_STATE> childStates;
+
+		/**
+		*	@name finish
+		*	@brief Reset still running children and start a fresh run.
+		*/
+		void finish();
+	public:
+		/**
+		*	@name Parallel
+		*	@brief Parallel constructor with single child node. Node is ignored if it's a nullptr.
+		*
+		*	@param child A child node to initialize with.
+		*	@param successPolicy Children that must succeed. All by default.
+		*	@param failurePolicy Children that must fail. One by default.
+		*/
+		Parallel(std::unique_ptr<Node> child, const POLICY successPolicy = POLICY::REQUIRE_ALL, const POLICY failurePolicy = POLICY::REQUIRE_ONE);
+
+		/**
+		*	@name Parallel
+		*	@brief Parallel constructor with multiple child node. Node is ignored if it's a nullptr.
+		*
+		*	@param children Children nodes to initialize with.
+		*	@param successPolicy Children that must succeed. All by default.
+		*	@param failurePolicy Children that must fail. One by default.
+		*/
+		Parallel(std::vector<std::unique_ptr<Node>>& children, const POLICY successPolicy = POLICY::REQUIRE_ALL, const POLICY failurePolicy = POLICY::REQUIRE_ONE);
+
+		//Default destructor
+		~Parallel();
+
+		// @copydoc Node::update(const float delta = 0)
+		virtual const NODE_STATE update(const float delta = 0) override;
+
+		/**
+		*	@name setConcurrent
+		*	@brief Dispatch still running children as tasks on own threads.
+		*	@note Off by default. Thread spawn costs more than most subtrees;
+		*	turn it on only when children are genuinely heavyweight. Children
+		*	updated concurrently must not touch shared state unguarded. The
+		*	Scheduler's workers are frame scoped, so the parallel brings its
+		*	own threads instead of joining in to a pool mid frame.
+		*
+		*	@param concurrent True to update running children concurrently.
+		*/
+		void setConcurrent(const bool concurrent);
+
+		/**
+		*	@name isConcurrent
+		*	@brief Check if children are updated concurrently.
+		*
+		*	@return True if concurrent dispatch is on.
+		*/
+		const bool isConcurrent();
+
+		/**
+		*	@name getChildState
+		*	@brief Get one child's result from the current run.
+		*
+		*	@param i Update slot of the child.
+		*	@return The child's result. RUNNING if not finished or index is bad.
+		*/
+		const NODE_STATE getChildState(const int i);
+
+		// @copydoc CompositeNode::reset()
+		virtual void reset() override;
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
 	};
 
 	/**
@@ -370,6 +1223,19 @@ namespace BehaviorTree
 
 		//A node that is wrapped
 		std::unique_ptr<Node> child;
+
+		/**
+		*	@name cloneChild
+		*	@brief Copy the wrapped child for a clone override.
+		*
+		*	@param copy Filled with the child's copy. Stays nullptr if there
+		*	is no child to copy.
+		*	@return True on success. False if the child isn't clonable.
+		*/
+		const bool cloneChild(std::unique_ptr<Node>& copy);
+
+		//Tree bakes decorator child in to flat array. @see Tree
+		friend class Tree;
 	public:
 		//Disable copy constructor
 		DecoratorNode(DecoratorNode const&) = delete;
@@ -387,6 +1253,20 @@ namespace BehaviorTree
 		*	@param child A node to wrap. Ignored if there is an existing child.
 		*/
 		void addChild(std::unique_ptr<Node> child, const bool overwrite = true);
+
+		/**
+		*	@name setErrorPolicy
+		*	@brief Pass the policy through to the wrapped child.
+		*
+		*	@param errorPolicy Policy to apply to this node's subtree.
+		*/
+		virtual void setErrorPolicy(const ERROR_POLICY errorPolicy) override;
+
+		/**
+		*	@name reset
+		*	@brief Reset the wrapped child.
+		*/
+		virtual void reset() override;
 	};
 
 	/**
@@ -421,6 +1301,9 @@ namespace BehaviorTree
 
 		// @copydoc Node::update(const float delta = 0)
 		virtual const NODE_STATE update(const float delta = 0) override;
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
 	};
 
 	/**
@@ -457,6 +1340,9 @@ namespace BehaviorTree
 
 		// @copydoc Node::update(const float delta = 0)
 		virtual const NODE_STATE update(const float delta = 0) override;
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
 	};
 
 	/**
@@ -491,6 +1377,9 @@ namespace BehaviorTree
 
 		// @copydoc Node::update(const float delta = 0)
 		virtual const NODE_STATE update(const float delta = 0) override;
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
 	};
 
 	/**
@@ -524,9 +1413,12 @@ namespace BehaviorTree
 		// Virtual destructor
 		virtual ~Repeat() = default;
 
-		//amount of number to repeat. 
+		//amount of number to repeat.
 		int repeat;
 
+		//Tree bakes repeat amount in to flat array. @see Tree
+		friend class Tree;
+
 		// set repeat. Beaware that large amount of repeat might slow down your application.
 		void setRepeat(const int repeat);
 
@@ -568,6 +1460,9 @@ namespace BehaviorTree
 
 		// @copydoc Node::update(const float delta = 0)
 		virtual const NODE_STATE update(const float delta = 0) override;
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
 	};
 
 	/**
@@ -581,6 +1476,9 @@ namespace BehaviorTree
 		// status that repeat until wants
 		NODE_STATE desiredStatus;
 
+		//Tree bakes desired status in to flat array. @see Tree
+		friend class Tree;
+
 		/**
 		*	@name RepeatUntil
 		*/
@@ -637,6 +1535,9 @@ namespace BehaviorTree
 
 		// Default destructor
 		~RepeatUntilFail() = default;
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
 	};
 
 	/**
@@ -669,6 +1570,9 @@ namespace BehaviorTree
 
 		// Default destructor
 		~RepeatUntilSuccess() = default;
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
 	};
 
 	/**
@@ -680,6 +1584,9 @@ namespace BehaviorTree
 	private:
 		int limit;
 		int limitCount;
+
+		//Tree bakes limit in to flat array. @see Tree
+		friend class Tree;
 	public:
 		/**
 		*	@name Limiter
@@ -707,6 +1614,15 @@ namespace BehaviorTree
 
 		// @copydoc Node::update(const float delta = 0)
 		virtual const NODE_STATE update(const float delta = 0) override;
+
+		/**
+		*	@name reset
+		*	@brief Clear the execution counter and reset the child.
+		*/
+		virtual void reset() override;
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
 	};
 
 	/**
@@ -722,6 +1638,9 @@ namespace BehaviorTree
 		bool delayOnce;
 		bool childUpdateFinished;
 		BehaviorTree::NODE_STATE result;
+
+		//Tree bakes duration and delayOnce in to flat array. @see Tree
+		friend class Tree;
 	public:
 		/**
 		*	@name DelayTime
@@ -749,6 +1668,15 @@ namespace BehaviorTree
 
 		// @copydoc Node::update(const float delta = 0)
 		virtual const NODE_STATE update(const float delta = 0) override;
+
+		/**
+		*	@name reset
+		*	@brief Clear the delay clock and reset the child.
+		*/
+		virtual void reset() override;
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
 	};
 
 	/**
@@ -761,6 +1689,9 @@ namespace BehaviorTree
 		float duration;
 		float elapsedTime;
 		bool failed;
+
+		//Tree bakes duration in to flat array. @see Tree
+		friend class Tree;
 	public:
 		/**
 		*	@name TimeLimit
@@ -789,7 +1720,1857 @@ namespace BehaviorTree
 
 		// @copydoc Node::update(const float delta = 0)
 		virtual const NODE_STATE update(const float delta = 0) override;
+
+		/**
+		*	@name reset
+		*	@brief Clear the elapsed time and reset the child.
+		*/
+		virtual void reset() override;
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
 	};
-}
+
+	/**
+	*	@class Memoize
+	*	@brief Caches the child's finished state and skips the child while the blackboard entries it read stay unchanged.
+	*
+	*	@details Guard heavy subtrees are often pure functions of blackboard
+	*	values, yet a plain tick re-executes them every frame for the same
+	*	answer. This decorator records which entries the child read during
+	*	evaluation (@see Blackboard::startReadRecording) together with the
+	*	versions it saw, and returns the cached SUCCESS or FAILURE without
+	*	descending until one of those entries is written again. RUNNING is
+	*	never cached; a running child keeps getting ticked.
+	*	@note A child that reads no blackboard entry caches forever. Use
+	*	invalidate (or reset) to force a re-evaluation by hand. Baked trees
+	*	keep this node as a LEAF, so memoization works there unchanged.
+	*	Memoize nodes nest on one blackboard: recordings stack, and a nested
+	*	cache hit reports its own inputs to the enclosing recording, so the
+	*	outer cache watches every key its result really depends on.
+	*/
+	class Memoize : public DecoratorNode
+	{
+	private:
+		/**
+		*	@struct SeenEntry
+		*	@brief One blackboard entry the child read, with the version it saw.
+		*/
+		struct SeenEntry
+		{
+			//Interned key ID.
+			int keyId;
+
+			//Version of the entry when the child read it.
+			int version;
+		};
+
+		//Blackboard the child reads from. Not owned.
+		Blackboard* blackboard;
+
+		//Entries the child read during the cached evaluation.
+		std::vector<SeenEntry> seenEntries;
+
+		//The cached finished state. Valid while hasCache is true.
+		NODE_STATE cachedState;
+
+		//True while cachedState can be returned without ticking the child.
+		bool hasCache;
+
+		/**
+		*	@name isCacheFresh
+		*	@brief Check the recorded versions against the blackboard.
+		*
+		*	@return True if no recorded entry was written since.
+		*/
+		const bool isCacheFresh() const;
+	public:
+		/**
+		*	@name Memoize
+		*	@brief Memoize constructor
+		*	@note nullptr child will return ERROR
+		*	@param blackboard Blackboard the child reads from. Not owned.
+		*/
+		Memoize(Blackboard* blackboard);
+
+		/**
+		*	@name Memoize
+		*	@brief Memoize constructor with child
+		*	@param child A child node to decorate.
+		*	@param blackboard Blackboard the child reads from. Not owned.
+		*/
+		Memoize(std::unique_ptr<Node> child, Blackboard* blackboard);
+
+		//Disable copy constructor
+		Memoize(Memoize const&) = delete;
+
+		//Disable assign operator
+		void operator=(Memoize const&) = delete;
+
+		// Default destructor
+		~Memoize() = default;
+
+		// @copydoc Node::update(const float delta = 0)
+		virtual const NODE_STATE update(const float delta = 0) override;
+
+		/**
+		*	@name invalidate
+		*	@brief Drop the cache so the next update ticks the child again.
+		*/
+		void invalidate();
+
+		/**
+		*	@name reset
+		*	@brief Drop the cache and reset the child.
+		*/
+		virtual void reset() override;
+
+		// @copydoc Node::clone()
+		virtual std::unique_ptr<Node> clone() override;
+	};
+
+	/**
+	*	@enum BehaviorTree::NODE_TYPE
+	*	@brief Type tag for baked nodes. @see Tree
+	*/
+	enum class NODE_TYPE
+	{
+		//A node that Tree doesn't interpret. Updated through virtual call.
+		LEAF = 0,
+		SELECTOR,
+		RANDOM_SELECTOR,
+		SEQUENCE,
+		RANDOM_SEQUENCE,
+		INVERTER,
+		SUCCEEDER,
+		FAILER,
+		REPEATER,
+		REPEAT_UNTIL_FAIL,
+		REPEAT_UNTIL_SUCCESS,
+		LIMITER,
+		DELAY_TIME,
+		TIME_LIMIT
+	};
+
+#if defined(BT_PROFILING)
+	/**
+	*	@class Profiler
+	*	@brief Records what the update path did, per node type.
+	*
+	*	@details Only compiled when BT_PROFILING is defined; without it the
+	*	instrumentation macros expand to plain returns and cost nothing.
+	*	A bound Profiler collects per-node-type invocation counts, counts of
+	*	each returned state, result transition counts and cumulative inclusive
+	*	time, plus a ring buffer of the most recent node updates for digging
+	*	in to a single spiking tick. Every Tree carries its own Profiler and
+	*	binds it while updating, so numbers stay per tree. For a plain node
+	*	graph, bind a Profiler yourself with begin and end.
+	*	@note The binding is one shared slot, like NodePool's. Profile from
+	*	one thread at a time; don't enable BT_PROFILING under the Scheduler.
+	*/
+	class Profiler
+	{
+	public:
+		/**
+		*	@struct Sample
+		*	@brief One recorded node update in the ring buffer.
+		*/
+		struct Sample
+		{
+			//Type of updated node.
+			NODE_TYPE type;
+
+			//State the node returned.
+			NODE_STATE result;
+
+			//Inclusive time of the update in milliseconds.
+			float milliseconds;
+
+#if defined(BT_DEBUG_ALLOC)
+			//Heap allocations made during the update, children included.
+			//Only exists with BT_DEBUG_ALLOC. @see AllocationAudit
+			unsigned long long allocations;
+#endif
+		};
+
+		//Number of samples the ring buffer keeps.
+		static const int SAMPLE_RING_SIZE = 256;
+	private:
+		//Number of NODE_TYPE values. Sizes the per-type counters.
+		static const int TYPE_COUNT = static_cast<int>(NODE_TYPE::TIME_LIMIT) + 1;
+
+		//Number of NODE_STATE values.
+		static const int STATE_COUNT = 4;
+
+		//How many times nodes of each type were updated.
+		unsigned long long invocationCounts[TYPE_COUNT];
+
+		//How many times nodes of each type returned each state.
+		unsigned long long stateCounts[TYPE_COUNT][STATE_COUNT];
+
+		//How many times the returned state differed from the previous
+		//update of the same node type.
+		unsigned long long transitionCounts[TYPE_COUNT];
+
+		//Last state each node type returned. Backs transitionCounts.
+		NODE_STATE lastResults[TYPE_COUNT];
+
+		//Cumulative inclusive update time per node type in seconds.
+		double cumulativeSeconds[TYPE_COUNT];
+
+		//Ring buffer of most recent node updates.
+		Sample samples[SAMPLE_RING_SIZE];
+
+		//Next slot in the ring buffer to overwrite.
+		int sampleCursor;
+
+		//Total number of recorded samples. Can exceed SAMPLE_RING_SIZE.
+		unsigned long long totalSampleCount;
+
+		//Profiler that ProfileScope records in to. nullptr if none bound.
+		static Profiler* activeProfiler;
+
+		//Profiler that was bound when begin ran. end restores it, so a tree
+		//updated inside another tree's update (@see SubtreeRef) doesn't cut
+		//the outer tree's profile short.
+		Profiler* previous;
+	public:
+		//Creates a cleared profiler.
+		Profiler();
+
+		/**
+		*	@name begin
+		*	@brief Bind this profiler. Updates until end record here.
+		*/
+		void begin();
+
+		/**
+		*	@name end
+		*	@brief Unbind the profiler.
+		*/
+		void end();
+
+		/**
+		*	@name record
+		*	@brief Record one node update. Called by ProfileScope.
+		*
+		*	@param type Type of updated node.
+		*	@param result State the node returned.
+		*	@param seconds Inclusive time of the update in seconds.
+		*/
+		void record(const NODE_TYPE type, const NODE_STATE result, const double seconds);
+
+#if defined(BT_DEBUG_ALLOC)
+		/**
+		*	@name annotateLastSampleAllocations
+		*	@brief Attach an allocation count to the newest recorded sample.
+		*	Called by ProfileScope. Only exists with BT_DEBUG_ALLOC.
+		*
+		*	@param allocations Heap allocations the sampled update made.
+		*/
+		void annotateLastSampleAllocations(const unsigned long long allocations);
+#endif
+
+		/**
+		*	@name clear
+		*	@brief Zero every counter and drop all samples.
+		*/
+		void clear();
+
+		/**
+		*	@name getInvocationCount
+		*	@brief Get how many times nodes of the type were updated.
+		*/
+		const unsigned long long getInvocationCount(const NODE_TYPE type);
+
+		/**
+		*	@name getStateCount
+		*	@brief Get how many times nodes of the type returned the state.
+		*/
+		const unsigned long long getStateCount(const NODE_TYPE type, const NODE_STATE state);
+
+		/**
+		*	@name getTransitionCount
+		*	@brief Get how many times the type's returned state changed.
+		*/
+		const unsigned long long getTransitionCount(const NODE_TYPE type);
+
+		/**
+		*	@name getCumulativeSeconds
+		*	@brief Get total inclusive update time of the type in seconds.
+		*	@note Inclusive: a composite's time contains its children's time.
+		*/
+		const double getCumulativeSeconds(const NODE_TYPE type);
+
+		/**
+		*	@name getSampleCount
+		*	@brief Get number of samples held in the ring buffer.
+		*/
+		const int getSampleCount();
+
+		/**
+		*	@name getSample
+		*	@brief Get one held sample, oldest first.
+		*
+		*	@param index 0 to getSampleCount() - 1.
+		*/
+		const Sample& getSample(const int index);
+
+		/**
+		*	@name getActivePofiler
+		*	@brief Get the currently bound profiler.
+		*
+		*	@return Bound profiler. nullptr if none is bound.
+		*/
+		static Profiler* getActiveProfiler();
+	};
+
+	/**
+	*	@class ProfileScope
+	*	@brief Times one node update and records it in the bound Profiler.
+	*	Made by the BT_PROFILE_SCOPE macro; don't use directly.
+	*/
+	class ProfileScope
+	{
+	private:
+		//Type of node being updated.
+		NODE_TYPE type;
+
+		//Bound profiler at construction. nullptr skips the clock entirely.
+		Profiler* profiler;
+
+		//Time the update started.
+		std::chrono::steady_clock::time_point start;
+
+#if defined(BT_DEBUG_ALLOC)
+		//Audit count when the update started, for the per-sample delta.
+		unsigned long long allocStart;
+#endif
+	public:
+		ProfileScope(const NODE_TYPE type);
+
+		/**
+		*	@name finish
+		*	@brief Record the update and pass the state through.
+		*
+		*	@param state State the node is returning.
+		*	@return Same state.
+		*/
+		const NODE_STATE finish(const NODE_STATE state);
+	};
+#endif
+
+#if defined(BT_DEBUG_ALLOC)
+	/**
+	*	@class AllocationAudit
+	*	@brief Counts heap allocations made while a tick is in flight.
+	*
+	*	@details Only compiled when BT_DEBUG_ALLOC is defined. The library
+	*	replaces the global allocation functions in its translation unit and
+	*	bumps a counter for every operator new that lands between begin and
+	*	end. Tree::update brackets its walk with the pair, so after a tick
+	*	the count tells how many heap allocations that tick made. The engine
+	*	walk itself makes none once an instance reached steady state, so
+	*	anything counted comes from a user leaf (or a memoized re-evaluation;
+	*	@see Memoize). Read counts afterwards with
+	*	TreeInstance::getLastTickAllocationCount, or turn on
+	*	setAssertOnAllocation to trap right at the offending allocation in a
+	*	debugger. With BT_PROFILING also defined, every ring buffer Sample
+	*	carries the allocations of its node update, so a spike can be pinned
+	*	to the node that caused it. @see Profiler
+	*	@note Counting is per thread; workers don't see each other's
+	*	allocations. The assert switch is one shared slot, like Profiler's
+	*	binding.
+	*/
+	class AllocationAudit
+	{
+	public:
+		/**
+		*	@name begin
+		*	@brief Start auditing on this thread. Called by Tree::update.
+		*
+		*	@details Nests: an update inside another update (@see SubtreeRef)
+		*	keeps the outer audit running and reports only its own share.
+		*	@return Audit count at the start, for the caller's delta.
+		*/
+		static const unsigned long long begin();
+
+		/**
+		*	@name end
+		*	@brief Stop auditing on this thread. Called by Tree::update.
+		*
+		*	@param startCount Count that begin returned.
+		*	@return Heap allocations counted since that begin.
+		*/
+		static const unsigned long long end(const unsigned long long startCount);
+
+		/**
+		*	@name getCurrentCount
+		*	@brief Get the live audit count of this thread.
+		*/
+		static const unsigned long long getCurrentCount();
+
+		/**
+		*	@name getLastTickCount
+		*	@brief Get allocations counted by the last finished update on
+		*	this thread.
+		*/
+		static const unsigned long long getLastTickCount();
+
+		/**
+		*	@name setAssertOnAllocation
+		*	@brief Make any audited allocation fail an assert instead of
+		*	just counting.
+		*/
+		static void setAssertOnAllocation(const bool enabled);
+
+		/**
+		*	@name getAssertOnAllocation
+		*	@brief Tells if audited allocations assert.
+		*/
+		static const bool getAssertOnAllocation();
+	};
+#endif
+
+	/**
+	*	@class NodePool
+	*	@brief Arena allocator for node construction and teardown.
+	*
+	*	@details Building a tree normally makes one heap allocation per node.
+	*	NodePool hands out node memory from large blocks instead. Bind a pool
+	*	with begin, build trees as usual (every node class allocates through
+	*	Node::operator new), then end. Deleting pooled nodes runs destructors
+	*	but frees nothing; once every tree built from the pool is destroyed,
+	*	recycle hands all blocks back to the pool in one step, ready for the
+	*	next build. Nodes made while no pool is bound use the global heap and
+	*	are freed normally, so pooled and unpooled trees can coexist.
+	*	@note Not thread safe. The bound pool is shared by the whole process,
+	*	so bind, build and recycle from one thread at a time.
+	*/
+	class NodePool
+	{
+	private:
+		//Default size of one block in bytes.
+		static const int DEFAULT_BLOCK_SIZE = 16384;
+
+		/**
+		*	@struct Block
+		*	@brief One chunk of raw memory that nodes are carved from.
+		*/
+		struct Block
+		{
+			//Raw memory.
+			std::unique_ptr<unsigned char[]> memory;
+
+			//Size of memory in bytes.
+			int capacity;
+
+			//Bytes handed out so far.
+			int used;
+		};
+
+		//All blocks. Kept across recycle so memory is reused, not refreed.
+		std::vector<Block> blocks;
+
+		//Size for new blocks in bytes.
+		int blockSize;
+
+		//Pool that Node::operator new allocates from. nullptr if none bound.
+		static NodePool* activePool;
+
+		/**
+		*	@name allocate
+		*	@brief Carve size bytes out of the current block.
+		*
+		*	@param size Number of bytes. Rounded up to keep alignment.
+		*	@return Pointer to memory inside a block.
+		*/
+		void* allocate(const std::size_t size);
+
+		//Node::operator new calls allocate on the active pool.
+		friend class Node;
+	public:
+		/**
+		*	@name NodePool
+		*	@brief Creates an empty pool. Blocks are made on first allocation.
+		*
+		*	@param blockSize Size of one block in bytes.
+		*/
+		NodePool(const int blockSize = DEFAULT_BLOCK_SIZE);
+
+		//Disable copy constructor
+		NodePool(NodePool const&) = delete;
+
+		//Disable assign operator
+		void operator=(NodePool const&) = delete;
+
+		//Unbinds itself if still bound, then frees all blocks.
+		~NodePool();
+
+		/**
+		*	@name begin
+		*	@brief Bind this pool. Nodes made until end come from here.
+		*/
+		void begin();
+
+		/**
+		*	@name end
+		*	@brief Unbind the pool. Nodes go back to the global heap.
+		*/
+		void end();
+
+		/**
+		*	@name recycle
+		*	@brief Mark every block as empty so its memory is handed out again.
+		*	@note Every node allocated from this pool must be destroyed first;
+		*	recycling while pooled nodes are alive leaves them on reused memory.
+		*/
+		void recycle();
+
+		/**
+		*	@name getBlockCount
+		*	@brief Get number of blocks this pool holds.
+		*
+		*	@return Number of blocks.
+		*/
+		const int getBlockCount();
+
+		/**
+		*	@name getActivePool
+		*	@brief Get the currently bound pool.
+		*
+		*	@return Bound pool. nullptr if none is bound.
+		*/
+		static NodePool* getActivePool();
+	};
+
+	/**
+	*	@class TickBudget
+	*	@brief Caps how much work one Tree::update may do.
+	*
+	*	@details Designer-authored repeat loops (RepeatUntil with
+	*	REPEAT_INFINITE in particular) can spin unboundedly inside one tick.
+	*	Passing a TickBudget to Tree::update makes the engine yield once the
+	*	cap is hit: it records its position through the normal running-child
+	*	bookkeeping, returns RUNNING, and the next update resumes where it
+	*	left off. The frame budget stays safe without a thread per agent.
+	*	Caps can be a node visit count, a time slice in microseconds, or
+	*	both; whichever is hit first yields. @see Tree::update
+	*	@note A repeat decorator that yields mid loop starts its loop over on
+	*	resume; finished iterations of the loop are not replayed node by node.
+	*/
+	class TickBudget
+	{
+	public:
+		//No cap on node visits.
+		static const int UNLIMITED = -1;
+
+		/**
+		*	@name TickBudget
+		*	@brief Budget with a visit cap, a time cap, or both.
+		*
+		*	@param maxNodeVisits Yield after this many node visits. UNLIMITED for no cap.
+		*	@param maxMicroseconds Yield once this much time passed. 0 or less for no cap.
+		*/
+		TickBudget(const int maxNodeVisits, const float maxMicroseconds = 0.0f);
+
+		//Yield after this many node visits. UNLIMITED if uncapped.
+		int maxNodeVisits;
+
+		//Yield once this much time passed in one update. 0 or less if uncapped.
+		float maxMicroseconds;
+	};
+
+	/**
+	*	@enum EVENT_TYPE
+	*	@brief What an Event posted to a TreeInstance does. @see Event
+	*/
+	enum class EVENT_TYPE
+	{
+		//Clear the addressed node's per-instance state. A LEAF gets reset().
+		RESET_NODE = 0,
+
+		//Clear a Limiter's execution counter, refunding its executions.
+		RESET_LIMITER,
+
+		//Expire a TimeLimit early. Its child gets one more update; if it is
+		//still RUNNING then, the TimeLimit fails as if the time ran out.
+		EXPIRE_TIME_LIMIT,
+
+		//End a DelayTime's delay, so the next update reaches its child.
+		FINISH_DELAY,
+
+		//Preempt a Selector's running branch in favor of the higher
+		//priority branch slot carried in the event's data. @see Tree::preempt
+		PREEMPT_BRANCH,
+
+		//Deliver the event's data to a LEAF through Node::onEvent.
+		CUSTOM
+	};
+
+	/**
+	*	@struct Event
+	*	@brief One event posted to a TreeInstance from any thread.
+	*
+	*	@details Events address nodes by flat baked index (depth first order,
+	*	root is 0; the same indices Serialization stores). They are applied on
+	*	the ticking thread at the start of the next Tree::update of the
+	*	instance, so handlers never race the walk. @see TreeInstance::postEvent
+	*/
+	struct Event
+	{
+		//Flat index of the addressed node. Events with an index out of
+		//range or a type that doesn't match the node's type are dropped.
+		int nodeIndex;
+
+		//What to do at the node.
+		EVENT_TYPE type;
+
+		//User payload for CUSTOM events and the preempting branch slot for
+		//PREEMPT_BRANCH. Ignored by the other types.
+		int data;
+	};
+
+	/**
+	*	@class EventQueue
+	*	@brief Bounded lock-free multi-producer single-consumer event queue.
+	*
+	*	@details Gameplay systems flip state on trees that the Scheduler may
+	*	be ticking on another worker. Instead of serializing those writes on
+	*	one thread, producers post events here from any thread; the single
+	*	consumer is Tree::update, which drains the queue at the start of the
+	*	tick. The queue is a fixed ring of cells, each with a sequence number
+	*	that tells whose turn the cell is, so posting is one fetch_add and one
+	*	store with no locks and no allocation. When the ring is full, post
+	*	fails instead of blocking; the producer can retry next frame.
+	*/
+	class EventQueue
+	{
+	private:
+		/**
+		*	@struct Cell
+		*	@brief One ring slot. The sequence number hands the cell back and
+		*	forth between producers and the consumer.
+		*/
+		struct Cell
+		{
+			//Turn counter. Equal to the cell's position when free for the
+			//producer of that position, position + 1 when ready to consume.
+			std::atomic<std::size_t> sequence;
+
+			//The posted event.
+			Event event;
+		};
+
+		//Ring of cells. Sized once at construction.
+		std::unique_ptr<Cell[]> cells;
+
+		//Capacity - 1. Capacity is a power of two so masking wraps positions.
+		std::size_t capacityMask;
+
+		//Next position to post at. Claimed by producers with fetch_add.
+		std::atomic<std::size_t> enqueuePosition;
+
+		//Next position to consume. Single consumer, so no atomic needed.
+		std::size_t dequeuePosition;
+	public:
+		//Default ring size. Drained every update, so it only has to hold one
+		//frame worth of events for one agent.
+		static const int DEFAULT_CAPACITY = 64;
+
+		/**
+		*	@name EventQueue
+		*	@brief Queue with a fixed capacity.
+		*
+		*	@param capacity Number of cells. Rounded up to a power of two.
+		*/
+		EventQueue(const int capacity = DEFAULT_CAPACITY);
+
+		//Disable copy constructor
+		EventQueue(EventQueue const&) = delete;
+
+		//Disable assign operator
+		void operator=(EventQueue const&) = delete;
+
+		//Default destructor
+		~EventQueue() = default;
+
+		/**
+		*	@name post
+		*	@brief Post one event. Safe to call from any thread.
+		*
+		*	@param event Event to post.
+		*	@return True if posted. False if the queue is full.
+		*/
+		const bool post(const Event& event);
+
+		/**
+		*	@name poll
+		*	@brief Take the oldest event. Single consumer only.
+		*
+		*	@param event Filled with the taken event on success.
+		*	@return True if an event was taken. False if the queue is empty.
+		*/
+		const bool poll(Event& event);
+	};
+
+	/**
+	*	@class TreeInstance
+	*	@brief Per-agent mutable state for one baked Tree.
+	*
+	*	@details Tree only holds the immutable structure (types, child indices,
+	*	decorator parameters). Everything that changes while ticking (running
+	*	child slot, limit counter, elapsed time and so on) lives here, one state
+	*	record per baked node. Many TreeInstances can share one Tree, so the
+	*	structure is read once and stays hot in cache while per-agent state is
+	*	iterated linearly.
+	*	@note Leaf nodes are shared between instances. A leaf that is ticked
+	*	through many instances must be stateless or look up per-agent data by
+	*	itself.
+	*/
+	class TreeInstance
+	{
+	private:
+		//Per-agent state lives in compact per-field streams (structure of
+		//arrays), indexed by slots that Tree assigns while baking. Only node
+		//types that use a field get a slot in its stream, so an agent pays
+		//only for the state its tree actually has and each stream is walked
+		//linearly while ticking. Immutable configuration (durations, limits)
+		//stays in the shared Tree structure.
+
+		//Slot of child that is running, one per composite node.
+		//NO_RUNNING_CHILD if none running. Indexed by BakedNode::stateSlot.
+		std::vector<int> runningChildren;
+
+		//Execution counters, one per Limiter node.
+		std::vector<int> counters;
+
+		//Elapsed times, one per TimeLimit node.
+		std::vector<float> timers;
+
+		//Elapsed time, finished flag and last child result, one of each per
+		//DelayTime node. The three streams share the node's slot.
+		std::vector<float> delayElapsed;
+		std::vector<unsigned char> delayFinished;
+		std::vector<NODE_STATE> delayResults;
+
+		//Number of baked nodes this instance was created for.
+		int nodeCount;
+
+		//Per-instance copy of Tree's child index array. Random composites
+		//shuffle their slice here, so instances don't disturb each other.
+		std::vector<int> childOrder;
+
+		//Per-instance PRNG state. Seeded once when the instance is created.
+		unsigned int rngState;
+
+		//Running-path cache. Flat index of the deepest node that reported
+		//RUNNING last update, if every ancestor of it is a composite. Tree
+		//resumes the walk there instead of descending from the root. -1 if
+		//nothing is running or the path can't be resumed.
+		int runningNodeIndex;
+
+		//Result of the last update. FAILURE before first update.
+		NODE_STATE lastState;
+
+		//Tick budget bookkeeping. Only meaningful while an update with a
+		//budget is in flight. @see TickBudget
+		bool budgetActive;
+		bool budgetExhausted;
+
+		//Node visits left before the budget yields. TickBudget::UNLIMITED
+		//if only the time cap is set.
+		int budgetVisitsLeft;
+
+		//Node visits so far this update. Clock checks are amortized over it.
+		int budgetVisitCount;
+
+		//True if the budget has a time cap.
+		bool budgetTimed;
+
+		//Point in time where a timed budget yields.
+		std::chrono::steady_clock::time_point budgetDeadline;
+
+		//True if the last budgeted update ran out of budget and yielded.
+		bool lastTickYielded;
+
+#if defined(BT_DEBUG_ALLOC)
+		//Heap allocations counted during this instance's last update.
+		//Only exists with BT_DEBUG_ALLOC. @see AllocationAudit
+		unsigned long long lastTickAllocationCount;
+#endif
+
+		//Events posted to this instance, drained at the start of its next
+		//update. Behind a pointer so the instance stays movable. @see EventQueue
+		std::unique_ptr<EventQueue> events;
+
+		/**
+		*	@struct TraversalFrame
+		*	@brief One level of the iterative walk. @see Tree::updateBakedNode
+		*/
+		struct TraversalFrame
+		{
+			//Flat index of the node this frame drives.
+			int index;
+
+			//Where the frame is in its node's logic. 0 enters the node;
+			//other values tell which child return the frame waits on and
+			//are per node type.
+			int phase;
+
+			//Composites: next update slot. Repeats: iterations done.
+			int childSlot;
+
+			//Delta this node was entered with.
+			float delta;
+
+			//Result delivered by the child frame that just finished.
+			NODE_STATE childState;
+
+			//DelayTime: true once a cycle fired during this entry.
+			bool executed;
+
+#if defined(BT_PROFILING)
+			//When this frame was pushed, for the inclusive seconds.
+			std::chrono::steady_clock::time_point profileStart;
+
+#if defined(BT_DEBUG_ALLOC)
+			//Audit count when this frame was pushed, for the per-sample
+			//allocation delta. @see AllocationAudit
+			unsigned long long allocStart;
+#endif
+#endif
+		};
+
+		//Reusable stack for the iterative walk, one frame per level of the
+		//active path. Cleared with capacity kept every update and reserved
+		//to the tree's depth at creation, so deep trees cost entries here
+		//instead of C++ stack frames and steady state never allocates.
+		std::vector<TraversalFrame> traversalStack;
+
+		//Tree reads and writes instance state while updating.
+		friend class Tree;
+	public:
+		//Default constructor. Empty until sized by Tree::createInstance.
+		TreeInstance();
+
+		//Moves only. The instance owns its event queue exclusively; copying
+		//an instance's state is what Tree::createInstance is for.
+		TreeInstance(TreeInstance&&) = default;
+		TreeInstance& operator=(TreeInstance&&) = default;
+
+		//Disable copy constructor
+		TreeInstance(TreeInstance const&) = delete;
+
+		//Disable assign operator
+		void operator=(TreeInstance const&) = delete;
+
+		//Default destructor
+		~TreeInstance() = default;
+
+		/**
+		*	@name getLastState
+		*	@brief Get result of the last update on this instance.
+		*
+		*	@return Result state of the last update. FAILURE if never updated.
+		*/
+		const NODE_STATE getLastState();
+
+		/**
+		*	@name getLastTickYielded
+		*	@brief Tells if the last budgeted update yielded instead of finishing.
+		*
+		*	@details A budgeted update that runs out of budget returns RUNNING,
+		*	same as a genuinely running leaf. Check this to tell the two apart,
+		*	for example to give the agent a bigger budget next frame.
+		*	@return True if the last update hit its TickBudget cap.
+		*/
+		const bool getLastTickYielded();
+
+#if defined(BT_DEBUG_ALLOC)
+		/**
+		*	@name getLastTickAllocationCount
+		*	@brief Get heap allocations counted during the last update of
+		*	this instance. Only exists with BT_DEBUG_ALLOC.
+		*
+		*	@details The engine walk doesn't allocate; a nonzero count comes
+		*	from a user leaf or a memoized re-evaluation. @see AllocationAudit
+		*	@return Allocations counted by the last update. 0 if never updated.
+		*/
+		const unsigned long long getLastTickAllocationCount();
+#endif
+
+		/**
+		*	@name postEvent
+		*	@brief Post an event to this instance. Safe to call from any thread.
+		*
+		*	@details The event is applied on the ticking thread at the start
+		*	of this instance's next Tree::update, so posting never races a
+		*	walk in flight on another worker. @see Event
+		*	@param event Event to post.
+		*	@return True if posted. False if the queue is full or the instance
+		*	wasn't created by Tree::createInstance yet.
+		*/
+		const bool postEvent(const Event& event);
+	};
+
+	/**
+	*	@class Tree
+	*	@brief Baked, flat representation of a built node graph.
+	*
+	*	@details Tree takes the root node of a graph built with the node classes and
+	*	flattens it in to one contiguous array in depth first order. Children are
+	*	addressed by index instead of pointer, so updating the tree walks the flat
+	*	array instead of chasing heap-scattered unique_ptrs. Composite and decorator
+	*	nodes that this library provides are interpreted directly from the baked
+	*	array. Any other node (user's action or condition node) stays a leaf and is
+	*	updated through the usual virtual call.
+	*	Tree keeps the original graph alive as the authoring front-end; build with
+	*	the node classes, then bake once and update the Tree every frame.
+	*/
+	class Tree
+	{
+	private:
+		/**
+		*	@struct BakedNode
+		*	@brief One node in the flat array.
+		*/
+		struct BakedNode
+		{
+			//Type of this node. LEAF if Tree doesn't interpret it.
+			NODE_TYPE type;
+
+			//Original node. Used for virtual update on LEAF.
+			Node* node;
+
+			//Index in to childIndices where this node's children start. -1 if none.
+			int childStart;
+
+			//Number of children.
+			int childCount;
+
+			//Index of parent node. -1 for root.
+			int parent;
+
+			//Immutable parameters baked from decorators.
+			int repeat;
+			float duration;
+			bool delayOnce;
+
+			//Slot in to the per-instance state stream of this node's type.
+			//-1 if the type keeps no per-agent state. @see TreeInstance
+			int stateSlot;
+
+			//True if every ancestor of this node is a composite. Only then a
+			//RUNNING state that starts here can be resumed directly, because
+			//bubbling a result up through composites is well defined.
+			bool onCompositePath;
+		};
+
+		/**
+		*	@struct Structure
+		*	@brief Immutable part of a baked tree, shared between clones.
+		*/
+		struct Structure
+		{
+			//Nodes in depth first order. Root is index 0.
+			std::vector<BakedNode> nodes;
+
+			//Flat child index array. Each BakedNode owns a slice of it.
+			std::vector<int> childIndices;
+
+			//Original node graph. Keeps leaf nodes alive while Tree is used.
+			std::unique_ptr<Node> root;
+
+			//Leaf nodes made by Serialization when a tree is loaded from file.
+			//Empty for trees baked from a node graph. @see Serialization
+			std::vector<std::unique_ptr<Node>> loadedLeaves;
+
+			//How composites in this tree handle ERROR. Fixed at construction
+			//and shared by clones, so reads need no synchronization.
+			ERROR_POLICY errorPolicy = ERROR_POLICY::IGNORE;
+
+			//Number of slots in each per-instance state stream. Counted
+			//while baking; createInstance sizes the streams with these.
+			int runningChildSlotCount = 0;
+			int counterSlotCount = 0;
+			int timerSlotCount = 0;
+			int delaySlotCount = 0;
+
+			//False if validation rejected the tree at bake. @see Tree::isValid
+			bool valid = true;
+
+			//Why validation rejected the tree. Empty while valid.
+			std::string bakeError;
+		};
+
+		//Baked structure. Read-only after baking, so clones share one copy.
+		std::shared_ptr<Structure> structure;
+
+		//State for the single-agent Tree::update(delta) front-end.
+		TreeInstance defaultInstance;
+
+#if defined(BT_PROFILING)
+		//Per-tree profiling data. Bound for the span of every update.
+		Profiler profiler;
+#endif
+
+		/**
+		*	@name Tree
+		*	@brief Private constructor for clone. Shares baked structure.
+		*
+		*	@param structure Structure baked by another Tree.
+		*/
+		Tree(std::shared_ptr<Structure> structure);
+
+		/**
+		*	@name bakeNode
+		*	@brief Recursively flatten node in to the nodes array.
+		*
+		*	@param node A node to bake.
+		*	@param parent Flat index of parent node. -1 for root.
+		*	@return Flat index of baked node.
+		*/
+		const int bakeNode(Node* node, const int parent);
+
+		/**
+		*	@name optimizeNode
+		*	@brief Rewrite shapes that cost node visits but can't change results.
+		*
+		*	@details Runs over the authored graph once before baking. Collapses
+		*	single child composites in to their child, drops double inversion
+		*	and folds result rewriters (Inverter, Succeeder, Failer) under a
+		*	Succeeder or Failer, which return their constant no matter what the
+		*	child said. Only exact library types are touched; user derived
+		*	nodes and reactive selectors are left exactly as authored.
+		*
+		*	Composites collapse only under the TERMINATE policy. Under IGNORE
+		*	a composite absorbs a child ERROR in to its continue result
+		*	(Sequence reads it as SUCCESS, Selector as FAILURE), so the
+		*	collapse would hand the raw ERROR to the grandparent and change
+		*	what the tree returns; under TERMINATE the ERROR propagates
+		*	identically with or without the composite.
+		*	@param slot Owning slot holding the node. Rewrites replace the slot.
+		*	@param isRoot True for the root slot. The root composite is never
+		*	collapsed, because a bare child reports ERROR to the caller where
+		*	the composite would have absorbed it.
+		*/
+		void optimizeNode(std::unique_ptr<Node>& slot, const bool isRoot);
+
+		/**
+		*	@name validateStructure
+		*	@brief Reject malformed shapes once at bake. @see isValid
+		*
+		*	@details One linear scan over the flat array: childless composites
+		*	and decorators, negative repeat counts and negative durations are
+		*	all shapes that can only ever tick to ERROR, so they are reported
+		*	at load instead of being branched on every tick of every agent.
+		*	Stops at the first offence and records it. @see getBakeError
+		*/
+		void validateStructure();
+
+		/**
+		*	@name updateBakedNode
+		*	@brief Update a baked node by interpreting the flat array.
+		*
+		*	@details Iterative. Drives the walk with the instance's reusable
+		*	frame stack instead of recursing, so a level of tree depth costs
+		*	one small frame in that stack and no C++ stack frame or nested
+		*	virtual call, and designer trees can't overflow the machine
+		*	stack however deep. @see TreeInstance::TraversalFrame
+		*	@param instance Per-agent state to read and write.
+		*	@param index Flat index of node to update.
+		*	@param delta An elapsed time for current frame.
+		*	@return Result state of the node.
+		*/
+		const NODE_STATE updateBakedNode(TreeInstance& instance, const int index, const float delta);
+
+		//Update children of baked composite. Mirrors CompositeNode::updateChildren.
+		const NODE_STATE updateBakedChildren(TreeInstance& instance, const int index, const int start, const float delta, const NODE_STATE continueCondition);
+
+		/**
+		*	@name resumeBakedNode
+		*	@brief Resume update at the cached deepest RUNNING node and bubble
+		*	the result up through the composite ancestors. Skips re-traversal
+		*	from the root entirely while the node keeps running.
+		*
+		*	@param instance Per-agent state to read and write.
+		*	@param index Flat index of the cached running node.
+		*	@param delta An elapsed time for current frame.
+		*	@return Result state of the root node.
+		*/
+		const NODE_STATE resumeBakedNode(TreeInstance& instance, const int index, const float delta);
+
+		/**
+		*	@name budgetExceeded
+		*	@brief Charge one node visit against the instance's tick budget.
+		*
+		*	@details Called on every baked node visit. Once the visit cap or
+		*	the time cap is hit the instance is marked exhausted and every
+		*	visit after that reports exceeded, so the whole walk unwinds with
+		*	RUNNING. Clock checks are done every 32 visits only, to keep the
+		*	cost per visit at a decrement while a timed budget is on.
+		*	@param instance Per-agent state carrying the in-flight budget.
+		*	@return True if the budget is used up and the walk must yield.
+		*/
+		const bool budgetExceeded(TreeInstance& instance);
+
+		/**
+		*	@name drainEvents
+		*	@brief Apply every event posted to the instance since its last
+		*	update. Called at the start of update, on the ticking thread.
+		*
+		*	@param instance Instance whose queue is drained.
+		*/
+		void drainEvents(TreeInstance& instance);
+
+		/**
+		*	@name subtreeEnd
+		*	@brief Get the flat index one past the subtree rooted at a node.
+		*
+		*	@details Baking is depth first, so a subtree is one contiguous
+		*	index range starting at its root.
+		*	@param index Flat index of the subtree's root.
+		*	@return First flat index after the subtree.
+		*/
+		const int subtreeEnd(const int index);
+
+		/**
+		*	@name resetBakedNodeState
+		*	@brief Clear one node's per-instance state. A LEAF gets reset().
+		*
+		*	@param instance Per-agent state to clear the node's slot in.
+		*	@param index Flat index of the node.
+		*/
+		void resetBakedNodeState(TreeInstance& instance, const int index);
+
+		//Serialization reads and rebuilds the baked structure.
+		friend class Serialization;
+	public:
+		/**
+		*	@name Tree
+		*	@brief Bakes the node graph in to a flat array.
+		*
+		*	@param root Root node of a built graph. Tree takes the ownership.
+		*	@param errorPolicy How composites handle ERROR. Fixed for the
+		*	tree's lifetime and pushed down the original graph as well, so
+		*	leaves that stay behind virtual calls follow it too. IGNORE by
+		*	default. @see ERROR_POLICY
+		*/
+		Tree(std::unique_ptr<Node> root, const ERROR_POLICY errorPolicy = ERROR_POLICY::IGNORE);
+
+		//Disable copy constructor
+		Tree(Tree const&) = delete;
+
+		//Disable assign operator
+		void operator=(Tree const&) = delete;
+
+		//Default move constructor
+		Tree(Tree&&) = default;
+
+		//Default destructor
+		~Tree() = default;
+
+		/**
+		*	@name clone
+		*	@brief Create another Tree over the same baked structure.
+		*
+		*	@details The flat node array and the original node graph are shared,
+		*	so cloning doesn't copy or allocate nodes; only fresh per-agent state
+		*	is made. Use it to stamp out trees from an archetype without going
+		*	back to the global heap. Clones must not outlive the pool their
+		*	archetype's nodes were allocated from. @see NodePool
+		*	@return A Tree sharing this tree's structure, with fresh state.
+		*/
+		Tree clone();
+
+		/**
+		*	@name update
+		*	@brief Updates the tree by walking the flat array from the root.
+		*	@note Uses the built-in default instance. For many agents sharing
+		*	this tree, use createInstance and the instance overload instead.
+		*
+		*	@param const float delta = 0 An elapsed time for current frame.
+		*	@return Result state of the root node.
+		*/
+		const NODE_STATE update(const float delta = 0);
+
+		/**
+		*	@name update
+		*	@brief Updates the tree against the given per-agent instance.
+		*
+		*	@param instance Per-agent state created by createInstance.
+		*	@param delta An elapsed time for current frame.
+		*	@return Result state of the root node.
+		*/
+		const NODE_STATE update(TreeInstance& instance, const float delta);
+
+		/**
+		*	@name update
+		*	@brief Updates the default instance under a tick budget.
+		*
+		*	@param delta An elapsed time for current frame.
+		*	@param budget Work cap for this update. @see TickBudget
+		*	@return Result state of the root node. RUNNING if the budget ran out.
+		*/
+		const NODE_STATE update(const float delta, const TickBudget& budget);
+
+		/**
+		*	@name update
+		*	@brief Updates the given instance under a tick budget.
+		*
+		*	@details Once the budget is used up the walk stops where it is,
+		*	records its position through the running-child slots and returns
+		*	RUNNING. The next update on the same instance resumes there, so an
+		*	expensive subtree is spread over several frames instead of blowing
+		*	one. Use TreeInstance::getLastTickYielded to tell a budget yield
+		*	from a genuinely running leaf.
+		*	@param instance Per-agent state created by createInstance.
+		*	@param delta An elapsed time for current frame.
+		*	@param budget Work cap for this update. @see TickBudget
+		*	@return Result state of the root node. RUNNING if the budget ran out.
+		*/
+		const NODE_STATE update(TreeInstance& instance, const float delta, const TickBudget& budget);
+
+		/**
+		*	@name createInstance
+		*	@brief Create fresh per-agent state sized for this tree.
+		*
+		*	@return A TreeInstance with one state record per baked node.
+		*/
+		TreeInstance createInstance();
+
+		/**
+		*	@name reset
+		*	@brief Reset the default instance and the original node graph.
+		*/
+		void reset();
+
+		/**
+		*	@name reset
+		*	@brief Reset the given per-agent instance.
+		*
+		*	@param instance Instance to reset.
+		*/
+		void reset(TreeInstance& instance);
+
+		/**
+		*	@name resetActive
+		*	@brief Reset only the path that is actually in flight.
+		*	@note Uses the built-in default instance.
+		*/
+		void resetActive();
+
+		/**
+		*	@name resetActive
+		*	@brief Reset only the path that is actually in flight.
+		*
+		*	@details Follows the running child slots from the root down to the
+		*	deepest in-flight node, clearing slot, delay and time limit state
+		*	on the way and calling reset on the leaf it ends at. Nodes off the
+		*	path are never visited, so interrupting an agent costs the depth
+		*	of the active path, not the size of the tree. Limiter counters are
+		*	kept; an interrupt doesn't refund executions. Use reset for the
+		*	full wipe.
+		*	@param instance Instance to reset.
+		*/
+		void resetActive(TreeInstance& instance);
+
+		/**
+		*	@name preempt
+		*	@brief Abort a Selector's running branch in favor of a higher
+		*	priority one.
+		*	@note Uses the built-in default instance.
+		*
+		*	@param selectorIndex Flat index of the baked Selector.
+		*	@param branchSlot Slot of the preempting branch. 0 is the highest.
+		*	@return True if a running lower priority branch was preempted.
+		*/
+		const bool preempt(const int selectorIndex, const int branchSlot);
+
+		/**
+		*	@name preempt
+		*	@brief Abort a Selector's running branch in favor of a higher
+		*	priority one, on the given instance.
+		*
+		*	@details Child order is the priority lane: slot 0 is the highest.
+		*	When a branch of lower priority than the given slot is running,
+		*	only that branch's subtree has its per-instance state cleared
+		*	(leaves get reset()), and the next update enters directly at the
+		*	given slot - higher priority branches are not re-evaluated and
+		*	nothing outside the abandoned path is visited, so the cost is the
+		*	abandoned subtree, not the whole tree. The baked counterpart of
+		*	Selector::preempt.
+		*	@note Call from the ticking thread. From any other thread, post a
+		*	PREEMPT_BRANCH event carrying the branch slot in its data instead;
+		*	it is applied through this method at the start of the instance's
+		*	next update. @see Event
+		*
+		*	@param instance Per-agent state created by createInstance.
+		*	@param selectorIndex Flat index of the baked Selector. Root is 0.
+		*	@param branchSlot Slot of the preempting branch. 0 is the highest.
+		*	@return True if a running lower priority branch was preempted.
+		*	False if the index isn't a baked SELECTOR, the slot is out of
+		*	range, nothing is running, or the running branch already has
+		*	equal or higher priority.
+		*/
+		const bool preempt(TreeInstance& instance, const int selectorIndex, const int branchSlot);
+
+		/**
+		*	@name getNodeCount
+		*	@brief Get number of baked nodes.
+		*
+		*	@return Number of nodes in the flat array. 0 if root was nullptr.
+		*/
+		const int getNodeCount();
+
+		/**
+		*	@name getErrorPolicy
+		*	@brief Get how composites in this tree handle ERROR.
+		*
+		*	@return This tree's error policy, fixed at construction.
+		*/
+		const ERROR_POLICY getErrorPolicy();
+
+		/**
+		*	@name isValid
+		*	@brief Tell if validation accepted the tree at bake.
+		*
+		*	@details Every update of a rejected tree returns ERROR without
+		*	walking. Check once after construction, at load time.
+		*	@return False if the baked tree was rejected. @see getBakeError
+		*/
+		const bool isValid();
+
+		/**
+		*	@name getBakeError
+		*	@brief Get why validation rejected the tree.
+		*
+		*	@return The first offence found at bake. Empty while the tree is valid.
+		*/
+		const std::string& getBakeError();
+
+		/**
+		*	@name saveState
+		*	@brief Snapshot the default instance's execution state.
+		*	@see saveState(TreeInstance&, std::vector<unsigned char>&)
+		*
+		*	@param buffer Filled with the blob. Cleared first.
+		*	@return True on success.
+		*/
+		const bool saveState(std::vector<unsigned char>& buffer);
+
+		/**
+		*	@name saveState
+		*	@brief Snapshot an instance's execution state in to a compact blob.
+		*
+		*	@details Captures everything that changes while ticking: running
+		*	child slots, limit counters, elapsed times, delay state, shuffled
+		*	child orders, the PRNG state and the running-path cache. The blob
+		*	is versioned and index based, so an agent handed to another
+		*	process resumes mid-behavior against the same tree structure
+		*	instead of resetting and re-running from the root.
+		*	@note A blob only matches the structure it was saved from; load it
+		*	in to an instance of the same baked tree (same build, or the same
+		*	file through Serialization). Leaf nodes behind virtual calls keep
+		*	their own members and are not captured; instances already require
+		*	shared leaves to be stateless. Pending events are not captured
+		*	either. Native endian, native int, like Serialization files.
+		*	@param instance Instance to snapshot.
+		*	@param buffer Filled with the blob. Cleared first.
+		*	@return True on success. False if the instance wasn't created from
+		*	this tree.
+		*/
+		const bool saveState(TreeInstance& instance, std::vector<unsigned char>& buffer);
+
+		/**
+		*	@name loadState
+		*	@brief Restore the default instance from a blob made by saveState.
+		*	@see loadState(TreeInstance&, const std::vector<unsigned char>&)
+		*
+		*	@param buffer Blob made by saveState.
+		*	@return True on success.
+		*/
+		const bool loadState(const std::vector<unsigned char>& buffer);
+
+		/**
+		*	@name loadState
+		*	@brief Restore an instance's execution state from a blob.
+		*
+		*	@details The blob is validated before anything is applied: magic,
+		*	version, node count and every stream size must match this tree's
+		*	structure, and every index and enum in it must be in range. The
+		*	instance is untouched when validation fails, so a corrupt or
+		*	mismatched blob can't leave an agent half-restored.
+		*	@param instance Instance to restore. Must be created from this tree.
+		*	@param buffer Blob made by saveState.
+		*	@return True on success. False if the blob doesn't match this tree
+		*	or is malformed.
+		*/
+		const bool loadState(TreeInstance& instance, const std::vector<unsigned char>& buffer);
+
+#if defined(BT_PROFILING)
+		/**
+		*	@name getProfiler
+		*	@brief Get this tree's profiling data. Only exists with BT_PROFILING.
+		*
+		*	@return Profiler that every update of this tree records in to.
+		*/
+		Profiler& getProfiler();
+#endif
+	};
+
+	/**
+	*	@class SubtreeRef
+	*	@brief A leaf that ticks a shared subtree with its own per-agent state.
+	*
+	*	@details Common subtrees (flee, idle) are usually deep-copied in to
+	*	every agent's tree because composite children are owning unique_ptrs.
+	*	SubtreeRef shares one baked Tree between any number of agents instead:
+	*	the immutable structure exists once, and each ref carries only a
+	*	TreeInstance with the per-agent state streams. Thirty agents with a
+	*	30 node flee subtree hold one copy of those 30 nodes.
+	*	Mutation is copy-on-write by replacement: a baked structure is
+	*	immutable, so a tool that edits the subtree at runtime builds the
+	*	edited version as a new Tree and calls setSubtree on the refs that
+	*	should pick it up. Agents still pointing at the old version keep it
+	*	alive through the shared_ptr; nothing ticks a half-edited tree.
+	*	@note The shared Tree's structure is read-only while ticking, so refs
+	*	in different agents may tick on different Scheduler workers.
+	*/
+	class SubtreeRef : public Node
+	{
+	private:
+		//The shared subtree. Structure is shared; state is not.
+		std::shared_ptr<Tree> subtree;
+
+		//This agent's state for the shared subtree.
+		TreeInstance instance;
+	public:
+		/**
+		*	@name SubtreeRef
+		*	@brief Reference a shared subtree.
+		*
+		*	@param subtree Baked subtree shared between agents. nullptr makes
+		*	the ref report ERROR until setSubtree is called.
+		*/
+		SubtreeRef(std::shared_ptr<Tree> subtree);
+
+		//Disable copy constructor
+		SubtreeRef(SubtreeRef const&) = delete;
+
+		//Disable assign operator
+		void operator=(SubtreeRef const&) = delete;
+
+		//Default destructor
+		virtual ~SubtreeRef() = default;
+
+		/**
+		*	@name update
+		*	@brief Tick the shared subtree against this ref's own state.
+		*
+		*	@param const float delta = 0 An elapsed time for current frame.
+		*	@return Result state of the subtree's root. ERROR if no subtree.
+		*/
+		virtual const NODE_STATE update(const float delta = 0) override;
+
+		/**
+		*	@name reset
+		*	@brief Reset this ref's state. The shared structure is untouched.
+		*/
+		virtual void reset() override;
+
+		/**
+		*	@name setSubtree
+		*	@brief Swap in another version of the subtree.
+		*
+		*	@details The copy-on-write point: tools edit by building the new
+		*	version and swapping it in here. Per-agent state is re-created for
+		*	the new version; refs that keep the old pointer are unaffected.
+		*	@param subtree The new subtree. nullptr detaches the ref.
+		*/
+		void setSubtree(std::shared_ptr<Tree> subtree);
+
+		/**
+		*	@name getSubtree
+		*	@brief Get the subtree this ref currently points at.
+		*
+		*	@return Shared subtree. nullptr if detached.
+		*/
+		std::shared_ptr<Tree> getSubtree();
+
+		/**
+		*	@name clone
+		*	@brief Copy this ref. The copy shares the same subtree and gets a
+		*	fresh TreeInstance, so cloning an agent tree that refs shared
+		*	subtrees never copies the shared nodes. @see Node::clone
+		*
+		*	@return The copy. Never nullptr; a detached ref clones detached.
+		*/
+		virtual std::unique_ptr<Node> clone() override;
+	};
+
+	/**
+	*	@class ArchetypeRegistry
+	*	@brief Registered prototype graphs, stamped out per agent with clone.
+	*
+	*	@details Spawning used to re-run the hand written builder code of an
+	*	agent's tree: dozens of factory calls, every wave start. Register the
+	*	graph once as a prototype instead and spawn copies of it by ID; a
+	*	spawn is one clone pass over the prototype. Bind a NodePool around
+	*	spawn and the copy lands in the arena back to back. @see NodePool
+	*	Prototypes whose leaves don't override Node::clone can be registered,
+	*	but spawning them fails with nullptr. @see Node::clone
+	*	@note Registration is not synchronized. Register during startup, then
+	*	spawn from any one thread at a time.
+	*/
+	class ArchetypeRegistry
+	{
+	private:
+		//ArchetypeRegistry only has static functions.
+		ArchetypeRegistry() = delete;
+
+		//Registered prototypes by user chosen ID.
+		static std::unordered_map<int, std::unique_ptr<Node>>& getPrototypes();
+	public:
+		/**
+		*	@name registerArchetype
+		*	@brief Register one prototype graph under an ID.
+		*
+		*	@param id User chosen ID. Must be unique.
+		*	@param prototype Root of the graph to register. Taken over.
+		*	@return True if registered. False if the ID is taken or the
+		*	prototype is nullptr.
+		*/
+		static const bool registerArchetype(const int id, std::unique_ptr<Node> prototype);
+
+		/**
+		*	@name unregisterArchetype
+		*	@brief Remove one prototype. Spawned copies are not affected.
+		*
+		*	@param id ID of the prototype to remove.
+		*	@return True if removed. False if the ID isn't registered.
+		*/
+		static const bool unregisterArchetype(const int id);
+
+		/**
+		*	@name spawn
+		*	@brief Stamp out a copy of a registered prototype.
+		*
+		*	@param id ID of the prototype to copy.
+		*	@return Fresh copy of the graph. nullptr if the ID isn't
+		*	registered or the graph holds a leaf without clone.
+		*/
+		static std::unique_ptr<Node> spawn(const int id);
+
+		/**
+		*	@name spawnTree
+		*	@brief Spawn a copy and bake it in to a Tree in one step.
+		*
+		*	@param id ID of the prototype to copy.
+		*	@param errorPolicy How the spawned tree handles ERROR.
+		*	@return Baked tree of the copy. nullptr if spawn fails.
+		*/
+		static std::unique_ptr<Tree> spawnTree(const int id, const ERROR_POLICY errorPolicy = ERROR_POLICY::IGNORE);
+	};
+
+	/**
+	*	@class Batch
+	*	@brief Ticks many instances of one shared Tree in a single call.
+	*
+	*	@details Instead of ticking thousands of identical trees one at a time,
+	*	build the tree once, create one TreeInstance per agent and hand the whole
+	*	array to Batch::update. The immutable structure is read once for the
+	*	whole batch while per-agent state is walked linearly, so the structure
+	*	stays in cache across agents. Each instance's result is kept in the
+	*	instance. @see TreeInstance::getLastState
+	*/
+	class Batch
+	{
+	private:
+		//Batch only has static functions.
+		Batch() = delete;
+	public:
+		/**
+		*	@name update
+		*	@brief Update every instance in the vector against the shared tree.
+		*
+		*	@param tree A baked tree shared by all instances.
+		*	@param instances Per-agent instances created from the tree.
+		*	@param delta An elapsed time for current frame.
+		*/
+		static void update(Tree& tree, std::vector<TreeInstance>& instances, const float delta);
+
+		/**
+		*	@name update
+		*	@brief Update instances given as raw array. Useful when instances
+		*	are stored inside user's agent struct.
+		*
+		*	@param tree A baked tree shared by all instances.
+		*	@param instances Pointer to first instance.
+		*	@param count Number of instances.
+		*	@param delta An elapsed time for current frame.
+		*/
+		static void update(Tree& tree, TreeInstance* instances, const int count, const float delta);
+	};
+
+	/**
+	*	@class Scheduler
+	*	@brief Distributes independent tree instances across a worker pool.
+	*
+	*	@details Register (Tree, TreeInstance) pairs once, then call update every
+	*	frame. Jobs are dealt round robin to per-worker deques and idle workers
+	*	steal from the back of busy workers' deques, so uneven tree costs still
+	*	fill every core. update blocks until the whole frame is ticked.
+	*
+	*	Thread safety contract: every registered pair is updated by exactly one
+	*	worker per frame, and a Tree's immutable structure is read-only while
+	*	ticking, so different instances of the same Tree can tick on different
+	*	workers. Leaf nodes that are shared between instances must be reentrant.
+	*	Error policies are fixed per tree, so they need no care here. Don't add
+	*	or remove pairs while update is in flight.
+	*
+	*	Level of detail: pairs register with a TICK_RATE. Reduced-rate pairs
+	*	skip frames and get the skipped time delivered as one accumulated
+	*	delta when they are due, so their clocks stay correct; off-screen
+	*	agents at ONE_HZ cost two orders of magnitude less than full rate.
+	*	@see TICK_RATE
+	*
+	*	Phase buckets: reduced-rate pairs registered in the same frame would
+	*	all come due in the same frame, turning the saved cost in to one
+	*	periodic spike. To spread them, every reduced-rate pair is dealt a
+	*	phase bucket at registration and its first due time is offset by its
+	*	bucket's share of the period; from then on the period keeps the
+	*	offsets apart, so each frame ticks roughly population / bucket count
+	*	pairs. Only the due time shifts - a pair is always ticked with the
+	*	real time it gathered, so DelayTime and TimeLimit clocks don't drift.
+	*	Registration fills the emptiest bucket, and when removals skew the
+	*	populations anyway the buckets are rebalanced on the spot.
+	*	@see DEFAULT_PHASE_BUCKET_COUNT
+	*/
+	class Scheduler
+	{
+	public:
+		/**
+		*	@enum TICK_RATE
+		*	@brief How often a registered pair is ticked. @see addTree
+		*
+		*	@details A reduced-rate pair accumulates the frame deltas of the
+		*	frames it skips and receives the total in its next update, so
+		*	DelayTime and TimeLimit clocks advance by real time no matter the
+		*	rate. Pick by importance: on-screen agents EVERY_FRAME, nearby
+		*	ones TEN_HZ, far off-screen crowds ONE_HZ.
+		*/
+		enum class TICK_RATE
+		{
+			//Ticked on every update call.
+			EVERY_FRAME = 0,
+
+			//Ticked when at least 0.1 seconds accumulated.
+			TEN_HZ,
+
+			//Ticked when at least 1 second accumulated.
+			ONE_HZ
+		};
+
+		//Default number of phase buckets reduced-rate pairs spread over.
+		static const int DEFAULT_PHASE_BUCKET_COUNT = 8;
+	private:
+		/**
+		*	@struct Job
+		*	@brief One tree instance to tick this frame.
+		*/
+		struct Job
+		{
+			//Shared tree structure.
+			Tree* tree;
+
+			//Per-agent state. Owned by one worker per frame.
+			TreeInstance* instance;
+
+			//How often this pair is due. @see TICK_RATE
+			TICK_RATE rate;
+
+			//Frame time gathered since the pair's last tick. Grows while
+			//the pair skips frames, handed over as jobDelta when due.
+			float accumulatedDelta;
+
+			//Delta this job is ticked with when dealt to a worker.
+			float jobDelta;
+
+			//Phase bucket of a reduced-rate pair. -1 for EVERY_FRAME.
+			int phaseBucket;
+
+			//Gathered time that makes the pair due. The bucket offsets it
+			//for the first tick; afterwards it's the rate's whole period.
+			float dueThreshold;
+		};
+
+		/**
+		*	@struct Worker
+		*	@brief Per-worker job deque. Owner pops front, thieves pop back.
+		*/
+		struct Worker
+		{
+			//Jobs dealt to this worker for current frame.
+			std::deque<Job> jobs;
+
+			//Guards the deque against stealing workers.
+			std::mutex jobsMutex;
+		};
+
+		//All registered pairs. Dealt to workers every frame.
+		std::vector<Job> registeredJobs;
+
+		//Per-worker job deques.
+		std::vector<std::unique_ptr<Worker>> workers;
+
+		//Worker threads. Alive for the Scheduler's lifetime.
+		std::vector<std::thread> threads;
+
+		//Guards frame coordination below.
+		std::mutex frameMutex;
+
+		//Workers wait here between frames.
+		std::condition_variable frameStartSignal;
+
+		//Main thread waits here until the frame is ticked.
+		std::condition_variable frameDoneSignal;
+
+		//Increased once per update. Workers track it to detect a new frame.
+		int frameCount;
+
+		//Number of jobs not yet ticked this frame.
+		std::atomic<int> remainingJobs;
+
+		//True while destructor is shutting the pool down.
+		bool shutdown;
+
+		//Number of phase buckets. Fixed at construction.
+		int phaseBucketCount;
+
+		//How many reduced-rate pairs sit in each phase bucket.
+		std::vector<int> bucketPopulations;
+
+		/**
+		*	@name pickPhaseBucket
+		*	@brief Pick the emptiest phase bucket for a new reduced-rate pair.
+		*
+		*	@return Index of the bucket with the fewest pairs.
+		*/
+		const int pickPhaseBucket();
+
+		/**
+		*	@name rebalancePhaseBuckets
+		*	@brief Deal every reduced-rate pair a fresh bucket, round robin.
+		*
+		*	@details Called when removals skewed the populations. Gathered
+		*	time is kept, only the due offsets move, so no pair loses or
+		*	gains clock time.
+		*/
+		void rebalancePhaseBuckets();
+
+		/**
+		*	@name workerLoop
+		*	@brief Worker thread body. Ticks own jobs, then steals.
+		*
+		*	@param workerIndex Index of this worker's deque.
+		*/
+		void workerLoop(const int workerIndex);
+
+		/**
+		*	@name stealJob
+		*	@brief Try to steal a job from the back of another worker's deque.
+		*
+		*	@param thiefIndex Index of the stealing worker. Skipped while scanning.
+		*	@param job Stolen job is written here.
+		*	@return True if a job was stolen.
+		*/
+		const bool stealJob(const int thiefIndex, Job& job);
+	public:
+		/**
+		*	@name Scheduler
+		*	@brief Starts the worker pool.
+		*
+		*	@param workerCount Number of worker threads. 0 uses hardware concurrency.
+		*	@param phaseBucketCount Number of phase buckets reduced-rate
+		*	pairs spread over. Values below 1 fall back to 1 (no spreading).
+		*/
+		Scheduler(const int workerCount = 0, const int phaseBucketCount = DEFAULT_PHASE_BUCKET_COUNT);
+
+		//Disable copy constructor
+		Scheduler(Scheduler const&) = delete;
+
+		//Disable assign operator
+		void operator=(Scheduler const&) = delete;
+
+		//Stops and joins the worker pool.
+		~Scheduler();
+
+		/**
+		*	@name addTree
+		*	@brief Register a tree instance to be ticked every frame.
+		*	@note Don't call while update is in flight.
+		*
+		*	@param tree Shared tree. Must outlive the Scheduler or be removed.
+		*	@param instance Per-agent state. One worker owns it per frame.
+		*	@param rate How often the pair is ticked. Every frame by default.
+		*/
+		void addTree(Tree* tree, TreeInstance* instance, const TICK_RATE rate = TICK_RATE::EVERY_FRAME);
+
+		/**
+		*	@name removeTree
+		*	@brief Unregister a tree instance.
+		*	@note Don't call while update is in flight.
+		*
+		*	@param instance Instance to remove.
+		*	@return True if the instance was registered.
+		*/
+		const bool removeTree(TreeInstance* instance);
+
+		/**
+		*	@name update
+		*	@brief Tick every registered instance across the worker pool.
+		*	@note Blocks until all instances finished this frame.
+		*
+		*	@param delta An elapsed time for current frame.
+		*/
+		void update(const float delta);
+
+		/**
+		*	@name getWorkerCount
+		*	@brief Get number of worker threads.
+		*
+		*	@return Number of workers in the pool.
+		*/
+		const int getWorkerCount();
+
+		/**
+		*	@name getPhaseBucketCount
+		*	@brief Get number of phase buckets.
+		*/
+		const int getPhaseBucketCount();
+
+		/**
+		*	@name getPhaseBucketPopulation
+		*	@brief Get number of reduced-rate pairs in one phase bucket.
+		*
+		*	@param bucket Bucket index in [0, getPhaseBucketCount()).
+		*	@return Pairs in the bucket. 0 for an index out of range.
+		*/
+		const int getPhaseBucketPopulation(const int bucket);
+	};
+}
+
+// Instrumentation hooks on the update path. With BT_PROFILING defined they
+// time the enclosing update and record it in the bound Profiler; without it
+// they compile to a plain return and cost nothing.
+#if defined(BT_PROFILING)
+#define BT_PROFILE_SCOPE(nodeType) BehaviorTree::ProfileScope btProfileScope_(nodeType)
+#define BT_PROFILE_RETURN(state) return btProfileScope_.finish(state)
+#else
+#define BT_PROFILE_SCOPE(nodeType)
+#define BT_PROFILE_RETURN(state) return (state)
+#endif
 
 #endif
\ No newline at end of file
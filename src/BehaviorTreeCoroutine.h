@@ -0,0 +1,318 @@
+///////////////////////////////////////////////////////////////////////
+// Behavior Tree
+// Copyright (c) 2017 Seung Youp Baek <bsy6766@gmail.com>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any
+// damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any
+// purpose, including commercial applications, and to alter it and
+// redistribute it freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you
+//     must not claim that you wrote the original software. If you use
+//     this software in a product, an acknowledgment in the product
+//     documentation would be appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and
+//     must not be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source
+//     distribution.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef BEHAVIOR_TREE_COROUTINE_H
+#define BEHAVIOR_TREE_COROUTINE_H
+
+#include "BehaviorTree.h"
+
+/**
+*	Coroutine leaf adapter for asynchronous actions.
+*
+*	Leaf actions that wait on async work (a pathfinding request, a lookup on
+*	another thread) usually poll a future from Node::update, returning
+*	RUNNING every frame. The tree still has to reach the leaf to poll it.
+*	CoroutineNode turns such an action in to a coroutine: the action body
+*	co_awaits the async result and co_returns its final state, and while it
+*	is parked waiting the node's update is a single flag check that returns
+*	RUNNING. Together with the running-path cache in Tree the per-frame cost
+*	of a parked subtree drops to almost nothing; no descent, no poll.
+*
+*	This header needs C++20 coroutine support. The rest of the library stays
+*	C++14; without coroutine support the header is empty, so it can be
+*	included unconditionally.
+*/
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_coroutine)
+
+//Tells that CoroutineNode is available in this build.
+#define BT_COROUTINE_NODE 1
+
+#include <atomic>
+
+namespace BehaviorTree
+{
+	/**
+	*	@class CoroutineNode
+	*	@brief A leaf whose action runs as a coroutine across frames.
+	*
+	*	@details Derive and implement run() as a coroutine. Inside run,
+	*	co_await awaitSignal() parks the action until some external code
+	*	(a completion callback, another thread) calls signal() on the node;
+	*	co_await yieldTick() comes back on the next update instead. Finish
+	*	with co_return and the final state. The coroutine starts lazily on
+	*	the first update after construction or reset, and the node reports
+	*	RUNNING for every update in between.
+	*	@note signal() may be called from any thread. Everything else,
+	*	including update and reset, belongs to the ticking thread.
+	*/
+	class CoroutineNode : public Node
+	{
+	public:
+		/**
+		*	@class Coroutine
+		*	@brief Return type of run(). Owns the coroutine frame.
+		*/
+		class Coroutine
+		{
+		public:
+			/**
+			*	@struct promise_type
+			*	@brief Coroutine promise. Carries the co_returned state.
+			*/
+			struct promise_type
+			{
+				//State the action co_returned. ERROR until then.
+				NODE_STATE result = NODE_STATE::ERROR;
+
+				Coroutine get_return_object()
+				{
+					return Coroutine(std::coroutine_handle<promise_type>::from_promise(*this));
+				}
+
+				//Start suspended. The first update resumes in to the body.
+				std::suspend_always initial_suspend() noexcept { return {}; }
+
+				//Stay suspended at the end so the node can read the result.
+				std::suspend_always final_suspend() noexcept { return {}; }
+
+				void return_value(const NODE_STATE state) { this->result = state; }
+
+				//This library reports failures as states, not exceptions.
+				void unhandled_exception() { this->result = NODE_STATE::ERROR; }
+			};
+
+			Coroutine() : handle(nullptr) {}
+
+			Coroutine(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+			//Owns the frame. Moves only.
+			Coroutine(Coroutine const&) = delete;
+			void operator=(Coroutine const&) = delete;
+
+			Coroutine(Coroutine&& other) noexcept : handle(other.handle)
+			{
+				other.handle = nullptr;
+			}
+
+			Coroutine& operator=(Coroutine&& other) noexcept
+			{
+				if (this != &other)
+				{
+					this->destroy();
+					this->handle = other.handle;
+					other.handle = nullptr;
+				}
+
+				return *this;
+			}
+
+			~Coroutine()
+			{
+				this->destroy();
+			}
+
+			//Destroy the frame, if any.
+			void destroy()
+			{
+				if (this->handle)
+				{
+					this->handle.destroy();
+					this->handle = nullptr;
+				}
+			}
+
+			//Coroutine frame. nullptr when not started.
+			std::coroutine_handle<promise_type> handle;
+		};
+
+	protected:
+		/**
+		*	@struct SignalAwaiter
+		*	@brief Awaiter returned by awaitSignal. Parks the node.
+		*/
+		struct SignalAwaiter
+		{
+			CoroutineNode* node;
+
+			//Skip suspending if the signal already arrived.
+			bool await_ready() const noexcept
+			{
+				return node->signaled.load(std::memory_order_acquire);
+			}
+
+			//Park. update returns RUNNING without resuming until signal().
+			void await_suspend(std::coroutine_handle<>) const noexcept
+			{
+				node->parked = true;
+			}
+
+			//Consume the signal on resume.
+			void await_resume() const noexcept
+			{
+				node->signaled.store(false, std::memory_order_relaxed);
+			}
+		};
+
+		/**
+		*	@struct TickAwaiter
+		*	@brief Awaiter returned by yieldTick. Resumes next update.
+		*/
+		struct TickAwaiter
+		{
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<>) const noexcept {}
+			void await_resume() const noexcept {}
+		};
+
+		/**
+		*	@name awaitSignal
+		*	@brief co_await this to park until signal() is called.
+		*
+		*	@details While parked, update doesn't resume the coroutine at
+		*	all; it checks one flag and returns RUNNING. Park before kicking
+		*	off async work completes to miss no signal: signals that arrive
+		*	before the co_await are consumed by await_ready.
+		*	@return Awaiter that suspends until the node is signaled.
+		*/
+		SignalAwaiter awaitSignal()
+		{
+			return SignalAwaiter{ this };
+		}
+
+		/**
+		*	@name yieldTick
+		*	@brief co_await this to give the frame back until the next update.
+		*
+		*	@return Awaiter that suspends for exactly one update.
+		*/
+		TickAwaiter yieldTick()
+		{
+			return TickAwaiter{};
+		}
+
+		/**
+		*	@name run
+		*	@brief The action body. Implement as a coroutine.
+		*
+		*	@details Called once, lazily, on the first update after
+		*	construction or reset. co_return the final state.
+		*	@return Coroutine owning the started (suspended) action.
+		*/
+		virtual Coroutine run() = 0;
+
+	private:
+		//The in-flight action. Empty until the first update.
+		Coroutine coroutine;
+
+		//True while the action co_awaits a signal. Ticking thread only.
+		bool parked = false;
+
+		//Set by signal(), consumed when the coroutine resumes.
+		std::atomic<bool> signaled{ false };
+
+	public:
+		CoroutineNode() : Node() {}
+
+		//Disable copy constructor
+		CoroutineNode(CoroutineNode const&) = delete;
+
+		//Disable assign operator
+		void operator=(CoroutineNode const&) = delete;
+
+		// Virtual destructor
+		virtual ~CoroutineNode() = default;
+
+		/**
+		*	@name signal
+		*	@brief Wake a parked action. Safe to call from any thread.
+		*
+		*	@details The coroutine resumes on the next update of the tree,
+		*	on the ticking thread, never inside signal() itself. Calling it
+		*	while nothing is parked is fine; the next awaitSignal consumes it.
+		*/
+		void signal()
+		{
+			this->signaled.store(true, std::memory_order_release);
+		}
+
+		/**
+		*	@name update
+		*	@brief Drive the coroutine one step, or skip it while parked.
+		*
+		*	@param delta An elapsed time for current frame.
+		*	@return Result state. RUNNING until the action co_returns.
+		*/
+		virtual const NODE_STATE update(const float delta = 0) override
+		{
+			if (this->coroutine.handle == nullptr)
+			{
+				// First update since construction or reset. Start the action.
+				this->coroutine = this->run();
+			}
+
+			if (this->coroutine.handle.done() == false)
+			{
+				if (this->parked && this->signaled.load(std::memory_order_acquire) == false)
+				{
+					// Parked and no signal yet. This is the whole poll.
+					return NODE_STATE::RUNNING;
+				}
+
+				this->parked = false;
+				this->coroutine.handle.resume();
+			}
+
+			if (this->coroutine.handle.done())
+			{
+				// Action finished. Report its state and arm a restart.
+				const NODE_STATE state = this->coroutine.handle.promise().result;
+				this->coroutine.destroy();
+
+				return state;
+			}
+
+			return NODE_STATE::RUNNING;
+		}
+
+		/**
+		*	@name reset
+		*	@brief Abandon the in-flight action. Restarts on next update.
+		*/
+		virtual void reset() override
+		{
+			this->coroutine.destroy();
+			this->parked = false;
+			this->signaled.store(false, std::memory_order_relaxed);
+		}
+	};
+}
+
+#endif
+
+#endif
@@ -0,0 +1,288 @@
+///////////////////////////////////////////////////////////////////////
+// Behavior Tree
+// Copyright (c) 2017 Seung Youp Baek <bsy6766@gmail.com>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any
+// damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any
+// purpose, including commercial applications, and to alter it and
+// redistribute it freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you
+//     must not claim that you wrote the original software. If you use
+//     this software in a product, an acknowledgment in the product
+//     documentation would be appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and
+//     must not be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source
+//     distribution.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "BehaviorTreeSerialization.h"
+
+#include <cstdio>
+#include <cstring>
+
+#if !defined(_WIN32)
+// Zero-copy loading path. Records are read in place from the mapping.
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+*	@name leafFactories
+*	@brief Registered leaf factories by type ID. Used on load.
+*/
+static std::unordered_map<int, BehaviorTree::Serialization::LeafFactory>& leafFactories()
+{
+	static std::unordered_map<int, BehaviorTree::Serialization::LeafFactory> factories;
+	return factories;
+}
+
+/**
+*	@name leafTypeIds
+*	@brief Registered type IDs by typeid. Used on save.
+*/
+static std::unordered_map<std::type_index, int>& leafTypeIds()
+{
+	static std::unordered_map<std::type_index, int> typeIds;
+	return typeIds;
+}
+
+void BehaviorTree::Serialization::registerLeaf(const int typeId, LeafFactory factory, const std::type_info& typeInfo)
+{
+	leafFactories()[typeId] = factory;
+	leafTypeIds()[std::type_index(typeInfo)] = typeId;
+}
+
+const bool BehaviorTree::Serialization::save(BehaviorTree::Tree& tree, const char* filePath)
+{
+	if (filePath == nullptr) return false;
+
+	const Tree::Structure& structure = *tree.structure;
+
+	const int nodeCount = static_cast<int>(structure.nodes.size());
+	if (nodeCount == 0) return false;
+
+	// Convert baked nodes to file records first, so a missing leaf
+	// registration fails before the file is touched.
+	std::vector<SerializedNode> records(nodeCount);
+
+	for (int i = 0; i < nodeCount; i++)
+	{
+		const Tree::BakedNode& bakedNode = structure.nodes.at(i);
+		SerializedNode& record = records.at(i);
+
+		record.type = static_cast<int>(bakedNode.type);
+		record.leafTypeId = -1;
+		record.childStart = bakedNode.childStart;
+		record.childCount = bakedNode.childCount;
+		record.parent = bakedNode.parent;
+		record.repeat = bakedNode.repeat;
+		record.duration = bakedNode.duration;
+		record.delayOnce = bakedNode.delayOnce ? 1 : 0;
+		record.onCompositePath = bakedNode.onCompositePath ? 1 : 0;
+
+		if (bakedNode.type == NODE_TYPE::LEAF)
+		{
+			auto found = leafTypeIds().find(std::type_index(typeid(*bakedNode.node)));
+			if (found == leafTypeIds().end())
+			{
+				// Leaf type has no ID. Tree can't be rebuilt on load.
+				return false;
+			}
+
+			record.leafTypeId = found->second;
+		}
+	}
+
+	FileHeader header;
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.nodeCount = nodeCount;
+	header.childIndexCount = static_cast<int>(structure.childIndices.size());
+	header.errorPolicy = static_cast<int>(structure.errorPolicy);
+
+	FILE* file = std::fopen(filePath, "wb");
+	if (file == nullptr) return false;
+
+	bool success = std::fwrite(&header, sizeof(header), 1, file) == 1;
+	success = success && std::fwrite(records.data(), sizeof(SerializedNode), nodeCount, file) == static_cast<std::size_t>(nodeCount);
+
+	if (header.childIndexCount > 0)
+	{
+		success = success && std::fwrite(structure.childIndices.data(), sizeof(int), header.childIndexCount, file) == static_cast<std::size_t>(header.childIndexCount);
+	}
+
+	std::fclose(file);
+
+	return success;
+}
+
+std::unique_ptr<BehaviorTree::Tree> BehaviorTree::Serialization::buildTree(const FileHeader& header, const SerializedNode* nodeRecords, const int* childIndices)
+{
+	auto structure = std::make_shared<Tree::Structure>();
+
+	if (header.errorPolicy < static_cast<int>(ERROR_POLICY::IGNORE) || header.errorPolicy > static_cast<int>(ERROR_POLICY::TERMINATE))
+	{
+		// Unknown policy value. Reject rather than guess.
+		return nullptr;
+	}
+
+	structure->errorPolicy = static_cast<ERROR_POLICY>(header.errorPolicy);
+	structure->nodes.reserve(header.nodeCount);
+	structure->childIndices.assign(childIndices, childIndices + header.childIndexCount);
+
+	for (int i = 0; i < header.nodeCount; i++)
+	{
+		const SerializedNode& record = nodeRecords[i];
+
+		// Records are index based and trusted only after these checks.
+		if (record.type < static_cast<int>(NODE_TYPE::LEAF) || record.type > static_cast<int>(NODE_TYPE::TIME_LIMIT)) return nullptr;
+		if (record.childCount < 0) return nullptr;
+		if (record.childCount > 0 && (record.childStart < 0 || record.childStart + record.childCount > header.childIndexCount)) return nullptr;
+		if (record.parent < -1 || record.parent >= header.nodeCount) return nullptr;
+
+		Tree::BakedNode bakedNode;
+		bakedNode.type = static_cast<NODE_TYPE>(record.type);
+		bakedNode.node = nullptr;
+		bakedNode.childStart = record.childStart;
+		bakedNode.childCount = record.childCount;
+		bakedNode.parent = record.parent;
+		bakedNode.repeat = record.repeat;
+		bakedNode.duration = record.duration;
+		bakedNode.delayOnce = record.delayOnce != 0;
+		bakedNode.stateSlot = -1;
+		bakedNode.onCompositePath = record.onCompositePath != 0;
+
+		// State slots aren't stored; hand them out again, same rules as bake
+		switch (bakedNode.type)
+		{
+		case NODE_TYPE::SELECTOR:
+		case NODE_TYPE::RANDOM_SELECTOR:
+		case NODE_TYPE::SEQUENCE:
+		case NODE_TYPE::RANDOM_SEQUENCE:
+			bakedNode.stateSlot = structure->runningChildSlotCount++;
+			break;
+		case NODE_TYPE::LIMITER:
+			bakedNode.stateSlot = structure->counterSlotCount++;
+			break;
+		case NODE_TYPE::TIME_LIMIT:
+			bakedNode.stateSlot = structure->timerSlotCount++;
+			break;
+		case NODE_TYPE::DELAY_TIME:
+			bakedNode.stateSlot = structure->delaySlotCount++;
+			break;
+		default:
+			break;
+		}
+
+		if (bakedNode.type == NODE_TYPE::LEAF)
+		{
+			auto found = leafFactories().find(record.leafTypeId);
+			if (found == leafFactories().end())
+			{
+				// No factory for this leaf type in the loading build
+				return nullptr;
+			}
+
+			// The only per-node allocation on load. Goes through
+			// Node::operator new, so a bound NodePool catches it.
+			std::unique_ptr<Node> leaf = found->second();
+			bakedNode.node = leaf.get();
+			structure->loadedLeaves.push_back(std::move(leaf));
+		}
+
+		structure->nodes.push_back(bakedNode);
+	}
+
+	// Child indices must point at valid nodes
+	for (const int childIndex : structure->childIndices)
+	{
+		if (childIndex < 0 || childIndex >= header.nodeCount) return nullptr;
+	}
+
+	return std::unique_ptr<Tree>(new Tree(structure));
+}
+
+std::unique_ptr<BehaviorTree::Tree> BehaviorTree::Serialization::load(const char* filePath)
+{
+	if (filePath == nullptr) return nullptr;
+
+	std::unique_ptr<Tree> tree = nullptr;
+
+#if !defined(_WIN32)
+	// Map the file and consume header and records straight from the mapping
+	const int fd = ::open(filePath, O_RDONLY);
+	if (fd < 0) return nullptr;
+
+	struct stat fileStat;
+	if (::fstat(fd, &fileStat) != 0 || fileStat.st_size < static_cast<off_t>(sizeof(FileHeader)))
+	{
+		::close(fd);
+		return nullptr;
+	}
+
+	const std::size_t fileSize = static_cast<std::size_t>(fileStat.st_size);
+
+	void* mapping = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (mapping == MAP_FAILED) return nullptr;
+
+	const unsigned char* data = static_cast<const unsigned char*>(mapping);
+	const FileHeader& header = *reinterpret_cast<const FileHeader*>(data);
+
+	const std::size_t expectedSize = sizeof(FileHeader) + static_cast<std::size_t>(header.nodeCount) * sizeof(SerializedNode) + static_cast<std::size_t>(header.childIndexCount) * sizeof(int);
+
+	if (header.magic == MAGIC && header.version == VERSION && header.nodeCount > 0 && header.childIndexCount >= 0 && fileSize == expectedSize)
+	{
+		const SerializedNode* nodeRecords = reinterpret_cast<const SerializedNode*>(data + sizeof(FileHeader));
+		const int* childIndices = reinterpret_cast<const int*>(data + sizeof(FileHeader) + static_cast<std::size_t>(header.nodeCount) * sizeof(SerializedNode));
+
+		tree = buildTree(header, nodeRecords, childIndices);
+	}
+
+	::munmap(mapping, fileSize);
+#else
+	// No mmap here. Read the whole file in one go instead.
+	FILE* file = std::fopen(filePath, "rb");
+	if (file == nullptr) return nullptr;
+
+	std::fseek(file, 0, SEEK_END);
+	const long fileSize = std::ftell(file);
+	std::fseek(file, 0, SEEK_SET);
+
+	if (fileSize < static_cast<long>(sizeof(FileHeader)))
+	{
+		std::fclose(file);
+		return nullptr;
+	}
+
+	std::vector<unsigned char> buffer(fileSize);
+	const bool readAll = std::fread(buffer.data(), 1, fileSize, file) == static_cast<std::size_t>(fileSize);
+	std::fclose(file);
+	if (!readAll) return nullptr;
+
+	const unsigned char* data = buffer.data();
+	const FileHeader& header = *reinterpret_cast<const FileHeader*>(data);
+
+	const long expectedSize = static_cast<long>(sizeof(FileHeader) + static_cast<std::size_t>(header.nodeCount) * sizeof(SerializedNode) + static_cast<std::size_t>(header.childIndexCount) * sizeof(int));
+
+	if (header.magic == MAGIC && header.version == VERSION && header.nodeCount > 0 && header.childIndexCount >= 0 && fileSize == expectedSize)
+	{
+		const SerializedNode* nodeRecords = reinterpret_cast<const SerializedNode*>(data + sizeof(FileHeader));
+		const int* childIndices = reinterpret_cast<const int*>(data + sizeof(FileHeader) + static_cast<std::size_t>(header.nodeCount) * sizeof(SerializedNode));
+
+		tree = buildTree(header, nodeRecords, childIndices);
+	}
+#endif
+
+	return tree;
+}
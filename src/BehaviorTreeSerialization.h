@@ -0,0 +1,182 @@
+///////////////////////////////////////////////////////////////////////
+// Behavior Tree
+// Copyright (c) 2017 Seung Youp Baek <bsy6766@gmail.com>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any
+// damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any
+// purpose, including commercial applications, and to alter it and
+// redistribute it freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you
+//     must not claim that you wrote the original software. If you use
+//     this software in a product, an acknowledgment in the product
+//     documentation would be appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and
+//     must not be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source
+//     distribution.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef BEHAVIOR_TREE_SERIALIZATION_H
+#define BEHAVIOR_TREE_SERIALIZATION_H
+
+#include "BehaviorTree.h"
+
+#include <typeindex>
+#include <unordered_map>
+
+namespace BehaviorTree
+{
+	/**
+	*	@class Serialization
+	*	@brief Saves and loads baked Trees as a compact binary file.
+	*
+	*	@details Building hundreds of tree archetypes in code at process start
+	*	costs one heap allocation and one bake per node. Serialization writes
+	*	a baked Tree out once (offline or on first run) as fixed-size records:
+	*	node type tags, child index slices and decorator parameters like
+	*	Repeat's repeat count or DelayTime's duration. Loading memory-maps the
+	*	file and consumes the records straight from the mapping; the layout is
+	*	index based, so there is nothing to parse and no pointer fix-up pass.
+	*	Composites and decorators are interpreted from the records and need no
+	*	node objects at all. Only LEAF nodes (user's action and condition
+	*	classes) are created on load, through a type-ID-to-factory table that
+	*	the user registers before saving and loading. @see registerLeaf
+	*	Factories allocate through Node::operator new, so loading in to a
+	*	bound NodePool keeps the global heap untouched. @see NodePool
+	*	@note Type IDs are the user's contract between the saving and loading
+	*	build; keep them stable. The file stores native endian, native int.
+	*/
+	class Serialization
+	{
+	public:
+		//Creates a leaf node of one registered type.
+		using LeafFactory = std::unique_ptr<Node>(*)();
+	private:
+		//Serialization only has static functions.
+		Serialization() = delete;
+
+		/**
+		*	@struct FileHeader
+		*	@brief Fixed header at the start of a tree file.
+		*/
+		struct FileHeader
+		{
+			//File magic. 'BTRE'.
+			unsigned int magic;
+
+			//Format version. Bumped when the record layout changes.
+			unsigned int version;
+
+			//Number of node records following the header.
+			int nodeCount;
+
+			//Number of child indices following the node records.
+			int childIndexCount;
+
+			//ERROR_POLICY of the tree as int. Per tree, so it lives here.
+			int errorPolicy;
+		};
+
+		/**
+		*	@struct SerializedNode
+		*	@brief One baked node as stored in file. Plain ints and floats
+		*	only, so records are read in place from the mapping.
+		*/
+		struct SerializedNode
+		{
+			//NODE_TYPE as int.
+			int type;
+
+			//Registered type ID for LEAF nodes. -1 otherwise.
+			int leafTypeId;
+
+			//Index in to the child index array. -1 if no children.
+			int childStart;
+
+			//Number of children.
+			int childCount;
+
+			//Flat index of parent node. -1 for root.
+			int parent;
+
+			//Baked decorator parameters.
+			int repeat;
+			float duration;
+			int delayOnce;
+
+			//True if every ancestor is a composite. @see Tree::BakedNode
+			int onCompositePath;
+		};
+
+		//File magic. 'BTRE'.
+		static const unsigned int MAGIC = 0x42545245;
+
+		//Current format version. 2 added the error policy to the header.
+		static const unsigned int VERSION = 2;
+
+		/**
+		*	@name buildTree
+		*	@brief Rebuild a Tree from records already validated in memory.
+		*
+		*	@param header File header.
+		*	@param nodes Node records. header.nodeCount of them.
+		*	@param childIndices Child index array. header.childIndexCount of them.
+		*	@return Loaded tree. nullptr if a record is malformed or a leaf
+		*	type ID has no registered factory.
+		*/
+		static std::unique_ptr<Tree> buildTree(const FileHeader& header, const SerializedNode* nodes, const int* childIndices);
+	public:
+		/**
+		*	@name registerLeaf
+		*	@brief Register a factory for one leaf node type.
+		*	@note Register the same IDs in the saving and the loading build.
+		*
+		*	@param typeId User chosen ID. Must be unique and stable.
+		*	@param factory Creates one node of the type.
+		*	@param typeInfo typeid of the type. Used to find the ID on save.
+		*/
+		static void registerLeaf(const int typeId, LeafFactory factory, const std::type_info& typeInfo);
+
+		/**
+		*	@name registerLeaf
+		*	@brief Register leaf type T with its default constructor.
+		*
+		*	@param typeId User chosen ID. Must be unique and stable.
+		*/
+		template<class T>
+		static void registerLeaf(const int typeId)
+		{
+			registerLeaf(typeId, []() -> std::unique_ptr<Node> { return std::unique_ptr<Node>(new T()); }, typeid(T));
+		}
+
+		/**
+		*	@name save
+		*	@brief Write a baked tree to file.
+		*
+		*	@param tree Tree to write.
+		*	@param filePath Path of file to write.
+		*	@return True on success. False if the file can't be written or the
+		*	tree contains a leaf type that isn't registered.
+		*/
+		static const bool save(Tree& tree, const char* filePath);
+
+		/**
+		*	@name load
+		*	@brief Load a tree from file written by save.
+		*
+		*	@param filePath Path of file to read.
+		*	@return Loaded tree. nullptr if the file is missing, malformed, of
+		*	a different version, or references an unregistered leaf type.
+		*/
+		static std::unique_ptr<Tree> load(const char* filePath);
+	};
+}
+
+#endif
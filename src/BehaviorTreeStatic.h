@@ -0,0 +1,540 @@
+///////////////////////////////////////////////////////////////////////
+// Behavior Tree
+// Copyright (c) 2017 Seung Youp Baek <bsy6766@gmail.com>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any
+// damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any
+// purpose, including commercial applications, and to alter it and
+// redistribute it freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you
+//     must not claim that you wrote the original software. If you use
+//     this software in a product, an acknowledgment in the product
+//     documentation would be appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and
+//     must not be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source
+//     distribution.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef BEHAVIOR_TREE_STATIC_H
+#define BEHAVIOR_TREE_STATIC_H
+
+#include "BehaviorTree.h"
+
+#include <tuple>
+#include <type_traits>
+
+/**
+*	Compile-time tree construction.
+*
+*	For tree shapes that are fixed at compile time, the static node templates
+*	below build the whole tree as one value type — e.g.
+*	StaticSequence<Cond, StaticSelector<A, B>> — and update runs with no
+*	virtual calls and no vector storage; the compiler sees every child type
+*	and inlines the walk. Children are held by value inside the composite,
+*	so the whole tree is one contiguous object.
+*
+*	A static node is any type with
+*	    const NODE_STATE update(const float delta)
+*	and optionally void reset(). User action and condition structs plug in
+*	directly; they must be default constructible.
+*
+*	StaticNodeAdapter wraps any static tree as a regular Node, so a hot
+*	static subtree can sit inside a normal runtime tree as a leaf.
+*/
+namespace BehaviorTree
+{
+	namespace StaticDetail
+	{
+		//Detects whether T has a reset() to call.
+		template<class T>
+		struct HasReset
+		{
+			template<class U> static auto test(int) -> decltype(std::declval<U&>().reset(), std::true_type());
+			template<class U> static std::false_type test(...);
+
+			static const bool value = decltype(test<T>(0))::value;
+		};
+
+		template<class T>
+		typename std::enable_if<HasReset<T>::value>::type resetNode(T& node)
+		{
+			node.reset();
+		}
+
+		template<class T>
+		typename std::enable_if<!HasReset<T>::value>::type resetNode(T& node)
+		{
+			//Node keeps no state to reset
+		}
+
+		//Detects whether T has a setErrorPolicy(ERROR_POLICY) to call.
+		template<class T>
+		struct HasSetErrorPolicy
+		{
+			template<class U> static auto test(int) -> decltype(std::declval<U&>().setErrorPolicy(ERROR_POLICY::IGNORE), std::true_type());
+			template<class U> static std::false_type test(...);
+
+			static const bool value = decltype(test<T>(0))::value;
+		};
+
+		template<class T>
+		typename std::enable_if<HasSetErrorPolicy<T>::value>::type setNodeErrorPolicy(T& node, const ERROR_POLICY errorPolicy)
+		{
+			node.setErrorPolicy(errorPolicy);
+		}
+
+		template<class T>
+		typename std::enable_if<!HasSetErrorPolicy<T>::value>::type setNodeErrorPolicy(T& node, const ERROR_POLICY errorPolicy)
+		{
+			//Node doesn't route errors
+		}
+	}
+
+	/**
+	*	@class StaticSelector
+	*	@brief Compile-time Selector. Updates children left to right until
+	*	one succeeds or runs. A RUNNING child is resumed on the next update,
+	*	and on its FAILURE the walk continues with the next sibling, same as
+	*	Selector. @see Selector
+	*/
+	template<class... Children>
+	class StaticSelector
+	{
+	private:
+		//Children by value. No vector, no pointers.
+		std::tuple<Children...> children;
+
+		//Index of child that is running. NO_RUNNING_CHILD if none running.
+		int runningChildIndex;
+
+		//How this composite handles a child's ERROR. @see ERROR_POLICY
+		ERROR_POLICY errorPolicy;
+
+		//Past the last child without success. Selector fails.
+		template<std::size_t I>
+		typename std::enable_if<I == sizeof...(Children), const NODE_STATE>::type updateFrom(const float delta)
+		{
+			return NODE_STATE::FAILURE;
+		}
+
+		template<std::size_t I>
+		typename std::enable_if<I < sizeof...(Children), const NODE_STATE>::type updateFrom(const float delta)
+		{
+			const NODE_STATE state = std::get<I>(this->children).update(delta);
+
+			if (state == NODE_STATE::SUCCESS)
+			{
+				return state;
+			}
+			else if (state == NODE_STATE::RUNNING)
+			{
+				this->runningChildIndex = static_cast<int>(I);
+				return state;
+			}
+			else if (state == NODE_STATE::ERROR && this->errorPolicy == ERROR_POLICY::TERMINATE)
+			{
+				return NODE_STATE::ERROR;
+			}
+
+			// FAILURE or ignored ERROR. Try next child.
+			return this->updateFrom<I + 1>(delta);
+		}
+
+		//Find the running child by runtime index and continue there.
+		template<std::size_t I>
+		typename std::enable_if<I == sizeof...(Children), const NODE_STATE>::type resumeAt(const int index, const float delta)
+		{
+			return NODE_STATE::FAILURE;
+		}
+
+		template<std::size_t I>
+		typename std::enable_if<I < sizeof...(Children), const NODE_STATE>::type resumeAt(const int index, const float delta)
+		{
+			if (static_cast<int>(I) == index)
+			{
+				return this->updateFrom<I>(delta);
+			}
+
+			return this->resumeAt<I + 1>(index, delta);
+		}
+
+		template<std::size_t I>
+		typename std::enable_if<I == sizeof...(Children)>::type resetFrom() {}
+
+		template<std::size_t I>
+		typename std::enable_if<I < sizeof...(Children)>::type resetFrom()
+		{
+			StaticDetail::resetNode(std::get<I>(this->children));
+			this->resetFrom<I + 1>();
+		}
+
+		template<std::size_t I>
+		typename std::enable_if<I == sizeof...(Children)>::type setErrorPolicyFrom(const ERROR_POLICY errorPolicy) {}
+
+		template<std::size_t I>
+		typename std::enable_if<I < sizeof...(Children)>::type setErrorPolicyFrom(const ERROR_POLICY errorPolicy)
+		{
+			StaticDetail::setNodeErrorPolicy(std::get<I>(this->children), errorPolicy);
+			this->setErrorPolicyFrom<I + 1>(errorPolicy);
+		}
+	public:
+		StaticSelector() : runningChildIndex(NO_RUNNING_CHILD), errorPolicy(ERROR_POLICY::IGNORE) {}
+
+		// @copydoc Node::update(const float delta = 0)
+		const NODE_STATE update(const float delta = 0)
+		{
+			static_assert(sizeof...(Children) > 0, "StaticSelector needs at least one child");
+
+			int start = this->runningChildIndex;
+			this->runningChildIndex = NO_RUNNING_CHILD;
+
+			if (start != NO_RUNNING_CHILD)
+			{
+				// Resume the running child. On its failure the walk already
+				// continues with the next sibling inside updateFrom.
+				return this->resumeAt<0>(start, delta);
+			}
+
+			return this->updateFrom<0>(delta);
+		}
+
+		// @copydoc Node::reset()
+		void reset()
+		{
+			this->runningChildIndex = NO_RUNNING_CHILD;
+			this->resetFrom<0>();
+		}
+
+		/**
+		*	@name setErrorPolicy
+		*	@brief Set how this composite and everything below it handle
+		*	ERROR. Defaults to ERROR_POLICY::IGNORE. @see ERROR_POLICY
+		*/
+		void setErrorPolicy(const ERROR_POLICY errorPolicy)
+		{
+			this->errorPolicy = errorPolicy;
+			this->setErrorPolicyFrom<0>(errorPolicy);
+		}
+
+
+		/**
+		*	@name childAt
+		*	@brief Get child at compile-time position I by reference.
+		*/
+		template<std::size_t I>
+		typename std::tuple_element<I, std::tuple<Children...>>::type& childAt()
+		{
+			return std::get<I>(this->children);
+		}
+	};
+
+	/**
+	*	@class StaticSequence
+	*	@brief Compile-time Sequence. Updates children left to right until
+	*	one fails or runs. A RUNNING child is resumed on the next update and
+	*	on its SUCCESS the walk continues with the next sibling. @see Sequence
+	*/
+	template<class... Children>
+	class StaticSequence
+	{
+	private:
+		//Children by value. No vector, no pointers.
+		std::tuple<Children...> children;
+
+		//Index of child that is running. NO_RUNNING_CHILD if none running.
+		int runningChildIndex;
+
+		//How this composite handles a child's ERROR. @see ERROR_POLICY
+		ERROR_POLICY errorPolicy;
+
+		//Past the last child without failure. Sequence succeeds.
+		template<std::size_t I>
+		typename std::enable_if<I == sizeof...(Children), const NODE_STATE>::type updateFrom(const float delta)
+		{
+			return NODE_STATE::SUCCESS;
+		}
+
+		template<std::size_t I>
+		typename std::enable_if<I < sizeof...(Children), const NODE_STATE>::type updateFrom(const float delta)
+		{
+			const NODE_STATE state = std::get<I>(this->children).update(delta);
+
+			if (state == NODE_STATE::FAILURE)
+			{
+				return state;
+			}
+			else if (state == NODE_STATE::RUNNING)
+			{
+				this->runningChildIndex = static_cast<int>(I);
+				return state;
+			}
+			else if (state == NODE_STATE::ERROR && this->errorPolicy == ERROR_POLICY::TERMINATE)
+			{
+				return NODE_STATE::ERROR;
+			}
+
+			// SUCCESS or ignored ERROR. Continue with next child.
+			return this->updateFrom<I + 1>(delta);
+		}
+
+		template<std::size_t I>
+		typename std::enable_if<I == sizeof...(Children), const NODE_STATE>::type resumeAt(const int index, const float delta)
+		{
+			return NODE_STATE::SUCCESS;
+		}
+
+		template<std::size_t I>
+		typename std::enable_if<I < sizeof...(Children), const NODE_STATE>::type resumeAt(const int index, const float delta)
+		{
+			if (static_cast<int>(I) == index)
+			{
+				return this->updateFrom<I>(delta);
+			}
+
+			return this->resumeAt<I + 1>(index, delta);
+		}
+
+		template<std::size_t I>
+		typename std::enable_if<I == sizeof...(Children)>::type resetFrom() {}
+
+		template<std::size_t I>
+		typename std::enable_if<I < sizeof...(Children)>::type resetFrom()
+		{
+			StaticDetail::resetNode(std::get<I>(this->children));
+			this->resetFrom<I + 1>();
+		}
+
+		template<std::size_t I>
+		typename std::enable_if<I == sizeof...(Children)>::type setErrorPolicyFrom(const ERROR_POLICY errorPolicy) {}
+
+		template<std::size_t I>
+		typename std::enable_if<I < sizeof...(Children)>::type setErrorPolicyFrom(const ERROR_POLICY errorPolicy)
+		{
+			StaticDetail::setNodeErrorPolicy(std::get<I>(this->children), errorPolicy);
+			this->setErrorPolicyFrom<I + 1>(errorPolicy);
+		}
+	public:
+		StaticSequence() : runningChildIndex(NO_RUNNING_CHILD), errorPolicy(ERROR_POLICY::IGNORE) {}
+
+		// @copydoc Node::update(const float delta = 0)
+		const NODE_STATE update(const float delta = 0)
+		{
+			static_assert(sizeof...(Children) > 0, "StaticSequence needs at least one child");
+
+			int start = this->runningChildIndex;
+			this->runningChildIndex = NO_RUNNING_CHILD;
+
+			if (start != NO_RUNNING_CHILD)
+			{
+				return this->resumeAt<0>(start, delta);
+			}
+
+			return this->updateFrom<0>(delta);
+		}
+
+		// @copydoc Node::reset()
+		void reset()
+		{
+			this->runningChildIndex = NO_RUNNING_CHILD;
+			this->resetFrom<0>();
+		}
+
+		/**
+		*	@name setErrorPolicy
+		*	@brief Set how this composite and everything below it handle
+		*	ERROR. Defaults to ERROR_POLICY::IGNORE. @see ERROR_POLICY
+		*/
+		void setErrorPolicy(const ERROR_POLICY errorPolicy)
+		{
+			this->errorPolicy = errorPolicy;
+			this->setErrorPolicyFrom<0>(errorPolicy);
+		}
+
+
+		/**
+		*	@name childAt
+		*	@brief Get child at compile-time position I by reference.
+		*/
+		template<std::size_t I>
+		typename std::tuple_element<I, std::tuple<Children...>>::type& childAt()
+		{
+			return std::get<I>(this->children);
+		}
+	};
+
+	/**
+	*	@class StaticInverter
+	*	@brief Compile-time Inverter. Flips SUCCESS and FAILURE. @see Inverter
+	*/
+	template<class Child>
+	class StaticInverter
+	{
+	private:
+		Child child;
+	public:
+		// @copydoc Node::update(const float delta = 0)
+		const NODE_STATE update(const float delta = 0)
+		{
+			const NODE_STATE state = this->child.update(delta);
+
+			if (state == NODE_STATE::SUCCESS)
+			{
+				return NODE_STATE::FAILURE;
+			}
+			else if (state == NODE_STATE::FAILURE)
+			{
+				return NODE_STATE::SUCCESS;
+			}
+
+			return state;
+		}
+
+		// @copydoc Node::reset()
+		void reset()
+		{
+			StaticDetail::resetNode(this->child);
+		}
+
+		//Get the wrapped child by reference.
+		Child& getChild() { return this->child; }
+	};
+
+	/**
+	*	@class StaticSucceeder
+	*	@brief Compile-time Succeeder. Always reports SUCCESS. @see Succeeder
+	*/
+	template<class Child>
+	class StaticSucceeder
+	{
+	private:
+		Child child;
+	public:
+		// @copydoc Node::update(const float delta = 0)
+		const NODE_STATE update(const float delta = 0)
+		{
+			this->child.update(delta);
+			return NODE_STATE::SUCCESS;
+		}
+
+		// @copydoc Node::reset()
+		void reset()
+		{
+			StaticDetail::resetNode(this->child);
+		}
+
+		//Get the wrapped child by reference.
+		Child& getChild() { return this->child; }
+	};
+
+	/**
+	*	@class StaticFailer
+	*	@brief Compile-time Failer. Always reports FAILURE. @see Failer
+	*/
+	template<class Child>
+	class StaticFailer
+	{
+	private:
+		Child child;
+	public:
+		// @copydoc Node::update(const float delta = 0)
+		const NODE_STATE update(const float delta = 0)
+		{
+			this->child.update(delta);
+			return NODE_STATE::FAILURE;
+		}
+
+		// @copydoc Node::reset()
+		void reset()
+		{
+			StaticDetail::resetNode(this->child);
+		}
+
+		//Get the wrapped child by reference.
+		Child& getChild() { return this->child; }
+	};
+
+	/**
+	*	@class StaticRepeater
+	*	@brief Compile-time Repeater. Updates the child RepeatCount times per
+	*	update, stopping early on RUNNING or ERROR. @see Repeater
+	*/
+	template<class Child, int RepeatCount>
+	class StaticRepeater
+	{
+	private:
+		Child child;
+	public:
+		// @copydoc Node::update(const float delta = 0)
+		const NODE_STATE update(const float delta = 0)
+		{
+			static_assert(RepeatCount > 0, "StaticRepeater needs a positive repeat count");
+
+			for (int i = 0; i < RepeatCount; i++)
+			{
+				const NODE_STATE state = this->child.update(delta);
+
+				if (state != NODE_STATE::SUCCESS && state != NODE_STATE::FAILURE)
+				{
+					// RUNNING or ERROR stops the repeat, same as Repeater
+					return state;
+				}
+			}
+
+			return NODE_STATE::SUCCESS;
+		}
+
+		// @copydoc Node::reset()
+		void reset()
+		{
+			StaticDetail::resetNode(this->child);
+		}
+
+		//Get the wrapped child by reference.
+		Child& getChild() { return this->child; }
+	};
+
+	/**
+	*	@class StaticNodeAdapter
+	*	@brief Wraps a static tree as a regular Node.
+	*
+	*	@details The adapter is the interop point between the two worlds: a
+	*	hot static subtree sits inside a runtime CompositeNode as one leaf,
+	*	paying a single virtual call for the whole inlined subtree.
+	*/
+	template<class StaticTree>
+	class StaticNodeAdapter : public Node
+	{
+	private:
+		//The whole static tree by value.
+		StaticTree tree;
+	public:
+		StaticNodeAdapter() = default;
+
+		virtual ~StaticNodeAdapter() = default;
+
+		// @copydoc Node::update(const float delta = 0)
+		virtual const NODE_STATE update(const float delta = 0) override
+		{
+			return this->tree.update(delta);
+		}
+
+		// @copydoc Node::reset()
+		virtual void reset() override
+		{
+			StaticDetail::resetNode(this->tree);
+		}
+
+		//Get the wrapped static tree by reference.
+		StaticTree& getTree() { return this->tree; }
+	};
+}
+
+#endif
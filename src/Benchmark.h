@@ -0,0 +1,268 @@
+///////////////////////////////////////////////////////////////////////
+// Behavior Tree
+// Copyright (c) 2017 Seung Youp Baek <bsy6766@gmail.com>
+//
+// This software is provided 'as-is', without any express or implied
+// warranty. In no event will the authors be held liable for any
+// damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any
+// purpose, including commercial applications, and to alter it and
+// redistribute it freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you
+//     must not claim that you wrote the original software. If you use
+//     this software in a product, an acknowledgment in the product
+//     documentation would be appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and
+//     must not be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source
+//     distribution.
+//
+///////////////////////////////////////////////////////////////////////
+
+// Tick throughput benchmark for the behavior tree hot path.
+//
+// Like UnitTest.h, this header is the whole program body: include it in the
+// main translation unit of a benchmark executable and call
+// BehaviorTreeBenchmark::runAll() from main. Every scenario is ticked both
+// through the node graph (virtual dispatch) and through a baked Tree, and
+// reported as ticks/second plus bytes allocated per tick, so hot path
+// regressions show up as a drop between two builds.
+//
+// Global operator new/delete are replaced below to count allocations, so
+// don't include this header anywhere else.
+
+#ifndef BEHAVIOR_TREE_BENCHMARK_H
+#define BEHAVIOR_TREE_BENCHMARK_H
+
+#include "../src/BehaviorTree.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// ====================================== ALLOCATION COUNTER ======================================
+// Counts every global heap allocation made while a scenario ticks.
+
+static std::size_t g_allocatedBytes = 0;
+static std::size_t g_allocationCount = 0;
+
+void* operator new(std::size_t size)
+{
+	g_allocatedBytes += size;
+	g_allocationCount++;
+
+	void* memory = std::malloc(size);
+	if (memory == nullptr) throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+	g_allocatedBytes += size;
+	g_allocationCount++;
+
+	void* memory = std::malloc(size);
+	if (memory == nullptr) throw std::bad_alloc();
+	return memory;
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+// ================================================================================================
+
+namespace BehaviorTreeBenchmark
+{
+	// A leaf that always succeeds. Cheapest possible action node.
+	class BenchSuccessNode : public BehaviorTree::Node
+	{
+	public:
+		virtual const BehaviorTree::NODE_STATE update(const float delta = 0) override
+		{
+			return BehaviorTree::NODE_STATE::SUCCESS;
+		}
+	};
+
+	// A leaf that always fails. Forces composites to scan every child.
+	class BenchFailureNode : public BehaviorTree::Node
+	{
+	public:
+		virtual const BehaviorTree::NODE_STATE update(const float delta = 0) override
+		{
+			return BehaviorTree::NODE_STATE::FAILURE;
+		}
+	};
+
+	// A leaf that stays RUNNING. Exercises updateRunningChild on the node
+	// graph and the running-path resume on the baked Tree.
+	class BenchRunningNode : public BehaviorTree::Node
+	{
+	public:
+		virtual const BehaviorTree::NODE_STATE update(const float delta = 0) override
+		{
+			return BehaviorTree::NODE_STATE::RUNNING;
+		}
+	};
+
+	/**
+	*	@name measure
+	*	@brief Tick the given callable repeatedly and report throughput.
+	*
+	*	@param name Scenario name for the report.
+	*	@param tickCount Number of measured ticks.
+	*	@param tick Callable that performs one tick.
+	*/
+	template<class F>
+	void measure(const char* name, const int tickCount, F tick)
+	{
+		// Warm caches and let first-tick setup (shuffle buffers, resizes)
+		// happen outside the measured window.
+		for (int i = 0; i < 1000; i++)
+		{
+			tick();
+		}
+
+		const std::size_t bytesBefore = g_allocatedBytes;
+		const std::size_t allocationsBefore = g_allocationCount;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < tickCount; i++)
+		{
+			tick();
+		}
+
+		const auto end = std::chrono::steady_clock::now();
+
+		const double seconds = std::chrono::duration<double>(end - start).count();
+		const double ticksPerSecond = (seconds > 0.0) ? (tickCount / seconds) : 0.0;
+		const double bytesPerTick = static_cast<double>(g_allocatedBytes - bytesBefore) / tickCount;
+		const double allocationsPerTick = static_cast<double>(g_allocationCount - allocationsBefore) / tickCount;
+
+		std::printf("%-44s %14.0f ticks/s %10.1f B/tick %8.3f allocs/tick\n", name, ticksPerSecond, bytesPerTick, allocationsPerTick);
+	}
+
+	/**
+	*	@name buildDeepSequence
+	*	@brief Sequences nested depth levels deep, one success leaf inside.
+	*/
+	inline std::unique_ptr<BehaviorTree::Node> buildDeepSequence(const int depth)
+	{
+		std::unique_ptr<BehaviorTree::Node> node(new BenchSuccessNode());
+
+		for (int i = 0; i < depth; i++)
+		{
+			node = std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Sequence(std::move(node)));
+		}
+
+		return node;
+	}
+
+	/**
+	*	@name buildWideSelector
+	*	@brief Selector with width - 1 failing children and one success at
+	*	the end, so every tick scans the whole width.
+	*/
+	inline std::unique_ptr<BehaviorTree::Node> buildWideSelector(const int width)
+	{
+		std::unique_ptr<BehaviorTree::Selector> selector(new BehaviorTree::Selector(nullptr));
+
+		for (int i = 0; i < width - 1; i++)
+		{
+			selector->addChild(std::unique_ptr<BehaviorTree::Node>(new BenchFailureNode()));
+		}
+		selector->addChild(std::unique_ptr<BehaviorTree::Node>(new BenchSuccessNode()));
+
+		return std::unique_ptr<BehaviorTree::Node>(selector.release());
+	}
+
+	/**
+	*	@name buildRandomSelectorFanOut
+	*	@brief RandomSelector over width failing children. Every tick
+	*	reshuffles the update order and scans the whole fan-out.
+	*/
+	inline std::unique_ptr<BehaviorTree::Node> buildRandomSelectorFanOut(const int width)
+	{
+		std::unique_ptr<BehaviorTree::RandomSelector> randomSelector(new BehaviorTree::RandomSelector(nullptr));
+
+		for (int i = 0; i < width; i++)
+		{
+			randomSelector->addChild(std::unique_ptr<BehaviorTree::Node>(new BenchFailureNode()));
+		}
+
+		return std::unique_ptr<BehaviorTree::Node>(randomSelector.release());
+	}
+
+	/**
+	*	@name buildLongRunning
+	*	@brief RUNNING leaf several composites deep. Ticks after the first
+	*	one go through the running child path every time.
+	*/
+	inline std::unique_ptr<BehaviorTree::Node> buildLongRunning(const int depth)
+	{
+		std::unique_ptr<BehaviorTree::Node> node(new BenchRunningNode());
+
+		for (int i = 0; i < depth; i++)
+		{
+			node = std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Sequence(std::move(node)));
+		}
+
+		std::unique_ptr<BehaviorTree::Sequence> root(new BehaviorTree::Sequence(nullptr));
+		root->addChild(std::unique_ptr<BehaviorTree::Node>(new BenchSuccessNode()));
+		root->addChild(std::move(node));
+
+		return std::unique_ptr<BehaviorTree::Node>(root.release());
+	}
+
+	/**
+	*	@name runScenario
+	*	@brief Run one tree shape through the node graph and the baked Tree.
+	*
+	*	@param name Scenario name for the report.
+	*	@param graph Node graph for the scenario. Consumed.
+	*	@param tickCount Number of measured ticks per variant.
+	*/
+	inline void runScenario(const char* name, std::unique_ptr<BehaviorTree::Node> graph, const int tickCount)
+	{
+		// The graph is ticked directly first, then handed to Tree, so both
+		// variants run the exact same shape.
+		BehaviorTree::Node* rawGraph = graph.get();
+
+		char label[128];
+
+		std::snprintf(label, sizeof(label), "%s (node graph)", name);
+		measure(label, tickCount, [rawGraph]() { rawGraph->update(0.016f); });
+
+		BehaviorTree::Tree tree(std::move(graph));
+
+		std::snprintf(label, sizeof(label), "%s (baked tree)", name);
+		measure(label, tickCount, [&tree]() { tree.update(0.016f); });
+	}
+
+	/**
+	*	@name runAll
+	*	@brief Run every scenario and print the report. Call from main.
+	*/
+	inline void runAll()
+	{
+		const int tickCount = 2000000;
+
+		std::printf("%-44s %22s %17s %18s\n", "scenario", "throughput", "heap bytes", "heap allocations");
+
+		runScenario("deep sequence, depth 8", buildDeepSequence(8), tickCount);
+		runScenario("deep sequence, depth 64", buildDeepSequence(64), tickCount / 8);
+		runScenario("wide selector, width 8", buildWideSelector(8), tickCount);
+		runScenario("wide selector, width 64", buildWideSelector(64), tickCount / 8);
+		runScenario("random selector fan-out, width 8", buildRandomSelectorFanOut(8), tickCount);
+		runScenario("random selector fan-out, width 64", buildRandomSelectorFanOut(64), tickCount / 8);
+		runScenario("long RUNNING leaf, depth 8", buildLongRunning(8), tickCount);
+		runScenario("long RUNNING leaf, depth 64", buildLongRunning(64), tickCount / 8);
+	}
+}
+
+#endif
@@ -1,6 +1,9 @@
 #include <gtest\gtest.h>
 #include <string>
+#include <cstdio>
+#include <cstring>
 #include "../src/BehaviorTree.h"
+#include "../src/BehaviorTreeSerialization.h"
 
 // A sample node that returns SUCCESS state and does nothing.
 class SuccessNode : public BehaviorTree::Node
@@ -625,16 +628,15 @@ TEST(SELECTOR_TEST, NESTED_SELECTOR)
 	rootSelector->addChild(std::unique_ptr<BehaviorTree::Selector>(nestedSelector));
 	ASSERT_EQ(rootSelector->getChildren().size(), 2);
 
-	// It will pass first node(Failure) and run selector
+	// It will pass first node(Failure) and run selector. Empty nested
+	// selector errors; default policy ignores it, so the root fails.
 	BehaviorTree::NODE_STATE state = rootSelector->update(0);
-	if (BehaviorTree::IGNORE_ERROR)
-	{
-		ASSERT_EQ(state, BehaviorTree::NODE_STATE::FAILURE);
-	}
-	else
-	{
-		ASSERT_EQ(state, BehaviorTree::NODE_STATE::ERROR);
-	}
+	ASSERT_EQ(state, BehaviorTree::NODE_STATE::FAILURE);
+
+	// With TERMINATE the same error stops the update
+	rootSelector->setErrorPolicy(BehaviorTree::ERROR_POLICY::TERMINATE);
+	state = rootSelector->update(0);
+	ASSERT_EQ(state, BehaviorTree::NODE_STATE::ERROR);
 
 	delete rootSelector;
 }
@@ -743,32 +745,2467 @@ TEST(RANDOM_SELECTOR_TEST, SHUFFLE_CHILDREN)
 
 	const std::vector<std::unique_ptr<BehaviorTree::Node>>& children = randomSelector->getChildren();
 
+	// Children unique_ptrs never move. Shuffle only permutes the update order.
 	int count = 0;
-	int misMatchCount = 0;
+	for (auto& child : children)
+	{
+		ASSERT_EQ(dynamic_cast<SuccessNode*>(child.get())->tag, std::to_string(count));
+		count++;
+	}
 
-	std::cout << "Random Selector shuffled children." << std::endl;
-	std::cout << "Before shuffle: ";
+	// Update order must be a permutation of [0, 20)
+	const std::vector<int>& updateOrder = randomSelector->getUpdateOrder();
+	ASSERT_EQ(updateOrder.size(), 20);
 
-	for (int i = 0; i < 20; i++)
+	std::vector<bool> visited(20, false);
+
+	std::cout << "Random Selector shuffled update order: ";
+	for (int index : updateOrder)
 	{
-		std::cout << i << " ";
+		std::cout << index << " ";
+		ASSERT_GE(index, 0);
+		ASSERT_LT(index, 20);
+		ASSERT_FALSE(visited.at(index));
+		visited.at(index) = true;
 	}
-
 	std::cout << std::endl;
-	std::cout << "After shuffle:  ";
 
-	for (auto& child : children)
+	delete randomSelector;
+}
+//=====================================================================================================
+
+//========================================== BAKED TREE TEST ==========================================
+// Bakes node graph in to Tree and checks flat update returns same result as node graph.
+TEST(BAKED_TREE_TEST, NODE_COUNT)
+{
+	std::unique_ptr<BehaviorTree::Sequence> sequence(new BehaviorTree::Sequence(nullptr));
+	sequence->addChild(std::move(create<SuccessNode>()));
+
+	std::unique_ptr<BehaviorTree::Selector> selector(new BehaviorTree::Selector(nullptr));
+	selector->addChild(std::move(create<FailureNode>()));
+	selector->addChild(std::move(create<SuccessNode>()));
+	sequence->addChild(std::move(selector));
+
+	BehaviorTree::Tree tree(std::move(sequence));
+	// sequence + success + selector + failure + success
+	ASSERT_EQ(tree.getNodeCount(), 5);
+}
+
+TEST(BAKED_TREE_TEST, NULLPTR_ROOT)
+{
+	BehaviorTree::Tree tree(std::unique_ptr<BehaviorTree::Node>(nullptr));
+	ASSERT_EQ(tree.getNodeCount(), 0);
+
+	const BehaviorTree::NODE_STATE state = tree.update(0.0f);
+	ASSERT_EQ(state, BehaviorTree::NODE_STATE::ERROR);
+}
+
+TEST(BAKED_TREE_TEST, SELECTOR_RESULT)
+{
+	std::unique_ptr<BehaviorTree::Selector> selector(new BehaviorTree::Selector(nullptr));
+	selector->addChild(std::move(create<FailureNode>()));
+	selector->addChild(std::move(create<SuccessNode>()));
+
+	BehaviorTree::Tree tree(std::move(selector));
+
+	const BehaviorTree::NODE_STATE state = tree.update(0.0f);
+	ASSERT_EQ(state, BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+TEST(BAKED_TREE_TEST, SEQUENCE_RESULT)
+{
+	std::unique_ptr<BehaviorTree::Sequence> sequence(new BehaviorTree::Sequence(nullptr));
+	sequence->addChild(std::move(create<SuccessNode>()));
+	sequence->addChild(std::move(create<FailureNode>()));
+
+	BehaviorTree::Tree tree(std::move(sequence));
+
+	const BehaviorTree::NODE_STATE state = tree.update(0.0f);
+	ASSERT_EQ(state, BehaviorTree::NODE_STATE::FAILURE);
+}
+
+TEST(BAKED_TREE_TEST, RUNNING_RESUME)
+{
+	std::unique_ptr<BehaviorTree::Selector> selector(new BehaviorTree::Selector(nullptr));
+	selector->addChild(std::move(create<FailureNode>()));
+	selector->addChild(std::unique_ptr<BehaviorTree::Node>(new RunningNode(3.0f)));
+
+	BehaviorTree::Tree tree(std::move(selector));
+
+	BehaviorTree::NODE_STATE state;
+	state = tree.update(1.0f);
+	ASSERT_EQ(state, BehaviorTree::NODE_STATE::RUNNING);
+	state = tree.update(1.5f);
+	ASSERT_EQ(state, BehaviorTree::NODE_STATE::RUNNING);
+	state = tree.update(2.5f);
+	ASSERT_EQ(state, BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+TEST(BAKED_TREE_TEST, RESET)
+{
+	RunningNode* runningNode = new RunningNode(2.0f);
+	std::unique_ptr<BehaviorTree::Sequence> sequence(new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(runningNode)));
+
+	BehaviorTree::Tree tree(std::move(sequence));
+
+	BehaviorTree::NODE_STATE state = tree.update(1.0f);
+	ASSERT_EQ(state, BehaviorTree::NODE_STATE::RUNNING);
+
+	tree.reset();
+	runningNode->elapsedTime = 0;
+
+	state = tree.update(1.0f);
+	ASSERT_EQ(state, BehaviorTree::NODE_STATE::RUNNING);
+}
+//=====================================================================================================
+
+//========================================== BATCH UPDATE TEST ========================================
+// One shared Tree, many TreeInstances. Per-agent state must not leak between instances.
+TEST(BATCH_UPDATE_TEST, SHARED_TREE_MANY_INSTANCES)
+{
+	std::unique_ptr<BehaviorTree::Selector> selector(new BehaviorTree::Selector(nullptr));
+	selector->addChild(std::move(create<FailureNode>()));
+	selector->addChild(std::move(create<SuccessNode>()));
+
+	BehaviorTree::Tree tree(std::move(selector));
+
+	std::vector<BehaviorTree::TreeInstance> instances;
+	for (int i = 0; i < 10; i++)
+	{
+		instances.push_back(tree.createInstance());
+	}
+
+	BehaviorTree::Batch::update(tree, instances, 0.0f);
+
+	for (auto& instance : instances)
+	{
+		ASSERT_EQ(instance.getLastState(), BehaviorTree::NODE_STATE::SUCCESS);
+	}
+}
+
+TEST(BATCH_UPDATE_TEST, PER_INSTANCE_STATE)
+{
+	// Limiter with limit 1 wrapping a failing child. First update executes the
+	// child (FAILURE), later updates hit the limit (FAILURE as well), but the
+	// counter must advance separately per instance.
+	std::unique_ptr<BehaviorTree::Sequence> sequence(new BehaviorTree::Sequence(nullptr));
+	sequence->addChild(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Limiter(std::move(create<SuccessNode>()), 1)));
+
+	BehaviorTree::Tree tree(std::move(sequence));
+
+	BehaviorTree::TreeInstance first = tree.createInstance();
+	BehaviorTree::TreeInstance second = tree.createInstance();
+
+	// First instance consumes its limit
+	tree.update(first, 0.0f);
+	ASSERT_EQ(first.getLastState(), BehaviorTree::NODE_STATE::SUCCESS);
+	tree.update(first, 0.0f);
+	ASSERT_EQ(first.getLastState(), BehaviorTree::NODE_STATE::FAILURE);
+
+	// Second instance must still have its limit available
+	tree.update(second, 0.0f);
+	ASSERT_EQ(second.getLastState(), BehaviorTree::NODE_STATE::SUCCESS);
+}
+//=====================================================================================================
+
+//======================================= REACTIVE SELECTOR TEST ======================================
+// A condition leaf used by reactive selector tests. Evaluates a bool that tests flip.
+class FlagCondition : public BehaviorTree::Condition
+{
+public:
+	FlagCondition(bool* flag) : Condition(), flag(flag) {}
+	~FlagCondition() = default;
+
+	bool* flag;
+
+	virtual const bool evaluate() override
+	{
+		return *this->flag;
+	}
+};
+
+// A node that runs forever until reset.
+class RunForeverNode : public BehaviorTree::Node
+{
+public:
+	RunForeverNode() : Node(), resetCount(0) {}
+	~RunForeverNode() = default;
+
+	int resetCount;
+
+	virtual const BehaviorTree::NODE_STATE update(const float delta = 0) override
+	{
+		return BehaviorTree::NODE_STATE::RUNNING;
+	}
+
+	virtual void reset() override
+	{
+		this->resetCount++;
+	}
+};
+
+TEST(REACTIVE_SELECTOR_TEST, CONDITION_CACHES_RESULT)
+{
+	bool flag = false;
+	FlagCondition* condition = new FlagCondition(&flag);
+
+	// First update evaluates, second returns the cached result.
+	ASSERT_EQ(condition->update(0.0f), BehaviorTree::NODE_STATE::FAILURE);
+	ASSERT_FALSE(condition->isDirty());
+
+	// Value changed but condition wasn't marked dirty. Cached result sticks.
+	flag = true;
+	ASSERT_EQ(condition->update(0.0f), BehaviorTree::NODE_STATE::FAILURE);
+
+	// Marking dirty re-evaluates.
+	condition->markDirty();
+	ASSERT_EQ(condition->update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+
+	delete condition;
+}
+
+TEST(REACTIVE_SELECTOR_TEST, OBSERVER_ABORT)
+{
+	bool flag = false;
+	FlagCondition* condition = new FlagCondition(&flag);
+	RunForeverNode* runningNode = new RunForeverNode();
+
+	// selector -> [sequence -> [condition, success], run forever]
+	std::unique_ptr<BehaviorTree::Sequence> guardedBranch(new BehaviorTree::Sequence(nullptr));
+	guardedBranch->addChild(std::unique_ptr<BehaviorTree::Node>(condition));
+	guardedBranch->addChild(std::move(create<SuccessNode>()));
+
+	BehaviorTree::Selector* selector = new BehaviorTree::Selector(nullptr);
+	selector->setReactive(true);
+	selector->addChild(std::move(guardedBranch));
+	selector->addChild(std::unique_ptr<BehaviorTree::Node>(runningNode));
+
+	// Guard fails, lower priority branch runs.
+	ASSERT_EQ(selector->update(0.0f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(selector->update(0.0f), BehaviorTree::NODE_STATE::RUNNING);
+
+	// Condition flips. The running branch must be aborted and reset, and the
+	// higher priority branch must take over within one update.
+	flag = true;
+	condition->markDirty();
+	ASSERT_EQ(selector->update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(runningNode->resetCount, 1);
+
+	delete selector;
+}
+//=====================================================================================================
+
+//======================================== RUNNING RESUME TEST ========================================
+// RUNNING leaf several composites deep. Tree must resume at the leaf and bubble the
+// final result up through the ancestors, continuing siblings after the running branch.
+TEST(RUNNING_RESUME_TEST, DEEP_RUNNING_LEAF)
+{
+	// root sequence -> [success, sequence -> sequence -> sequence -> running(3s), success]
+	std::unique_ptr<BehaviorTree::Node> inner(new RunningNode(3.0f));
+	for (int i = 0; i < 3; i++)
+	{
+		inner = std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Sequence(std::move(inner)));
+	}
+
+	std::unique_ptr<BehaviorTree::Sequence> rootSequence(new BehaviorTree::Sequence(nullptr));
+	rootSequence->addChild(std::move(create<SuccessNode>()));
+	rootSequence->addChild(std::move(inner));
+	rootSequence->addChild(std::move(create<SuccessNode>()));
+
+	BehaviorTree::Tree tree(std::move(rootSequence));
+
+	BehaviorTree::NODE_STATE state;
+	state = tree.update(1.0f);
+	ASSERT_EQ(state, BehaviorTree::NODE_STATE::RUNNING);
+	state = tree.update(1.0f);
+	ASSERT_EQ(state, BehaviorTree::NODE_STATE::RUNNING);
+	// Leaf succeeds. Result bubbles up and the sibling after the branch runs.
+	state = tree.update(1.0f);
+	ASSERT_EQ(state, BehaviorTree::NODE_STATE::SUCCESS);
+}
+//=====================================================================================================//=====================================================================================================
+
+//========================================== NODE POOL TEST ===========================================
+// Nodes built between begin and end must come from the pool. Recycle hands the blocks
+// back in one step, so rebuilding doesn't grow the pool. Heap nodes stay unaffected.
+TEST(NODE_POOL_TEST, POOLED_BUILD_AND_RECYCLE)
+{
+	BehaviorTree::NodePool pool;
+	ASSERT_EQ(pool.getBlockCount(), 0);
+
+	pool.begin();
+	ASSERT_EQ(BehaviorTree::NodePool::getActivePool(), &pool);
+
 	{
-		std::string tag = dynamic_cast<SuccessNode*>(child.get())->tag;
-		std::cout << tag << " ";
-		if (tag != std::to_string(count))
+		std::unique_ptr<BehaviorTree::Selector> selector(new BehaviorTree::Selector(nullptr));
+		for (int i = 0; i < 20; i++)
 		{
-			misMatchCount++;
+			selector->addChild(std::move(create<FailureNode>()));
 		}
-		count++;
+		selector->addChild(std::move(create<SuccessNode>()));
+
+		pool.end();
+		ASSERT_EQ(BehaviorTree::NodePool::getActivePool(), nullptr);
+		ASSERT_GE(pool.getBlockCount(), 1);
+
+		BehaviorTree::Tree tree(std::move(selector));
+		ASSERT_EQ(tree.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
 	}
-	std::cout << std::endl;
 
-	delete randomSelector;
+	// Every pooled node is destroyed. Rebuild from recycled memory.
+	const int blockCount = pool.getBlockCount();
+	pool.recycle();
+	pool.begin();
+
+	{
+		std::unique_ptr<BehaviorTree::Sequence> sequence(new BehaviorTree::Sequence(nullptr));
+		for (int i = 0; i < 21; i++)
+		{
+			sequence->addChild(std::move(create<SuccessNode>()));
+		}
+
+		pool.end();
+
+		BehaviorTree::Tree tree(std::move(sequence));
+		ASSERT_EQ(tree.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	}
+
+	// Same shape, same memory. No new block was made.
+	ASSERT_EQ(pool.getBlockCount(), blockCount);
+}
+
+TEST(NODE_POOL_TEST, HEAP_NODES_WITHOUT_POOL)
+{
+	// No pool bound. Nodes come from the global heap and are freed normally.
+	std::unique_ptr<BehaviorTree::Inverter> inverter(new BehaviorTree::Inverter(std::move(create<SuccessNode>())));
+	BehaviorTree::Tree tree(std::move(inverter));
+	ASSERT_EQ(tree.update(0.0f), BehaviorTree::NODE_STATE::FAILURE);
+}
+//=====================================================================================================
+
+//========================================== TREE CLONE TEST ==========================================
+// clone shares the baked structure and makes fresh per-agent state only.
+TEST(TREE_CLONE_TEST, SHARED_STRUCTURE_FRESH_STATE)
+{
+	std::unique_ptr<BehaviorTree::Sequence> sequence(new BehaviorTree::Sequence(nullptr));
+	sequence->addChild(std::move(create<SuccessNode>()));
+	sequence->addChild(std::unique_ptr<BehaviorTree::Node>(new RunningNode(2.0f)));
+
+	BehaviorTree::Tree tree(std::move(sequence));
+	ASSERT_EQ(tree.update(1.0f), BehaviorTree::NODE_STATE::RUNNING);
+
+	BehaviorTree::Tree copy = tree.clone();
+	ASSERT_EQ(copy.getNodeCount(), tree.getNodeCount());
+
+	// Clone got its own default instance and its own per-agent instances
+	BehaviorTree::TreeInstance instance = copy.createInstance();
+	ASSERT_EQ(instance.getLastState(), BehaviorTree::NODE_STATE::FAILURE);
+	ASSERT_EQ(copy.update(instance, 0.5f), BehaviorTree::NODE_STATE::RUNNING);
+}
+//=====================================================================================================
+
+//======================================== SERIALIZATION TEST =========================================
+// Baked tree is saved as fixed-size records and loaded back. Decorator parameters must
+// survive the roundtrip and leaf nodes are recreated through the registered factories.
+TEST(SERIALIZATION_TEST, SAVE_LOAD_ROUNDTRIP)
+{
+	BehaviorTree::Serialization::registerLeaf<SuccessNode>(1);
+	BehaviorTree::Serialization::registerLeaf<FailureNode>(2);
+
+	std::unique_ptr<BehaviorTree::Selector> selector(new BehaviorTree::Selector(nullptr));
+	selector->addChild(std::move(create<FailureNode>()));
+	selector->addChild(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Inverter(std::move(create<FailureNode>()))));
+	selector->addChild(std::move(create<SuccessNode>()));
+
+	BehaviorTree::Tree tree(std::move(selector));
+	const int nodeCount = tree.getNodeCount();
+
+	ASSERT_TRUE(BehaviorTree::Serialization::save(tree, "serialization_test.bt"));
+
+	std::unique_ptr<BehaviorTree::Tree> loaded = BehaviorTree::Serialization::load("serialization_test.bt");
+	ASSERT_TRUE(loaded != nullptr);
+	ASSERT_EQ(loaded->getNodeCount(), nodeCount);
+
+	// Inverter flips the second FailureNode. Selector succeeds there.
+	ASSERT_EQ(loaded->update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+
+	std::remove("serialization_test.bt");
+}
+
+TEST(SERIALIZATION_TEST, DECORATOR_PARAMETERS_SURVIVE)
+{
+	BehaviorTree::Serialization::registerLeaf<SuccessNode>(1);
+
+	// Limiter allows 2 updates, so the third tick of the loaded tree fails
+	std::unique_ptr<BehaviorTree::Limiter> limiter(new BehaviorTree::Limiter(std::move(create<SuccessNode>()), 2));
+
+	BehaviorTree::Tree tree(std::move(limiter));
+	ASSERT_TRUE(BehaviorTree::Serialization::save(tree, "serialization_test.bt"));
+
+	std::unique_ptr<BehaviorTree::Tree> loaded = BehaviorTree::Serialization::load("serialization_test.bt");
+	ASSERT_TRUE(loaded != nullptr);
+
+	ASSERT_EQ(loaded->update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(loaded->update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(loaded->update(0.0f), BehaviorTree::NODE_STATE::FAILURE);
+
+	std::remove("serialization_test.bt");
+}
+
+TEST(SERIALIZATION_TEST, UNREGISTERED_LEAF_FAILS_SAVE)
+{
+	// RunningNode is never registered. Save must refuse the tree.
+	std::unique_ptr<BehaviorTree::Node> running(new RunningNode(1.0f));
+	BehaviorTree::Tree tree(std::move(running));
+
+	ASSERT_FALSE(BehaviorTree::Serialization::save(tree, "serialization_test.bt"));
+}
+
+TEST(SERIALIZATION_TEST, MALFORMED_FILE_FAILS_LOAD)
+{
+	FILE* file = std::fopen("serialization_test.bt", "wb");
+	ASSERT_TRUE(file != nullptr);
+	std::fputs("not a tree file", file);
+	std::fclose(file);
+
+	ASSERT_TRUE(BehaviorTree::Serialization::load("serialization_test.bt") == nullptr);
+	ASSERT_TRUE(BehaviorTree::Serialization::load("no_such_file.bt") == nullptr);
+
+	std::remove("serialization_test.bt");
+}
+//=====================================================================================================
+
+#if defined(BT_PROFILING)
+//========================================== PROFILING TEST ===========================================
+// Only compiled when the test project defines BT_PROFILING. Counters must see every
+// node update and the per-tree profiler must stay isolated per tree.
+TEST(PROFILING_TEST, PER_TREE_COUNTERS)
+{
+	std::unique_ptr<BehaviorTree::Sequence> sequence(new BehaviorTree::Sequence(nullptr));
+	sequence->addChild(std::move(create<SuccessNode>()));
+	sequence->addChild(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Inverter(std::move(create<SuccessNode>()))));
+
+	BehaviorTree::Tree tree(std::move(sequence));
+
+	for (int i = 0; i < 5; i++)
+	{
+		ASSERT_EQ(tree.update(0.0f), BehaviorTree::NODE_STATE::FAILURE);
+	}
+
+	BehaviorTree::Profiler& profiler = tree.getProfiler();
+	ASSERT_EQ(profiler.getInvocationCount(BehaviorTree::NODE_TYPE::SEQUENCE), 5);
+	ASSERT_EQ(profiler.getInvocationCount(BehaviorTree::NODE_TYPE::INVERTER), 5);
+	ASSERT_EQ(profiler.getInvocationCount(BehaviorTree::NODE_TYPE::LEAF), 10);
+	ASSERT_EQ(profiler.getStateCount(BehaviorTree::NODE_TYPE::INVERTER, BehaviorTree::NODE_STATE::FAILURE), 5);
+	ASSERT_EQ(profiler.getSampleCount(), 20);
+
+	profiler.clear();
+	ASSERT_EQ(profiler.getInvocationCount(BehaviorTree::NODE_TYPE::SEQUENCE), 0);
+	ASSERT_EQ(profiler.getSampleCount(), 0);
+}
+//=====================================================================================================
+#endif
+//=====================================================================================================
+
+//========================================== STATIC TREE TEST =========================================
+// Compile-time tree shapes. Same semantics as the runtime composites, but children are
+// held by value and update is inlined with no virtual dispatch.
+#include "../src/BehaviorTreeStatic.h"
+
+struct StaticSuccess { const BehaviorTree::NODE_STATE update(const float delta) { return BehaviorTree::NODE_STATE::SUCCESS; } };
+struct StaticFailure { const BehaviorTree::NODE_STATE update(const float delta) { return BehaviorTree::NODE_STATE::FAILURE; } };
+
+// Runs for a fixed number of updates, then succeeds.
+struct StaticRunning
+{
+	int remainingTicks = 2;
+	const BehaviorTree::NODE_STATE update(const float delta)
+	{
+		if (this->remainingTicks > 0)
+		{
+			this->remainingTicks--;
+			return BehaviorTree::NODE_STATE::RUNNING;
+		}
+		return BehaviorTree::NODE_STATE::SUCCESS;
+	}
+	void reset() { this->remainingTicks = 2; }
+};
+
+// Counts how many times it was updated.
+struct StaticCounter
+{
+	int updateCount = 0;
+	const BehaviorTree::NODE_STATE update(const float delta)
+	{
+		this->updateCount++;
+		return BehaviorTree::NODE_STATE::SUCCESS;
+	}
+};
+
+TEST(STATIC_TREE_TEST, SELECTOR_AND_SEQUENCE)
+{
+	BehaviorTree::StaticSelector<StaticFailure, StaticSuccess> selector;
+	ASSERT_EQ(selector.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+
+	BehaviorTree::StaticSequence<StaticSuccess, StaticFailure> sequence;
+	ASSERT_EQ(sequence.update(0.0f), BehaviorTree::NODE_STATE::FAILURE);
+
+	BehaviorTree::StaticSequence<StaticSuccess, BehaviorTree::StaticSelector<StaticFailure, StaticSuccess>> nested;
+	ASSERT_EQ(nested.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+TEST(STATIC_TREE_TEST, RUNNING_CHILD_RESUMES)
+{
+	BehaviorTree::StaticSequence<StaticCounter, StaticRunning, StaticCounter> sequence;
+
+	ASSERT_EQ(sequence.update(0.0f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(sequence.update(0.0f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(sequence.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+
+	// Resume skipped the first child while the second was running
+	ASSERT_EQ(sequence.childAt<0>().updateCount, 1);
+	ASSERT_EQ(sequence.childAt<2>().updateCount, 1);
+
+	// Reset propagates down to children that have reset
+	sequence.reset();
+	ASSERT_EQ(sequence.childAt<1>().remainingTicks, 2);
+}
+
+TEST(STATIC_TREE_TEST, DECORATORS)
+{
+	BehaviorTree::StaticInverter<StaticSuccess> inverter;
+	ASSERT_EQ(inverter.update(0.0f), BehaviorTree::NODE_STATE::FAILURE);
+
+	BehaviorTree::StaticSucceeder<StaticFailure> succeeder;
+	ASSERT_EQ(succeeder.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+
+	BehaviorTree::StaticFailer<StaticSuccess> failer;
+	ASSERT_EQ(failer.update(0.0f), BehaviorTree::NODE_STATE::FAILURE);
+
+	BehaviorTree::StaticRepeater<StaticCounter, 4> repeater;
+	ASSERT_EQ(repeater.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(repeater.getChild().updateCount, 4);
 }
-//=====================================================================================================
\ No newline at end of file
+
+TEST(STATIC_TREE_TEST, ADAPTER_IN_RUNTIME_TREE)
+{
+	// The whole static subtree is one leaf of the runtime tree
+	using CombatTree = BehaviorTree::StaticSequence<StaticSuccess, BehaviorTree::StaticSelector<StaticFailure, StaticSuccess>>;
+
+	std::unique_ptr<BehaviorTree::Selector> root(new BehaviorTree::Selector(nullptr));
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::StaticNodeAdapter<CombatTree>()));
+
+	BehaviorTree::Tree tree(std::move(root));
+	ASSERT_EQ(tree.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+}
+//=====================================================================================================
+
+//========================================= TICK BUDGET TEST ==========================================
+// A leaf that counts how many times it was ticked. Always succeeds.
+class TickCountNode : public BehaviorTree::Node
+{
+public:
+	TickCountNode() : Node(), tickCount(0) {}
+	~TickCountNode() = default;
+
+	int tickCount;
+
+	virtual const BehaviorTree::NODE_STATE update(const float delta = 0) override
+	{
+		this->tickCount++;
+		return BehaviorTree::NODE_STATE::SUCCESS;
+	}
+};
+
+TEST(TICK_BUDGET_TEST, INFINITE_REPEAT_YIELDS)
+{
+	// Infinite RepeatUntilSuccess over a failing leaf never meets its desired
+	// status. A budgeted update must break out of the loop with RUNNING
+	// instead of spinning the whole frame away.
+	BehaviorTree::Tree tree(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::RepeatUntilSuccess(std::move(create<FailureNode>()), BehaviorTree::Repeat::REPEAT_INFINITE)));
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+
+	ASSERT_EQ(tree.update(instance, 0.0f, BehaviorTree::TickBudget(1000)), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_TRUE(instance.getLastTickYielded());
+
+	// The next budgeted update keeps looping where it left off.
+	ASSERT_EQ(tree.update(instance, 0.0f, BehaviorTree::TickBudget(1000)), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_TRUE(instance.getLastTickYielded());
+}
+
+TEST(TICK_BUDGET_TEST, YIELD_RESUMES_EXACTLY)
+{
+	// sequence -> [count, count, count, count]. Nodes visited per full tick: 5.
+	TickCountNode* leaves[4];
+
+	std::unique_ptr<BehaviorTree::Sequence> sequence(new BehaviorTree::Sequence(nullptr));
+	for (int i = 0; i < 4; i++)
+	{
+		leaves[i] = new TickCountNode();
+		sequence->addChild(std::unique_ptr<BehaviorTree::Node>(leaves[i]));
+	}
+
+	BehaviorTree::Tree tree(std::unique_ptr<BehaviorTree::Node>(sequence.release()));
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+
+	// 3 visits: the sequence and its first two leaves. Third leaf yields.
+	ASSERT_EQ(tree.update(instance, 0.0f, BehaviorTree::TickBudget(3)), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_TRUE(instance.getLastTickYielded());
+	ASSERT_EQ(leaves[0]->tickCount, 1);
+	ASSERT_EQ(leaves[1]->tickCount, 1);
+	ASSERT_EQ(leaves[2]->tickCount, 0);
+
+	// Finishing unbudgeted must not re-tick the leaves that already ran.
+	ASSERT_EQ(tree.update(instance, 0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_FALSE(instance.getLastTickYielded());
+	ASSERT_EQ(leaves[0]->tickCount, 1);
+	ASSERT_EQ(leaves[1]->tickCount, 1);
+	ASSERT_EQ(leaves[2]->tickCount, 1);
+	ASSERT_EQ(leaves[3]->tickCount, 1);
+}
+
+TEST(TICK_BUDGET_TEST, GENEROUS_BUDGET_CHANGES_NOTHING)
+{
+	std::unique_ptr<BehaviorTree::Selector> selector(new BehaviorTree::Selector(std::move(create<FailureNode>())));
+	selector->addChild(std::move(create<SuccessNode>()));
+
+	BehaviorTree::Tree tree(std::unique_ptr<BehaviorTree::Node>(selector.release()));
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+
+	// Budget far above the node count. Same result as the plain overload.
+	ASSERT_EQ(tree.update(instance, 0.0f, BehaviorTree::TickBudget(100000)), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_FALSE(instance.getLastTickYielded());
+}
+
+TEST(TICK_BUDGET_TEST, FINITE_REPEAT_YIELDS_RUNNING)
+{
+	// A finite RepeatUntil that runs out of budget must report RUNNING, not
+	// the FAILURE it would earn by finishing all its iterations.
+	BehaviorTree::Tree tree(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::RepeatUntilSuccess(std::move(create<FailureNode>()), 50)));
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+
+	ASSERT_EQ(tree.update(instance, 0.0f, BehaviorTree::TickBudget(10)), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_TRUE(instance.getLastTickYielded());
+}
+//=====================================================================================================
+
+//========================================== COROUTINE TEST ===========================================
+#include "../src/BehaviorTreeCoroutine.h"
+
+// CoroutineNode needs C++20 coroutines. The section disappears on older toolchains.
+#if defined(BT_COROUTINE_NODE)
+
+// An async-style action: one frame of setup, then parks until signaled.
+class CoroutineAction : public BehaviorTree::CoroutineNode
+{
+public:
+	int startCount = 0;
+	int resumeCount = 0;
+protected:
+	virtual Coroutine run() override
+	{
+		this->startCount++;
+		co_await this->yieldTick();
+		this->resumeCount++;
+		co_await this->awaitSignal();
+		this->resumeCount++;
+		co_return BehaviorTree::NODE_STATE::SUCCESS;
+	}
+};
+
+TEST(COROUTINE_TEST, PARKS_UNTIL_SIGNALED)
+{
+	CoroutineAction action;
+
+	// Starts lazily, suspends on yieldTick
+	ASSERT_EQ(action.update(0.0f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(action.startCount, 1);
+
+	// Passes yieldTick, parks on awaitSignal
+	ASSERT_EQ(action.update(0.0f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(action.resumeCount, 1);
+
+	// Parked updates must not resume the coroutine
+	for (int i = 0; i < 10; i++)
+	{
+		ASSERT_EQ(action.update(0.0f), BehaviorTree::NODE_STATE::RUNNING);
+	}
+	ASSERT_EQ(action.resumeCount, 1);
+
+	// Signal wakes it on the next update
+	action.signal();
+	ASSERT_EQ(action.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(action.resumeCount, 2);
+
+	// Finished action restarts on the update after
+	ASSERT_EQ(action.update(0.0f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(action.startCount, 2);
+}
+
+TEST(COROUTINE_TEST, SIGNAL_BEFORE_PARK_NOT_LOST)
+{
+	CoroutineAction action;
+	ASSERT_EQ(action.update(0.0f), BehaviorTree::NODE_STATE::RUNNING);
+
+	// Async result lands before the action reaches awaitSignal
+	action.signal();
+	ASSERT_EQ(action.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+TEST(COROUTINE_TEST, RESET_ABANDONS_ACTION)
+{
+	CoroutineAction action;
+	action.update(0.0f);
+	action.update(0.0f);
+
+	// Reset while parked. Next update starts the action over.
+	action.reset();
+	ASSERT_EQ(action.update(0.0f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(action.startCount, 2);
+}
+
+#endif
+//=====================================================================================================
+
+//======================================== BATCH CONDITION TEST =======================================
+TEST(BATCH_CONDITION_TEST, ALL_COMPARATORS)
+{
+	float health = 30.0f;
+	float distance = 10.0f;
+	float ammo = 3.0f;
+	float mana = 5.0f;
+	float armor = 7.0f;
+	float speed = 2.0f;
+
+	BehaviorTree::BatchCondition block;
+	block.addCondition(&health, BehaviorTree::BatchCondition::COMPARATOR::LESS, 50.0f);
+	block.addCondition(&distance, BehaviorTree::BatchCondition::COMPARATOR::LESS_EQUAL, 10.0f);
+	block.addCondition(&ammo, BehaviorTree::BatchCondition::COMPARATOR::GREATER, 5.0f);
+	block.addCondition(&mana, BehaviorTree::BatchCondition::COMPARATOR::GREATER_EQUAL, 5.0f);
+	block.addCondition(&armor, BehaviorTree::BatchCondition::COMPARATOR::EQUAL, 8.0f);
+	block.addCondition(&speed, BehaviorTree::BatchCondition::COMPARATOR::NOT_EQUAL, 2.0f);
+	ASSERT_EQ(block.getConditionCount(), 6);
+
+	ASSERT_EQ(block.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(block.getFirstPassingIndex(), 0);
+	ASSERT_TRUE(block.getConditionResult(0));
+	ASSERT_TRUE(block.getConditionResult(1));
+	ASSERT_FALSE(block.getConditionResult(2));
+	ASSERT_TRUE(block.getConditionResult(3));
+	ASSERT_FALSE(block.getConditionResult(4));
+	ASSERT_FALSE(block.getConditionResult(5));
+
+	// Values are re-read every update
+	health = 90.0f;
+	ASSERT_EQ(block.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(block.getFirstPassingIndex(), 1);
+}
+
+TEST(BATCH_CONDITION_TEST, NONE_PASSING_AND_EMPTY)
+{
+	BehaviorTree::BatchCondition empty;
+	ASSERT_EQ(empty.update(0.0f), BehaviorTree::NODE_STATE::ERROR);
+
+	float value = 5.0f;
+	float passing = 20.0f;
+
+	// 6 failing lanes, then one passing in the second SIMD step
+	BehaviorTree::BatchCondition block;
+	for (int i = 0; i < 6; i++)
+	{
+		block.addCondition(&value, BehaviorTree::BatchCondition::COMPARATOR::GREATER, 10.0f);
+	}
+
+	ASSERT_EQ(block.update(0.0f), BehaviorTree::NODE_STATE::FAILURE);
+	ASSERT_EQ(block.getFirstPassingIndex(), -1);
+
+	block.addCondition(&passing, BehaviorTree::BatchCondition::COMPARATOR::GREATER, 10.0f);
+	ASSERT_EQ(block.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(block.getFirstPassingIndex(), 6);
+}
+
+TEST(BATCH_CONDITION_TEST, GUARDS_A_SELECTOR_BRANCH)
+{
+	float threat = 0.0f;
+
+	BehaviorTree::BatchCondition* guard = new BehaviorTree::BatchCondition();
+	guard->addCondition(&threat, BehaviorTree::BatchCondition::COMPARATOR::GREATER, 0.5f);
+
+	// selector -> [guard block, fallback]
+	std::unique_ptr<BehaviorTree::Selector> selector(new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(guard)));
+	selector->addChild(std::move(create<SuccessNode>()));
+
+	BehaviorTree::Tree tree(std::unique_ptr<BehaviorTree::Node>(selector.release()));
+
+	// Guard fails, fallback branch answers
+	ASSERT_EQ(tree.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(guard->getFirstPassingIndex(), -1);
+
+	// Guard passes, selector stops at the block
+	threat = 1.0f;
+	ASSERT_EQ(tree.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(guard->getFirstPassingIndex(), 0);
+}
+//=====================================================================================================
+
+//========================================= ERROR POLICY TEST =========================================
+// A leaf that always errors, for policy tests.
+class ErrorNode : public BehaviorTree::Node
+{
+public:
+	virtual const BehaviorTree::NODE_STATE update(const float delta = 0) override
+	{
+		return BehaviorTree::NODE_STATE::ERROR;
+	}
+};
+
+TEST(ERROR_POLICY_TEST, PER_TREE_POLICY)
+{
+	// selector -> [error, success]. IGNORE treats the error as FAILURE and
+	// moves on; TERMINATE stops the whole update.
+	{
+		std::unique_ptr<BehaviorTree::Selector> selector(new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(new ErrorNode())));
+		selector->addChild(std::move(create<SuccessNode>()));
+
+		BehaviorTree::Tree tree(std::unique_ptr<BehaviorTree::Node>(selector.release()));
+		ASSERT_EQ(tree.getErrorPolicy(), BehaviorTree::ERROR_POLICY::IGNORE);
+		ASSERT_EQ(tree.update(0.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	}
+	{
+		std::unique_ptr<BehaviorTree::Selector> selector(new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(new ErrorNode())));
+		selector->addChild(std::move(create<SuccessNode>()));
+
+		BehaviorTree::Tree tree(std::unique_ptr<BehaviorTree::Node>(selector.release()), BehaviorTree::ERROR_POLICY::TERMINATE);
+		ASSERT_EQ(tree.getErrorPolicy(), BehaviorTree::ERROR_POLICY::TERMINATE);
+		ASSERT_EQ(tree.update(0.0f), BehaviorTree::NODE_STATE::ERROR);
+	}
+}
+
+TEST(ERROR_POLICY_TEST, CLONES_SHARE_POLICY)
+{
+	std::unique_ptr<BehaviorTree::Selector> selector(new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(new ErrorNode())));
+	selector->addChild(std::move(create<SuccessNode>()));
+
+	BehaviorTree::Tree tree(std::unique_ptr<BehaviorTree::Node>(selector.release()), BehaviorTree::ERROR_POLICY::TERMINATE);
+	BehaviorTree::Tree copy = tree.clone();
+
+	ASSERT_EQ(copy.getErrorPolicy(), BehaviorTree::ERROR_POLICY::TERMINATE);
+	ASSERT_EQ(copy.update(0.0f), BehaviorTree::NODE_STATE::ERROR);
+}
+//=====================================================================================================
+
+//========================================= SUBTREE REF TEST ==========================================
+// Shared subtree for ref tests. Per-agent state (the delay clock) lives in the
+// TreeInstance streams, so the shared leaf stays stateless as SubtreeRef requires.
+static std::shared_ptr<BehaviorTree::Tree> makeSharedSubtree()
+{
+	std::unique_ptr<BehaviorTree::Sequence> sequence(new BehaviorTree::Sequence(nullptr));
+	sequence->addChild(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::DelayTime(std::move(create<SuccessNode>()), 1.0f, false)));
+
+	return std::make_shared<BehaviorTree::Tree>(std::unique_ptr<BehaviorTree::Node>(sequence.release()));
+}
+
+TEST(SUBTREE_REF_TEST, SHARED_STRUCTURE_PRIVATE_STATE)
+{
+	std::shared_ptr<BehaviorTree::Tree> shared = makeSharedSubtree();
+
+	BehaviorTree::SubtreeRef* refA = new BehaviorTree::SubtreeRef(shared);
+	BehaviorTree::SubtreeRef* refB = new BehaviorTree::SubtreeRef(shared);
+
+	BehaviorTree::Tree agentA{ std::unique_ptr<BehaviorTree::Node>(refA) };
+	BehaviorTree::Tree agentB{ std::unique_ptr<BehaviorTree::Node>(refB) };
+
+	// Both agents walk the same shared nodes with their own delay clock
+	ASSERT_EQ(agentA.update(0.6f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(agentB.update(0.6f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(agentA.update(0.6f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(agentB.update(0.6f), BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+TEST(SUBTREE_REF_TEST, SWAP_KEEPS_OTHER_REFS)
+{
+	std::shared_ptr<BehaviorTree::Tree> oldVersion = makeSharedSubtree();
+
+	BehaviorTree::SubtreeRef* refA = new BehaviorTree::SubtreeRef(oldVersion);
+	BehaviorTree::SubtreeRef* refB = new BehaviorTree::SubtreeRef(oldVersion);
+
+	BehaviorTree::Tree agentA{ std::unique_ptr<BehaviorTree::Node>(refA) };
+	BehaviorTree::Tree agentB{ std::unique_ptr<BehaviorTree::Node>(refB) };
+
+	// Copy-on-write by replacement: the edited subtree is a new Tree and
+	// only refA picks it up. refB keeps the old version alive.
+	std::shared_ptr<BehaviorTree::Tree> newVersion = makeSharedSubtree();
+	refA->setSubtree(newVersion);
+
+	ASSERT_EQ(refA->getSubtree(), newVersion);
+	ASSERT_EQ(refB->getSubtree(), oldVersion);
+
+	ASSERT_EQ(agentA.update(0.6f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(agentB.update(0.6f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(agentA.update(0.6f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(agentB.update(0.6f), BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+TEST(SUBTREE_REF_TEST, DETACHED_REF_ERRORS)
+{
+	BehaviorTree::SubtreeRef ref(nullptr);
+	ASSERT_EQ(ref.update(0.0f), BehaviorTree::NODE_STATE::ERROR);
+
+	// Attach late; works from the next update on
+	ref.setSubtree(makeSharedSubtree());
+	ASSERT_EQ(ref.update(0.6f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(ref.update(0.6f), BehaviorTree::NODE_STATE::SUCCESS);
+}
+//=====================================================================================================
+
+//======================================= INCREMENTAL RESET TEST ======================================
+// A leaf that counts updates and resets. Runs for runFor updates, then succeeds.
+class ProbeNode : public BehaviorTree::Node
+{
+public:
+	ProbeNode(const int runFor) : Node(), runFor(runFor), tickCount(0), resetCount(0) {}
+	~ProbeNode() = default;
+
+	int runFor;
+	int tickCount;
+	int resetCount;
+
+	virtual const BehaviorTree::NODE_STATE update(const float delta = 0) override
+	{
+		this->tickCount++;
+		if (this->runFor < 0 || this->tickCount <= this->runFor)
+		{
+			return BehaviorTree::NODE_STATE::RUNNING;
+		}
+
+		return BehaviorTree::NODE_STATE::SUCCESS;
+	}
+
+	virtual void reset() override
+	{
+		this->resetCount++;
+		this->tickCount = 0;
+	}
+};
+
+TEST(INCREMENTAL_RESET_TEST, RESET_PROPAGATES_THROUGH_GRAPH)
+{
+	ProbeNode* left = new ProbeNode(-1);
+	ProbeNode* right = new ProbeNode(-1);
+
+	BehaviorTree::Sequence* sequence = new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Inverter(std::unique_ptr<BehaviorTree::Node>(left))));
+	sequence->addChild(std::unique_ptr<BehaviorTree::Node>(right));
+
+	sequence->update(0.1f);
+	sequence->reset();
+
+	// Composites and decorators pass reset down to every descendant
+	ASSERT_EQ(left->resetCount, 1);
+	ASSERT_EQ(right->resetCount, 1);
+
+	delete sequence;
+}
+
+TEST(INCREMENTAL_RESET_TEST, ONLY_ACTIVE_PATH)
+{
+	ProbeNode* done = new ProbeNode(0);      // succeeds on first update
+	ProbeNode* running = new ProbeNode(-1);  // runs forever
+	ProbeNode* sibling = new ProbeNode(-1);  // branch never reached
+
+	BehaviorTree::Sequence* inner = new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(done));
+	inner->addChild(std::unique_ptr<BehaviorTree::Node>(running));
+
+	BehaviorTree::Selector* root = new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(inner));
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(sibling));
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root) };
+
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+
+	// Second update resumed at the running leaf; done wasn't re-updated
+	ASSERT_EQ(done->tickCount, 1);
+	ASSERT_EQ(running->tickCount, 2);
+
+	tree.resetActive();
+
+	// Only the leaf the active path ends at was reset
+	ASSERT_EQ(running->resetCount, 1);
+	ASSERT_EQ(done->resetCount, 0);
+	ASSERT_EQ(sibling->resetCount, 0);
+
+	// Running child slots were cleared, so the walk starts at root again
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(done->tickCount, 2);
+	ASSERT_EQ(running->tickCount, 1);
+}
+
+TEST(INCREMENTAL_RESET_TEST, DELAY_CLOCK_CLEARED)
+{
+	ProbeNode* leaf = new ProbeNode(-1);
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::DelayTime(std::unique_ptr<BehaviorTree::Node>(leaf), 1.0f, false)) };
+
+	ASSERT_EQ(tree.update(0.6f), BehaviorTree::NODE_STATE::RUNNING);
+
+	tree.resetActive();
+
+	// The delay clock on the path was cleared: without the reset this
+	// update would have ended the 1.0s delay and updated the child.
+	ASSERT_EQ(tree.update(0.6f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(leaf->tickCount, 0);
+}
+
+TEST(INCREMENTAL_RESET_TEST, LIMITER_COUNTER_KEPT)
+{
+	ProbeNode* leaf = new ProbeNode(-1);
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Limiter(std::unique_ptr<BehaviorTree::Node>(leaf), 2)) };
+
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	tree.resetActive();
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	tree.resetActive();
+
+	// An interrupt doesn't refund executions; the limit still applies
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::FAILURE);
+}
+
+TEST(INCREMENTAL_RESET_TEST, NOTHING_RUNNING_IS_NOOP)
+{
+	ProbeNode* leaf = new ProbeNode(0);
+
+	BehaviorTree::Selector* root = new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(leaf));
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root) };
+
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+
+	tree.resetActive();
+
+	// No path was in flight; nothing to visit, nothing reset
+	ASSERT_EQ(leaf->resetCount, 0);
+}
+//=====================================================================================================
+
+//========================================= EVENT QUEUE TEST ==========================================
+// A leaf that collects CUSTOM event payloads. Succeeds once it got any.
+class EventProbeNode : public BehaviorTree::Node
+{
+public:
+	EventProbeNode() : Node(), eventSum(0), eventCount(0) {}
+	~EventProbeNode() = default;
+
+	int eventSum;
+	int eventCount;
+
+	virtual const BehaviorTree::NODE_STATE update(const float delta = 0) override
+	{
+		return this->eventCount > 0 ? BehaviorTree::NODE_STATE::SUCCESS : BehaviorTree::NODE_STATE::FAILURE;
+	}
+
+	virtual void onEvent(const int data) override
+	{
+		this->eventSum += data;
+		this->eventCount++;
+	}
+};
+
+TEST(EVENT_QUEUE_TEST, CUSTOM_EVENT_REACHES_LEAF)
+{
+	EventProbeNode* leaf = new EventProbeNode();
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(leaf))) };
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+
+	ASSERT_EQ(tree.update(instance, 0.1f), BehaviorTree::NODE_STATE::FAILURE);
+
+	// Leaf is flat index 1; the selector is the root at 0
+	ASSERT_TRUE(instance.postEvent(BehaviorTree::Event{ 1, BehaviorTree::EVENT_TYPE::CUSTOM, 42 }));
+
+	// Applied at the start of the next update, before the walk
+	ASSERT_EQ(tree.update(instance, 0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(leaf->eventSum, 42);
+}
+
+TEST(EVENT_QUEUE_TEST, FINISH_DELAY_EARLY)
+{
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::DelayTime(std::unique_ptr<BehaviorTree::Node>(new RunningNode(1000.0f)), 100.0f, false)) };
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+
+	// Delaying; the child wasn't reached
+	ASSERT_EQ(tree.update(instance, 0.1f), BehaviorTree::NODE_STATE::RUNNING);
+
+	ASSERT_TRUE(instance.postEvent(BehaviorTree::Event{ 0, BehaviorTree::EVENT_TYPE::FINISH_DELAY, 0 }));
+
+	// Delay was ended; this update reaches the (still running) child
+	ASSERT_EQ(tree.update(instance, 0.1f), BehaviorTree::NODE_STATE::RUNNING);
+}
+
+TEST(EVENT_QUEUE_TEST, EXPIRE_TIME_LIMIT_EARLY)
+{
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::TimeLimit(std::unique_ptr<BehaviorTree::Node>(new RunningNode(1000.0f)), 1000.0f)) };
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+
+	ASSERT_EQ(tree.update(instance, 0.1f), BehaviorTree::NODE_STATE::RUNNING);
+
+	ASSERT_TRUE(instance.postEvent(BehaviorTree::Event{ 0, BehaviorTree::EVENT_TYPE::EXPIRE_TIME_LIMIT, 0 }));
+
+	// Time is up; the running child gets its last chance and fails the limit
+	ASSERT_EQ(tree.update(instance, 0.1f), BehaviorTree::NODE_STATE::FAILURE);
+}
+
+TEST(EVENT_QUEUE_TEST, RESET_LIMITER_REFUNDS)
+{
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Limiter(std::unique_ptr<BehaviorTree::Node>(new RunningNode(1000.0f)), 1)) };
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+
+	ASSERT_EQ(tree.update(instance, 0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	tree.resetActive(instance);
+	ASSERT_EQ(tree.update(instance, 0.1f), BehaviorTree::NODE_STATE::FAILURE);
+
+	ASSERT_TRUE(instance.postEvent(BehaviorTree::Event{ 0, BehaviorTree::EVENT_TYPE::RESET_LIMITER, 0 }));
+	ASSERT_EQ(tree.update(instance, 0.1f), BehaviorTree::NODE_STATE::RUNNING);
+}
+
+TEST(EVENT_QUEUE_TEST, BAD_EVENTS_DROPPED)
+{
+	// Default constructed instance has no queue yet
+	BehaviorTree::TreeInstance empty;
+	ASSERT_FALSE(empty.postEvent(BehaviorTree::Event{ 0, BehaviorTree::EVENT_TYPE::CUSTOM, 0 }));
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Selector(std::move(create<SuccessNode>()))) };
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+
+	// Out of range index and mismatched type post fine but are dropped
+	ASSERT_TRUE(instance.postEvent(BehaviorTree::Event{ 99, BehaviorTree::EVENT_TYPE::CUSTOM, 0 }));
+	ASSERT_TRUE(instance.postEvent(BehaviorTree::Event{ 0, BehaviorTree::EVENT_TYPE::EXPIRE_TIME_LIMIT, 0 }));
+
+	ASSERT_EQ(tree.update(instance, 0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+TEST(EVENT_QUEUE_TEST, CROSS_THREAD_POSTS_DELIVERED_ONCE)
+{
+	EventProbeNode* leaf = new EventProbeNode();
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(leaf))) };
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+
+	std::atomic<int> accepted{ 0 };
+	std::atomic<int> producersLeft{ 2 };
+
+	std::thread producerA([&]()
+	{
+		for (int i = 0; i < 10000; i++)
+		{
+			if (instance.postEvent(BehaviorTree::Event{ 1, BehaviorTree::EVENT_TYPE::CUSTOM, 1 })) accepted++;
+		}
+		producersLeft--;
+	});
+	std::thread producerB([&]()
+	{
+		for (int i = 0; i < 10000; i++)
+		{
+			if (instance.postEvent(BehaviorTree::Event{ 1, BehaviorTree::EVENT_TYPE::CUSTOM, 1 })) accepted++;
+		}
+		producersLeft--;
+	});
+
+	// Consume on this thread while producers post. Full posts just fail.
+	while (producersLeft.load() > 0)
+	{
+		tree.update(instance, 0.1f);
+	}
+
+	producerA.join();
+	producerB.join();
+
+	// Drain what's left, then every accepted post arrived exactly once
+	tree.update(instance, 0.1f);
+	ASSERT_EQ(leaf->eventCount, accepted.load());
+	ASSERT_EQ(leaf->eventSum, accepted.load());
+}
+//=====================================================================================================
+
+//========================================== ARCHETYPE TEST ===========================================
+// A leaf that knows how to copy itself. Clonable graphs need this on every leaf.
+class ClonableNode : public BehaviorTree::Node
+{
+public:
+	ClonableNode(const BehaviorTree::NODE_STATE state) : Node(), state(state) {}
+	~ClonableNode() = default;
+
+	BehaviorTree::NODE_STATE state;
+
+	virtual const BehaviorTree::NODE_STATE update(const float delta = 0) override
+	{
+		return this->state;
+	}
+
+	virtual std::unique_ptr<BehaviorTree::Node> clone() override
+	{
+		return std::unique_ptr<BehaviorTree::Node>(new ClonableNode(this->state));
+	}
+};
+
+TEST(ARCHETYPE_TEST, DEEP_CLONE_MATCHES_ORIGINAL)
+{
+	BehaviorTree::Sequence* sequence = new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(new ClonableNode(BehaviorTree::NODE_STATE::SUCCESS)));
+	sequence->addChild(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Inverter(std::unique_ptr<BehaviorTree::Node>(new ClonableNode(BehaviorTree::NODE_STATE::FAILURE)))));
+
+	std::unique_ptr<BehaviorTree::Node> prototype(sequence);
+	std::unique_ptr<BehaviorTree::Node> copy = prototype->clone();
+
+	ASSERT_NE(copy, nullptr);
+	ASSERT_NE(copy.get(), prototype.get());
+
+	BehaviorTree::Tree original{ std::move(prototype) };
+	BehaviorTree::Tree spawned{ std::move(copy) };
+	ASSERT_EQ(original.update(0.1f), spawned.update(0.1f));
+}
+
+TEST(ARCHETYPE_TEST, CLONE_ZEROES_RUNTIME_STATE)
+{
+	// Burn the prototype Limiter's single execution
+	std::unique_ptr<BehaviorTree::Node> prototype(new BehaviorTree::Limiter(std::unique_ptr<BehaviorTree::Node>(new ClonableNode(BehaviorTree::NODE_STATE::RUNNING)), 1));
+	ASSERT_EQ(prototype->update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(prototype->update(0.1f), BehaviorTree::NODE_STATE::FAILURE);
+
+	// The copy carries the limit, not the spent count
+	std::unique_ptr<BehaviorTree::Node> copy = prototype->clone();
+	ASSERT_NE(copy, nullptr);
+	ASSERT_EQ(copy->update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+}
+
+TEST(ARCHETYPE_TEST, UNCLONABLE_LEAF_POISONS_CLONE)
+{
+	BehaviorTree::Sequence* sequence = new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(new ClonableNode(BehaviorTree::NODE_STATE::SUCCESS)));
+
+	// SuccessNode doesn't override Node::clone
+	sequence->addChild(std::move(create<SuccessNode>()));
+
+	std::unique_ptr<BehaviorTree::Node> prototype(sequence);
+	ASSERT_EQ(prototype->clone(), nullptr);
+}
+
+TEST(ARCHETYPE_TEST, REGISTRY_SPAWNS_COPIES)
+{
+	BehaviorTree::Selector* selector = new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(new ClonableNode(BehaviorTree::NODE_STATE::SUCCESS)));
+
+	ASSERT_TRUE(BehaviorTree::ArchetypeRegistry::registerArchetype(1000, std::unique_ptr<BehaviorTree::Node>(selector)));
+
+	// Duplicate ID and nullptr prototypes are rejected
+	ASSERT_FALSE(BehaviorTree::ArchetypeRegistry::registerArchetype(1000, std::unique_ptr<BehaviorTree::Node>(new ClonableNode(BehaviorTree::NODE_STATE::FAILURE))));
+	ASSERT_FALSE(BehaviorTree::ArchetypeRegistry::registerArchetype(1001, nullptr));
+
+	std::unique_ptr<BehaviorTree::Node> spawnA = BehaviorTree::ArchetypeRegistry::spawn(1000);
+	std::unique_ptr<BehaviorTree::Node> spawnB = BehaviorTree::ArchetypeRegistry::spawn(1000);
+	ASSERT_NE(spawnA, nullptr);
+	ASSERT_NE(spawnB, nullptr);
+	ASSERT_NE(spawnA.get(), spawnB.get());
+
+	ASSERT_EQ(BehaviorTree::ArchetypeRegistry::spawn(9999), nullptr);
+
+	std::unique_ptr<BehaviorTree::Tree> tree = BehaviorTree::ArchetypeRegistry::spawnTree(1000);
+	ASSERT_NE(tree, nullptr);
+	ASSERT_EQ(tree->update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+
+	ASSERT_TRUE(BehaviorTree::ArchetypeRegistry::unregisterArchetype(1000));
+	ASSERT_EQ(BehaviorTree::ArchetypeRegistry::spawn(1000), nullptr);
+}
+
+TEST(ARCHETYPE_TEST, SPAWN_INTO_NODE_POOL)
+{
+	BehaviorTree::Sequence* sequence = new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(new ClonableNode(BehaviorTree::NODE_STATE::SUCCESS)));
+	sequence->addChild(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Succeeder(std::unique_ptr<BehaviorTree::Node>(new ClonableNode(BehaviorTree::NODE_STATE::FAILURE)))));
+
+	ASSERT_TRUE(BehaviorTree::ArchetypeRegistry::registerArchetype(1002, std::unique_ptr<BehaviorTree::Node>(sequence)));
+
+	BehaviorTree::NodePool pool;
+
+	// Spawned copies allocate through Node::operator new, so they land in
+	// the bound arena back to back instead of the global heap.
+	pool.begin();
+	std::unique_ptr<BehaviorTree::Tree> tree = BehaviorTree::ArchetypeRegistry::spawnTree(1002);
+	pool.end();
+
+	ASSERT_NE(tree, nullptr);
+	ASSERT_EQ(tree->update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+
+	// Destroy pooled nodes before the pool goes away
+	tree.reset();
+	ASSERT_TRUE(BehaviorTree::ArchetypeRegistry::unregisterArchetype(1002));
+}
+//=====================================================================================================
+
+//========================================== LOD TICK TEST ============================================
+// Reduced-rate trees receive the time of the frames they skipped as one
+// aggregated delta. The time decorators honor every period that elapsed
+// inside such a delta instead of sliding by one period per call.
+
+TEST(LOD_TICK_TEST, DELAY_FIRES_PER_MISSED_PERIOD)
+{
+	TickCountNode* leaf = new TickCountNode();
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::DelayTime(std::unique_ptr<BehaviorTree::Node>(leaf), 1.0f, false)) };
+
+	// 3.5 seconds arrive at once; the 1 second delay elapsed three times
+	ASSERT_EQ(tree.update(3.5f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(leaf->tickCount, 3);
+
+	// The half second left over counts towards the next period
+	ASSERT_EQ(tree.update(0.6f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(leaf->tickCount, 4);
+}
+
+TEST(LOD_TICK_TEST, DELAY_ONCE_CACHES_ACROSS_CATCH_UP)
+{
+	TickCountNode* leaf = new TickCountNode();
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::DelayTime(std::unique_ptr<BehaviorTree::Node>(leaf), 1.0f, true)) };
+
+	// However large the delta, a delay once executes its child one time
+	ASSERT_EQ(tree.update(10.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(tree.update(10.0f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(leaf->tickCount, 1);
+}
+
+TEST(LOD_TICK_TEST, TIME_LIMIT_EXPIRES_ON_AGGREGATED_DELTA)
+{
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::TimeLimit(std::unique_ptr<BehaviorTree::Node>(new RunningNode(1000.0f)), 1.0f)) };
+
+	ASSERT_EQ(tree.update(0.4f), BehaviorTree::NODE_STATE::RUNNING);
+
+	// One aggregated delta pushes the clock past the limit
+	ASSERT_EQ(tree.update(2.0f), BehaviorTree::NODE_STATE::FAILURE);
+
+	// The window restarted after the failure
+	ASSERT_EQ(tree.update(0.4f), BehaviorTree::NODE_STATE::RUNNING);
+}
+
+TEST(LOD_TICK_TEST, REDUCED_RATE_JOB_SEES_ALL_TIME)
+{
+	TickCountNode* fullLeaf = new TickCountNode();
+	TickCountNode* slowLeaf = new TickCountNode();
+
+	BehaviorTree::Tree full{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(fullLeaf))) };
+	BehaviorTree::Tree slow{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::DelayTime(std::unique_ptr<BehaviorTree::Node>(slowLeaf), 1.0f, false)) };
+	BehaviorTree::TreeInstance fullInstance = full.createInstance();
+	BehaviorTree::TreeInstance slowInstance = slow.createInstance();
+
+	BehaviorTree::Scheduler scheduler(2);
+	scheduler.addTree(&full, &fullInstance);
+	scheduler.addTree(&slow, &slowInstance, BehaviorTree::Scheduler::TICK_RATE::ONE_HZ);
+
+	// 8 frames of a quarter second. Exact in float, so the 1 Hz job comes
+	// due on frames 4 and 8 with a whole second each time, which is enough
+	// to elapse its 1 second delay.
+	for (int i = 0; i < 8; i++)
+	{
+		scheduler.update(0.25f);
+	}
+
+	ASSERT_EQ(fullLeaf->tickCount, 8);
+	ASSERT_EQ(slowLeaf->tickCount, 2);
+}
+//=====================================================================================================
+
+//========================================== BLACKBOARD TEST ==========================================
+// A blackboard condition that counts how many times it actually evaluated.
+class CountingBlackboardCondition : public BehaviorTree::BlackboardCondition
+{
+public:
+	using BehaviorTree::BlackboardCondition::BlackboardCondition;
+
+	int evaluateCount = 0;
+protected:
+	virtual const bool evaluate() override
+	{
+		this->evaluateCount++;
+		return BehaviorTree::BlackboardCondition::evaluate();
+	}
+};
+
+TEST(BLACKBOARD_TEST, INTERNED_KEYS_ARE_STABLE)
+{
+	const int first = BehaviorTree::Blackboard::internKey("ut_blackboard_first");
+	const int second = BehaviorTree::Blackboard::internKey("ut_blackboard_second");
+
+	ASSERT_EQ(first, BehaviorTree::Blackboard::internKey("ut_blackboard_first"));
+	ASSERT_NE(first, second);
+}
+
+TEST(BLACKBOARD_TEST, TYPED_SLOTS_ROUND_TRIP)
+{
+	const int key = BehaviorTree::Blackboard::internKey("ut_blackboard_slot");
+	BehaviorTree::Blackboard blackboard;
+
+	// Missing entry reads as the default
+	ASSERT_EQ(blackboard.getType(key), BehaviorTree::Blackboard::ENTRY_TYPE::EMPTY);
+	ASSERT_EQ(blackboard.getFloat(key, -1.0f), -1.0f);
+
+	blackboard.setFloat(key, 75.0f);
+	ASSERT_EQ(blackboard.getType(key), BehaviorTree::Blackboard::ENTRY_TYPE::FLOAT);
+	ASSERT_EQ(blackboard.getFloat(key), 75.0f);
+
+	// Reading as another type gives the default, not a reinterpretation
+	ASSERT_EQ(blackboard.getInt(key, -7), -7);
+
+	blackboard.setBool(key, true);
+	ASSERT_EQ(blackboard.getType(key), BehaviorTree::Blackboard::ENTRY_TYPE::BOOL);
+	ASSERT_TRUE(blackboard.getBool(key));
+}
+
+TEST(BLACKBOARD_TEST, VERSION_BUMPS_PER_WRITE)
+{
+	const int key = BehaviorTree::Blackboard::internKey("ut_blackboard_version");
+	BehaviorTree::Blackboard blackboard;
+
+	ASSERT_EQ(blackboard.getVersion(key), 0);
+	blackboard.setInt(key, 1);
+	ASSERT_EQ(blackboard.getVersion(key), 1);
+	blackboard.setInt(key, 1);
+	ASSERT_EQ(blackboard.getVersion(key), 2);
+}
+
+TEST(BLACKBOARD_TEST, CONDITION_SKIPS_CLEAN_ENTRY)
+{
+	const int key = BehaviorTree::Blackboard::internKey("ut_blackboard_distance");
+	BehaviorTree::Blackboard blackboard;
+	blackboard.setFloat(key, 3.0f);
+
+	CountingBlackboardCondition* condition = new CountingBlackboardCondition(&blackboard, key, BehaviorTree::BatchCondition::COMPARATOR::LESS, 5.0f);
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(condition) };
+
+	// Three ticks, one evaluation; the entry version didn't move
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(condition->evaluateCount, 1);
+
+	// A write re-evaluates once
+	blackboard.setFloat(key, 9.0f);
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::FAILURE);
+	ASSERT_EQ(condition->evaluateCount, 2);
+}
+
+TEST(BLACKBOARD_TEST, REACTIVE_ABORT_ON_WRITE)
+{
+	const int key = BehaviorTree::Blackboard::internKey("ut_blackboard_threat");
+	BehaviorTree::Blackboard blackboard;
+
+	// Guarded high priority branch over a running low priority branch
+	BehaviorTree::Sequence* fight = new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::BlackboardCondition(&blackboard, key, BehaviorTree::BatchCondition::COMPARATOR::GREATER, 0.5f)));
+	fight->addChild(std::move(create<SuccessNode>()));
+
+	BehaviorTree::Selector* root = new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(fight));
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(new RunningNode(1000.0f)));
+	root->setReactive(true);
+
+	ASSERT_EQ(root->update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(root->update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+
+	// Writing the entry is all it takes to wake the higher priority branch
+	blackboard.setFloat(key, 1.0f);
+	ASSERT_EQ(root->update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+
+	delete root;
+}
+//=====================================================================================================
+
+//=========================================== PARALLEL TEST ===========================================
+// A leaf that runs for a number of ticks, then finishes with a given state.
+class StepNode : public BehaviorTree::Node
+{
+public:
+	StepNode(const int runFor, const BehaviorTree::NODE_STATE final = BehaviorTree::NODE_STATE::SUCCESS) : Node(), runFor(runFor), tickCount(0), final(final) {}
+	~StepNode() = default;
+
+	int runFor;
+	int tickCount;
+	BehaviorTree::NODE_STATE final;
+
+	virtual const BehaviorTree::NODE_STATE update(const float delta = 0) override
+	{
+		this->tickCount++;
+		return this->tickCount <= this->runFor ? BehaviorTree::NODE_STATE::RUNNING : this->final;
+	}
+
+	virtual void reset() override
+	{
+		this->tickCount = 0;
+	}
+};
+
+TEST(PARALLEL_TEST, REQUIRE_ALL_WAITS_FOR_SLOWEST)
+{
+	StepNode* fast = new StepNode(0);
+	StepNode* slow = new StepNode(2);
+
+	BehaviorTree::Parallel parallel{ std::unique_ptr<BehaviorTree::Node>(fast) };
+	parallel.addChild(std::unique_ptr<BehaviorTree::Node>(slow));
+
+	ASSERT_EQ(parallel.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(parallel.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+
+	// The finished child kept its result and was not re-ticked
+	ASSERT_EQ(fast->tickCount, 1);
+	ASSERT_EQ(parallel.getChildState(0), BehaviorTree::NODE_STATE::SUCCESS);
+
+	ASSERT_EQ(parallel.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+TEST(PARALLEL_TEST, REQUIRE_ONE_FAILURE_ABORTS_SIBLING)
+{
+	StepNode* mover = new StepNode(100);
+	StepNode* failer = new StepNode(1, BehaviorTree::NODE_STATE::FAILURE);
+
+	BehaviorTree::Parallel parallel{ std::unique_ptr<BehaviorTree::Node>(mover) };
+	parallel.addChild(std::unique_ptr<BehaviorTree::Node>(failer));
+
+	ASSERT_EQ(parallel.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(parallel.update(0.1f), BehaviorTree::NODE_STATE::FAILURE);
+
+	// The still running sibling was reset by the abort
+	ASSERT_EQ(mover->tickCount, 0);
+}
+
+TEST(PARALLEL_TEST, SUCCESS_POLICY_CHECKED_FIRST)
+{
+	BehaviorTree::Parallel parallel{ std::unique_ptr<BehaviorTree::Node>(new StepNode(0)), BehaviorTree::Parallel::POLICY::REQUIRE_ONE, BehaviorTree::Parallel::POLICY::REQUIRE_ONE };
+	parallel.addChild(std::unique_ptr<BehaviorTree::Node>(new StepNode(0, BehaviorTree::NODE_STATE::FAILURE)));
+
+	// One success and one failure in the same update; success wins
+	ASSERT_EQ(parallel.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+TEST(PARALLEL_TEST, STALLED_VOTE_FAILS)
+{
+	// All children finished but neither REQUIRE_ALL vote can be met anymore
+	BehaviorTree::Parallel parallel{ std::unique_ptr<BehaviorTree::Node>(new StepNode(0)), BehaviorTree::Parallel::POLICY::REQUIRE_ALL, BehaviorTree::Parallel::POLICY::REQUIRE_ALL };
+	parallel.addChild(std::unique_ptr<BehaviorTree::Node>(new StepNode(0, BehaviorTree::NODE_STATE::FAILURE)));
+
+	ASSERT_EQ(parallel.update(0.1f), BehaviorTree::NODE_STATE::FAILURE);
+}
+
+TEST(PARALLEL_TEST, EMPTY_RETURNS_ERROR)
+{
+	BehaviorTree::Parallel parallel{ nullptr };
+
+	ASSERT_EQ(parallel.update(0.1f), BehaviorTree::NODE_STATE::ERROR);
+}
+
+TEST(PARALLEL_TEST, STAYS_LEAF_WHEN_BAKED)
+{
+	// The parallel's subtree runs through the virtual update in a baked tree
+	BehaviorTree::Parallel* parallel = new BehaviorTree::Parallel{ std::unique_ptr<BehaviorTree::Node>(new StepNode(0)) };
+	parallel->addChild(std::unique_ptr<BehaviorTree::Node>(new StepNode(1)));
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(parallel) };
+
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+TEST(PARALLEL_TEST, CONCURRENT_DISPATCH_JOINS)
+{
+	// Concurrent dispatch must deliver the same result as the serial path
+	StepNode* fast = new StepNode(0);
+	StepNode* slow = new StepNode(1);
+
+	BehaviorTree::Parallel parallel{ std::unique_ptr<BehaviorTree::Node>(fast) };
+	parallel.addChild(std::unique_ptr<BehaviorTree::Node>(slow));
+	parallel.setConcurrent(true);
+
+	ASSERT_TRUE(parallel.isConcurrent());
+	ASSERT_EQ(parallel.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(parallel.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(fast->tickCount, 1);
+}
+//=====================================================================================================
+
+//====================================== ITERATIVE ENGINE TEST ======================================
+TEST(ITERATIVE_ENGINE_TEST, DEEP_SEQUENCE_CHAIN_COMPLETES)
+{
+	// A 10000 level chain of two child sequences (two, so the bake pass
+	// doesn't collapse them). The recursive walk spent a machine stack frame
+	// per level; the iterative walk spends a vector entry in the instance
+	// instead and finishes a tree this deep just fine.
+	TickCountNode* leaf = new TickCountNode();
+
+	std::unique_ptr<BehaviorTree::Node> chain(leaf);
+	for (int i = 0; i < 10000; i++)
+	{
+		BehaviorTree::Sequence* level = new BehaviorTree::Sequence(std::move(create<SuccessNode>()));
+		level->addChild(std::move(chain));
+		chain.reset(level);
+	}
+
+	BehaviorTree::Tree tree(std::move(chain));
+
+	ASSERT_EQ(tree.getNodeCount(), 20001);
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(leaf->tickCount, 1);
+}
+
+TEST(ITERATIVE_ENGINE_TEST, DEEP_INVERTER_CHAIN_FLIPS)
+{
+	// Odd number of inverters, each separated by a two child sequence so the
+	// bake pass can't fold the pairs. The result must flip once per inverter
+	// on the way back out of the stack, same as the recursive unwind did.
+	std::unique_ptr<BehaviorTree::Node> chain = create<SuccessNode>();
+	for (int i = 0; i < 5001; i++)
+	{
+		BehaviorTree::Sequence* level = new BehaviorTree::Sequence(std::move(create<SuccessNode>()));
+		level->addChild(std::move(chain));
+		chain.reset(new BehaviorTree::Inverter(std::unique_ptr<BehaviorTree::Node>(level)));
+	}
+
+	BehaviorTree::Tree tree(std::move(chain));
+
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::FAILURE);
+}
+
+TEST(ITERATIVE_ENGINE_TEST, DEEP_RESUME_SKIPS_FINISHED_SIBLING)
+{
+	// selector -> [inverter -> count, 3000 sequences -> running]. The second
+	// tick resumes straight at the running leaf; the finished first branch
+	// must not be visited again on the way there.
+	TickCountNode* probe = new TickCountNode();
+
+	BehaviorTree::Selector* rootSelector = new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Inverter(std::unique_ptr<BehaviorTree::Node>(probe))));
+
+	std::unique_ptr<BehaviorTree::Node> chain = std::unique_ptr<BehaviorTree::Node>(new RunningNode(1000.0f));
+	for (int i = 0; i < 3000; i++)
+	{
+		BehaviorTree::Sequence* level = new BehaviorTree::Sequence(std::move(create<SuccessNode>()));
+		level->addChild(std::move(chain));
+		chain.reset(level);
+	}
+	rootSelector->addChild(std::move(chain));
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(rootSelector) };
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+
+	ASSERT_EQ(tree.update(instance, 0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(tree.update(instance, 0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(probe->tickCount, 1);
+}
+
+TEST(ITERATIVE_ENGINE_TEST, BUDGET_YIELDS_PARTWAY_DOWN)
+{
+	// The budget is charged when a frame enters its node, so a deep descent
+	// runs out of visits on the way down and yields RUNNING mid chain.
+	std::unique_ptr<BehaviorTree::Node> chain = create<SuccessNode>();
+	for (int i = 0; i < 10000; i++)
+	{
+		BehaviorTree::Sequence* level = new BehaviorTree::Sequence(std::move(create<SuccessNode>()));
+		level->addChild(std::move(chain));
+		chain.reset(level);
+	}
+
+	BehaviorTree::Tree tree(std::move(chain));
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+
+	ASSERT_EQ(tree.update(instance, 0.1f, BehaviorTree::TickBudget(100)), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_TRUE(instance.getLastTickYielded());
+}
+//=====================================================================================================
+
+//=========================================== MEMOIZE TEST ==========================================
+// A guard leaf that reads one blackboard int and counts its evaluations.
+class GuardNode : public BehaviorTree::Node
+{
+public:
+	GuardNode(BehaviorTree::Blackboard* blackboard, const int keyId) : Node(), blackboard(blackboard), keyId(keyId), evalCount(0) {}
+	~GuardNode() = default;
+
+	BehaviorTree::Blackboard* blackboard;
+	int keyId;
+	int evalCount;
+
+	virtual const BehaviorTree::NODE_STATE update(const float delta = 0) override
+	{
+		this->evalCount++;
+		return this->blackboard->getInt(this->keyId) > 0 ? BehaviorTree::NODE_STATE::SUCCESS : BehaviorTree::NODE_STATE::FAILURE;
+	}
+};
+
+TEST(MEMOIZE_TEST, CACHE_SKIPS_QUIET_FRAMES)
+{
+	const int keyId = BehaviorTree::Blackboard::internKey("MEMOIZE_TEST/health");
+
+	BehaviorTree::Blackboard blackboard;
+	blackboard.setInt(keyId, 10);
+
+	GuardNode* guard = new GuardNode(&blackboard, keyId);
+	BehaviorTree::Memoize memoize{ std::unique_ptr<BehaviorTree::Node>(guard), &blackboard };
+
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+
+	// One evaluation served all three ticks
+	ASSERT_EQ(guard->evalCount, 1);
+}
+
+TEST(MEMOIZE_TEST, WRITE_TO_READ_KEY_REEVALUATES)
+{
+	const int readKey = BehaviorTree::Blackboard::internKey("MEMOIZE_TEST/read");
+	const int otherKey = BehaviorTree::Blackboard::internKey("MEMOIZE_TEST/other");
+
+	BehaviorTree::Blackboard blackboard;
+	blackboard.setInt(readKey, 1);
+
+	GuardNode* guard = new GuardNode(&blackboard, readKey);
+	BehaviorTree::Memoize memoize{ std::unique_ptr<BehaviorTree::Node>(guard), &blackboard };
+
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+
+	// A write to a key the child never read keeps the cache
+	blackboard.setInt(otherKey, 99);
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(guard->evalCount, 1);
+
+	// A write to the read key drops it
+	blackboard.setInt(readKey, 0);
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::FAILURE);
+	ASSERT_EQ(guard->evalCount, 2);
+}
+
+TEST(MEMOIZE_TEST, RUNNING_IS_NOT_CACHED)
+{
+	BehaviorTree::Blackboard blackboard;
+
+	RunningNode* leaf = new RunningNode(1000.0f);
+	BehaviorTree::Memoize memoize{ std::unique_ptr<BehaviorTree::Node>(leaf), &blackboard };
+
+	// A running child keeps getting ticked every update
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_GT(leaf->elapsedTime, 0.1f);
+}
+
+TEST(MEMOIZE_TEST, INVALIDATE_FORCES_REEVALUATION)
+{
+	const int keyId = BehaviorTree::Blackboard::internKey("MEMOIZE_TEST/manual");
+
+	BehaviorTree::Blackboard blackboard;
+	blackboard.setInt(keyId, 1);
+
+	GuardNode* guard = new GuardNode(&blackboard, keyId);
+	BehaviorTree::Memoize memoize{ std::unique_ptr<BehaviorTree::Node>(guard), &blackboard };
+
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(guard->evalCount, 1);
+
+	memoize.invalidate();
+
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(guard->evalCount, 2);
+}
+
+TEST(MEMOIZE_TEST, WORKS_AS_BAKED_LEAF)
+{
+	const int keyId = BehaviorTree::Blackboard::internKey("MEMOIZE_TEST/baked");
+
+	BehaviorTree::Blackboard blackboard;
+	blackboard.setInt(keyId, 1);
+
+	GuardNode* guard = new GuardNode(&blackboard, keyId);
+	BehaviorTree::Sequence* root = new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Memoize(std::unique_ptr<BehaviorTree::Node>(guard), &blackboard)));
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root) };
+
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(guard->evalCount, 1);
+
+	blackboard.setInt(keyId, 0);
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::FAILURE);
+	ASSERT_EQ(guard->evalCount, 2);
+}
+
+TEST(MEMOIZE_TEST, NESTED_MEMOIZE_KEEPS_BOTH_CACHES_CORRECT)
+{
+	// outer memoize -> sequence -> [guard(outerKey), inner memoize -> guard(innerKey)],
+	// all on one blackboard. Recordings nest, so the outer cache watches
+	// both keys even though the inner recording ran in the middle of its own.
+	const int outerKey = BehaviorTree::Blackboard::internKey("MEMOIZE_TEST/nestedOuter");
+	const int innerKey = BehaviorTree::Blackboard::internKey("MEMOIZE_TEST/nestedInner");
+
+	BehaviorTree::Blackboard blackboard;
+	blackboard.setInt(outerKey, 1);
+	blackboard.setInt(innerKey, 1);
+
+	GuardNode* outerGuard = new GuardNode(&blackboard, outerKey);
+	GuardNode* innerGuard = new GuardNode(&blackboard, innerKey);
+
+	BehaviorTree::Sequence* sequence = new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(outerGuard));
+	sequence->addChild(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Memoize(std::unique_ptr<BehaviorTree::Node>(innerGuard), &blackboard)));
+	BehaviorTree::Memoize memoize{ std::unique_ptr<BehaviorTree::Node>(sequence), &blackboard };
+
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(outerGuard->evalCount, 1);
+	ASSERT_EQ(innerGuard->evalCount, 1);
+
+	// The outer key stayed in the outer record across the nested recording
+	blackboard.setInt(outerKey, 2);
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(outerGuard->evalCount, 2);
+
+	// The inner cache was still fresh and answered without its guard
+	ASSERT_EQ(innerGuard->evalCount, 1);
+
+	// That cache hit reported the inner key to the outer recording, so a
+	// write to it re-evaluates the outer cache and reaches the inner guard
+	blackboard.setInt(innerKey, 2);
+	ASSERT_EQ(memoize.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(outerGuard->evalCount, 3);
+	ASSERT_EQ(innerGuard->evalCount, 2);
+}
+//=====================================================================================================
+
+//======================================= BAKE VALIDATION TEST ======================================
+TEST(BAKE_VALIDATION_TEST, CHILDLESS_COMPOSITE_REJECTED)
+{
+	BehaviorTree::Selector* root = new BehaviorTree::Selector(std::move(create<FailureNode>()));
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Sequence(nullptr)));
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root) };
+
+	ASSERT_FALSE(tree.isValid());
+	ASSERT_FALSE(tree.getBakeError().empty());
+
+	// A rejected tree errors without walking
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::ERROR);
+}
+
+TEST(BAKE_VALIDATION_TEST, NEGATIVE_DURATION_REJECTED)
+{
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::DelayTime(std::move(create<SuccessNode>()), -1.0f, false)) };
+
+	ASSERT_FALSE(tree.isValid());
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::ERROR);
+}
+
+TEST(BAKE_VALIDATION_TEST, WELL_FORMED_TREE_PASSES)
+{
+	BehaviorTree::Selector* root = new BehaviorTree::Selector(std::move(create<FailureNode>()));
+	root->addChild(std::move(create<SuccessNode>()));
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root) };
+
+	ASSERT_TRUE(tree.isValid());
+	ASSERT_TRUE(tree.getBakeError().empty());
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+TEST(BAKE_VALIDATION_TEST, SINGLE_CHILD_COMPOSITE_COLLAPSES)
+{
+	// selector -> [failure, sequence -> sequence -> sequence -> leaf].
+	// The three degenerate sequences bake away under TERMINATE, where an
+	// ERROR propagates the same with or without them.
+	TickCountNode* leaf = new TickCountNode();
+
+	std::unique_ptr<BehaviorTree::Node> chain(leaf);
+	for (int i = 0; i < 3; i++)
+	{
+		chain.reset(new BehaviorTree::Sequence(std::move(chain)));
+	}
+
+	BehaviorTree::Selector* root = new BehaviorTree::Selector(std::move(create<FailureNode>()));
+	root->addChild(std::move(chain));
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root), BehaviorTree::ERROR_POLICY::TERMINATE };
+
+	ASSERT_EQ(tree.getNodeCount(), 3);
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(leaf->tickCount, 1);
+}
+
+TEST(BAKE_VALIDATION_TEST, COMPOSITE_KEPT_UNDER_IGNORE_POLICY)
+{
+	// selector -> [sequence -> error, fallback]. Under IGNORE the sequence
+	// absorbs the error in to SUCCESS and the fallback never ticks; a
+	// collapse would hand the raw ERROR to the selector, which would skip
+	// to the fallback. The pass must keep the sequence.
+	TickCountNode* fallback = new TickCountNode();
+
+	BehaviorTree::Selector* root = new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(new ErrorNode()))));
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(fallback));
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root) };
+
+	ASSERT_EQ(tree.getNodeCount(), 4);
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(fallback->tickCount, 0);
+}
+
+TEST(BAKE_VALIDATION_TEST, ROOT_COMPOSITE_IS_KEPT)
+{
+	// The root composite absorbs a child ERROR under the IGNORE policy
+	// where a bare child would report it, so it is never collapsed
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Sequence(std::move(create<SuccessNode>()))) };
+
+	ASSERT_EQ(tree.getNodeCount(), 2);
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+TEST(BAKE_VALIDATION_TEST, DOUBLE_INVERSION_FOLDS)
+{
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Inverter(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Inverter(std::move(create<SuccessNode>()))))) };
+
+	ASSERT_EQ(tree.getNodeCount(), 1);
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+TEST(BAKE_VALIDATION_TEST, REWRITERS_UNDER_CONSTANT_FOLD)
+{
+	// Succeeder ignores the child result, so the Failer and Inverter under
+	// it only cost node visits and bake away. The leaf still ticks.
+	TickCountNode* leaf = new TickCountNode();
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Succeeder(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Failer(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Inverter(std::unique_ptr<BehaviorTree::Node>(leaf))))))) };
+
+	ASSERT_EQ(tree.getNodeCount(), 2);
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(leaf->tickCount, 1);
+}
+
+TEST(BAKE_VALIDATION_TEST, DERIVED_NODES_STAY_AS_AUTHORED)
+{
+	// A user derived composite is a LEAF to the tree; the pass must not
+	// reach in to it even when its shape looks degenerate
+	class DerivedSequence : public BehaviorTree::Sequence
+	{
+	public:
+		DerivedSequence(std::unique_ptr<BehaviorTree::Node> child) : Sequence(std::move(child)) {}
+	};
+
+	BehaviorTree::Selector* root = new BehaviorTree::Selector(std::move(create<FailureNode>()));
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(new DerivedSequence(std::move(create<SuccessNode>()))));
+
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root) };
+
+	ASSERT_EQ(tree.getNodeCount(), 3);
+	ASSERT_EQ(tree.update(0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+}
+
+TEST(BAKE_VALIDATION_TEST, SHRINKING_MAX_CHILDREN_TERMINATES)
+{
+	// The cleanup loop never advanced and the infinite cap compared as
+	// smaller than any request, so a shrink either hung or did nothing
+	BehaviorTree::Selector selector{ std::move(create<FailureNode>()) };
+	selector.addChild(std::move(create<FailureNode>()));
+	selector.addChild(std::move(create<SuccessNode>()));
+
+	ASSERT_TRUE(selector.setMaxChildrenSize(1, true));
+	ASSERT_EQ(selector.update(0.1f), BehaviorTree::NODE_STATE::FAILURE);
+}
+//=====================================================================================================
+
+//======================================= STATE SNAPSHOT TEST =======================================
+TEST(STATE_SNAPSHOT_TEST, MID_BEHAVIOR_RESUME_ON_FRESH_INSTANCE)
+{
+	// sequence -> [count, step(runs once), count]. Snapshot while the step
+	// is running; the restored instance must not re-run the finished prefix.
+	TickCountNode* before = new TickCountNode();
+	StepNode* step = new StepNode(1);
+	TickCountNode* after = new TickCountNode();
+
+	BehaviorTree::Sequence* root = new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(before));
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(step));
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(after));
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root) };
+
+	BehaviorTree::TreeInstance source = tree.createInstance();
+	ASSERT_EQ(tree.update(source, 0.1f), BehaviorTree::NODE_STATE::RUNNING);
+
+	std::vector<unsigned char> blob;
+	ASSERT_TRUE(tree.saveState(source, blob));
+
+	BehaviorTree::TreeInstance target = tree.createInstance();
+	ASSERT_TRUE(tree.loadState(target, blob));
+	ASSERT_EQ(target.getLastState(), BehaviorTree::NODE_STATE::RUNNING);
+
+	ASSERT_EQ(tree.update(target, 0.1f), BehaviorTree::NODE_STATE::SUCCESS);
+	ASSERT_EQ(before->tickCount, 1);
+	ASSERT_EQ(after->tickCount, 1);
+}
+
+TEST(STATE_SNAPSHOT_TEST, DECORATOR_CLOCKS_ROUND_TRIP)
+{
+	// 6 seconds in to a 10 second delay; the restored clock needs 5 more
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::DelayTime(std::unique_ptr<BehaviorTree::Node>(new RunningNode(1000.0f)), 10.0f, false)) };
+
+	BehaviorTree::TreeInstance source = tree.createInstance();
+	ASSERT_EQ(tree.update(source, 6.0f), BehaviorTree::NODE_STATE::RUNNING);
+
+	std::vector<unsigned char> blob;
+	ASSERT_TRUE(tree.saveState(source, blob));
+
+	BehaviorTree::TreeInstance target = tree.createInstance();
+	ASSERT_TRUE(tree.loadState(target, blob));
+
+	ASSERT_EQ(tree.update(target, 3.0f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(tree.update(target, 2.0f), BehaviorTree::NODE_STATE::RUNNING);
+}
+
+TEST(STATE_SNAPSHOT_TEST, FOREIGN_BLOB_REJECTED)
+{
+	BehaviorTree::Tree treeA{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Sequence(std::move(create<SuccessNode>()))) };
+
+	BehaviorTree::Sequence* rootB = new BehaviorTree::Sequence(std::move(create<SuccessNode>()));
+	rootB->addChild(std::move(create<SuccessNode>()));
+	BehaviorTree::Tree treeB{ std::unique_ptr<BehaviorTree::Node>(rootB) };
+
+	std::vector<unsigned char> blob;
+	ASSERT_TRUE(treeA.saveState(blob));
+	ASSERT_FALSE(treeB.loadState(blob));
+}
+
+TEST(STATE_SNAPSHOT_TEST, MALFORMED_BLOB_REJECTED)
+{
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(new StepNode(2)))) };
+	tree.update(0.1f);
+
+	std::vector<unsigned char> blob;
+	ASSERT_TRUE(tree.saveState(blob));
+
+	std::vector<unsigned char> truncated(blob.begin(), blob.end() - 1);
+	ASSERT_FALSE(tree.loadState(truncated));
+
+	std::vector<unsigned char> corrupt = blob;
+	corrupt.at(0) ^= 0xFF;
+	ASSERT_FALSE(tree.loadState(corrupt));
+
+	// The pristine blob still loads after the rejected attempts
+	ASSERT_TRUE(tree.loadState(blob));
+}
+
+// Overwrites one int field of a state blob, addressed from the end. The blob
+// tail is fixed per version: lastState(1), runningNodeIndex(4), rngState(4),
+// then the childOrder entries, so forgery tests don't depend on slot counts.
+static void forgeStateInt(std::vector<unsigned char>& blob, const std::size_t offsetFromEnd, const int value)
+{
+	std::memcpy(blob.data() + blob.size() - offsetFromEnd, &value, sizeof(int));
+}
+
+TEST(STATE_SNAPSHOT_TEST, FORGED_RUNNING_INDEX_REJECTED)
+{
+	// sequence(0) -> delay(1) -> leaf(2). The leaf sits under a decorator,
+	// so a blob resuming there would read a running child slot the delay
+	// doesn't have on the next update. It passes the range check; it must
+	// still be rejected.
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::DelayTime(std::unique_ptr<BehaviorTree::Node>(new RunningNode(1000.0f)), 10.0f, false)))) };
+
+	std::vector<unsigned char> blob;
+	ASSERT_TRUE(tree.saveState(blob));
+
+	std::vector<unsigned char> forged = blob;
+	forgeStateInt(forged, 5, 2);
+	ASSERT_FALSE(tree.loadState(forged));
+	ASSERT_TRUE(tree.loadState(blob));
+}
+
+TEST(STATE_SNAPSHOT_TEST, FORGED_CHILD_ORDER_REJECTED)
+{
+	// random sequence(0) -> [leaf(1), leaf(2)]. The two childOrder entries
+	// sit right before the 13 byte blob tail.
+	BehaviorTree::RandomSequence* root = new BehaviorTree::RandomSequence(std::move(create<SuccessNode>()));
+	root->addChild(std::move(create<SuccessNode>()));
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root) };
+
+	std::vector<unsigned char> blob;
+	ASSERT_TRUE(tree.saveState(blob));
+
+	// Pointing a slot at the composite itself would cycle the walk
+	std::vector<unsigned char> cyclic = blob;
+	forgeStateInt(cyclic, 21, 0);
+	ASSERT_FALSE(tree.loadState(cyclic));
+
+	// A duplicated child is in range and a child of the owner, but the
+	// slice is no permutation; the other child would never tick
+	std::vector<unsigned char> duplicated = blob;
+	forgeStateInt(duplicated, 21, 2);
+	forgeStateInt(duplicated, 17, 2);
+	ASSERT_FALSE(tree.loadState(duplicated));
+
+	ASSERT_TRUE(tree.loadState(blob));
+}
+
+TEST(STATE_SNAPSHOT_TEST, SHUFFLE_STATE_ROUND_TRIPS)
+{
+	// Restoring the PRNG state makes both instances shuffle identically,
+	// so their snapshots stay byte for byte equal from here on
+	BehaviorTree::RandomSequence* root = new BehaviorTree::RandomSequence(std::move(create<SuccessNode>()));
+	for (int i = 0; i < 7; i++)
+	{
+		root->addChild(std::move(create<SuccessNode>()));
+	}
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root) };
+
+	BehaviorTree::TreeInstance source = tree.createInstance();
+	tree.update(source, 0.1f);
+
+	std::vector<unsigned char> blob;
+	ASSERT_TRUE(tree.saveState(source, blob));
+
+	BehaviorTree::TreeInstance target = tree.createInstance();
+	ASSERT_TRUE(tree.loadState(target, blob));
+
+	tree.update(source, 0.1f);
+	tree.update(target, 0.1f);
+
+	std::vector<unsigned char> a, b;
+	ASSERT_TRUE(tree.saveState(source, a));
+	ASSERT_TRUE(tree.saveState(target, b));
+	ASSERT_EQ(a, b);
+}
+//=====================================================================================================
+
+//====================================== ALLOCATION AUDIT TEST ======================================
+// The tick path is contractually allocation free: permutation buffers are sized at build time and
+// the traversal stack is reserved at instance creation. The audit tests themselves need the
+// BT_DEBUG_ALLOC allocation hook and only compile when the test project defines it.
+TEST(ALLOCATION_AUDIT_TEST, RANDOM_COMPOSITE_PRIMES_PERMUTATION_AT_BUILD)
+{
+	// The buffer exists before the first tick and grows with addChild,
+	// so shuffleUpdateOrder never has to allocate while ticking
+	BehaviorTree::RandomSelector randomSelector{ std::move(create<SuccessNode>()) };
+	ASSERT_EQ(randomSelector.getUpdateOrder().size(), 1);
+
+	randomSelector.addChild(std::move(create<SuccessNode>()));
+	randomSelector.addChild(std::move(create<SuccessNode>()));
+	ASSERT_EQ(randomSelector.getUpdateOrder().size(), 3);
+
+	// Plain composites keep the natural order and pay nothing
+	BehaviorTree::Selector selector{ std::move(create<SuccessNode>()) };
+	ASSERT_TRUE(selector.getUpdateOrder().empty());
+}
+
+TEST(ALLOCATION_AUDIT_TEST, CLONED_RANDOM_COMPOSITE_IS_PRIMED)
+{
+	BehaviorTree::RandomSequence* proto = new BehaviorTree::RandomSequence(std::unique_ptr<BehaviorTree::Node>(new ClonableNode(BehaviorTree::NODE_STATE::SUCCESS)));
+	proto->addChild(std::unique_ptr<BehaviorTree::Node>(new ClonableNode(BehaviorTree::NODE_STATE::SUCCESS)));
+	std::unique_ptr<BehaviorTree::Node> original(proto);
+
+	std::unique_ptr<BehaviorTree::Node> copy = original->clone();
+	ASSERT_TRUE(copy != nullptr);
+
+	BehaviorTree::RandomSequence* copied = dynamic_cast<BehaviorTree::RandomSequence*>(copy.get());
+	ASSERT_TRUE(copied != nullptr);
+	ASSERT_EQ(copied->getUpdateOrder().size(), 2);
+}
+
+#if defined(BT_DEBUG_ALLOC)
+TEST(ALLOCATION_AUDIT_TEST, TICKS_ARE_ALLOCATION_FREE)
+{
+	BehaviorTree::Selector* root = new BehaviorTree::Selector(std::move(create<FailureNode>()));
+	BehaviorTree::RandomSequence* random = new BehaviorTree::RandomSequence(std::move(create<SuccessNode>()));
+	for (int i = 0; i < 7; i++)
+	{
+		random->addChild(std::move(create<SuccessNode>()));
+	}
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(random));
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Repeater(std::move(create<SuccessNode>()), 3)));
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root) };
+
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+
+	// From the very first update. There is no warm-up tick.
+	for (int i = 0; i < 20; i++)
+	{
+		tree.update(instance, 0.016f);
+		ASSERT_EQ(instance.getLastTickAllocationCount(), 0);
+	}
+}
+
+TEST(ALLOCATION_AUDIT_TEST, USER_LEAF_ALLOCATION_IS_COUNTED)
+{
+	// A leaf that allocates every update. The audit pins it.
+	class HeapHogNode : public BehaviorTree::Node
+	{
+	public:
+		virtual const BehaviorTree::NODE_STATE update(const float delta = 0) override
+		{
+			int* garbage = new int(0);
+			delete garbage;
+			return BehaviorTree::NODE_STATE::SUCCESS;
+		}
+	};
+
+	BehaviorTree::Sequence* root = new BehaviorTree::Sequence(std::move(create<SuccessNode>()));
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(new HeapHogNode()));
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root) };
+
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+	tree.update(instance, 0.016f);
+
+	ASSERT_GE(instance.getLastTickAllocationCount(), 1);
+	ASSERT_EQ(BehaviorTree::AllocationAudit::getLastTickCount(), instance.getLastTickAllocationCount());
+}
+#endif
+//=====================================================================================================
+
+//======================================== PHASE BUCKET TEST ========================================
+// Reduced-rate pairs spread over phase buckets, so same-frame registrations don't all come due in
+// the same frame. Only the due offsets move; a pair is always ticked with real gathered time.
+class PhaseTickNode : public BehaviorTree::Node
+{
+public:
+	std::atomic<int>* frameTicks;
+
+	PhaseTickNode(std::atomic<int>* frameTicks) : Node(), frameTicks(frameTicks) {}
+
+	virtual const BehaviorTree::NODE_STATE update(const float delta = 0) override
+	{
+		this->frameTicks->fetch_add(1);
+		return BehaviorTree::NODE_STATE::SUCCESS;
+	}
+};
+
+TEST(PHASE_BUCKET_TEST, SAME_FRAME_REGISTRATIONS_SPREAD)
+{
+	std::atomic<int> frameTicks{ 0 };
+
+	const int agentCount = 32;
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(new PhaseTickNode(&frameTicks)))) };
+	std::vector<BehaviorTree::TreeInstance> instances;
+	instances.reserve(agentCount);
+	for (int i = 0; i < agentCount; i++)
+	{
+		instances.push_back(tree.createInstance());
+	}
+
+	BehaviorTree::Scheduler scheduler(1, 8);
+	ASSERT_EQ(scheduler.getPhaseBucketCount(), 8);
+	for (int i = 0; i < agentCount; i++)
+	{
+		scheduler.addTree(&tree, &instances.at(i), BehaviorTree::Scheduler::TICK_RATE::ONE_HZ);
+	}
+
+	// Registration fills the emptiest bucket: 32 pairs over 8 buckets
+	for (int b = 0; b < 8; b++)
+	{
+		ASSERT_EQ(scheduler.getPhaseBucketPopulation(b), 4);
+	}
+
+	// 24 frames of 1/8 second cover three periods. Unphased, all 32 pairs
+	// would come due on one frame; bucketed, a frame ticks one bucket.
+	int maxPerFrame = 0;
+	int total = 0;
+	for (int frame = 0; frame < 24; frame++)
+	{
+		frameTicks.store(0);
+		scheduler.update(0.125f);
+		maxPerFrame = std::max(maxPerFrame, frameTicks.load());
+		total += frameTicks.load();
+	}
+
+	ASSERT_LE(maxPerFrame, agentCount / 8);
+	ASSERT_GE(total, agentCount * 2);
+}
+
+TEST(PHASE_BUCKET_TEST, PHASE_OFFSET_KEEPS_CLOCKS_CORRECT)
+{
+	// A delayed pair in a late bucket still fires on real elapsed time,
+	// because the offset shifts when it ticks, not how much time it gets
+	TickCountNode* leaf = new TickCountNode();
+	BehaviorTree::Tree filler{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Sequence(std::move(create<SuccessNode>()))) };
+	BehaviorTree::Tree delayed{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::DelayTime(std::unique_ptr<BehaviorTree::Node>(leaf), 1.0f, false)) };
+	BehaviorTree::TreeInstance fillerInstance = filler.createInstance();
+	BehaviorTree::TreeInstance delayedInstance = delayed.createInstance();
+
+	BehaviorTree::Scheduler scheduler(1, 4);
+	scheduler.addTree(&filler, &fillerInstance, BehaviorTree::Scheduler::TICK_RATE::ONE_HZ); // bucket 0
+	scheduler.addTree(&delayed, &delayedInstance, BehaviorTree::Scheduler::TICK_RATE::ONE_HZ); // bucket 1
+
+	// 24 frames of 1/8 second, exact in float. Bucket 1 of 4 comes due at
+	// 0.75 seconds and then once a second, so the delayed pair receives
+	// 0.75, 1.75 and 2.75 seconds of real time; the 1 second delay elapsed
+	// twice inside that.
+	for (int frame = 0; frame < 24; frame++)
+	{
+		scheduler.update(0.125f);
+	}
+
+	ASSERT_EQ(leaf->tickCount, 2);
+}
+
+TEST(PHASE_BUCKET_TEST, SKEWED_REMOVALS_REBALANCE)
+{
+	std::atomic<int> frameTicks{ 0 };
+
+	const int agentCount = 32;
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::Sequence(std::unique_ptr<BehaviorTree::Node>(new PhaseTickNode(&frameTicks)))) };
+	std::vector<BehaviorTree::TreeInstance> instances;
+	instances.reserve(agentCount);
+	for (int i = 0; i < agentCount; i++)
+	{
+		instances.push_back(tree.createInstance());
+	}
+
+	BehaviorTree::Scheduler scheduler(1, 4);
+	for (int i = 0; i < agentCount; i++)
+	{
+		scheduler.addTree(&tree, &instances.at(i), BehaviorTree::Scheduler::TICK_RATE::ONE_HZ);
+	}
+
+	// Empty out two of the four buckets (emptiest-first assignment put
+	// instance i in bucket i % 4)
+	for (int i = 0; i < agentCount; i++)
+	{
+		if (i % 4 == 0 || i % 4 == 1)
+		{
+			ASSERT_TRUE(scheduler.removeTree(&instances.at(i)));
+		}
+	}
+
+	// The survivors were dealt back over all buckets with bounded skew
+	int min = agentCount;
+	int max = 0;
+	int total = 0;
+	for (int b = 0; b < 4; b++)
+	{
+		const int population = scheduler.getPhaseBucketPopulation(b);
+		min = std::min(min, population);
+		max = std::max(max, population);
+		total += population;
+	}
+
+	ASSERT_EQ(total, 16);
+	ASSERT_GE(min, 1);
+	ASSERT_LE(max, 2 * min + 1);
+}
+//=====================================================================================================
+
+//======================================= PRIORITY LANE TEST ========================================
+// A Selector's child order is its priority lane: slot 0 is the highest. preempt aborts a running
+// lower priority branch in favor of a higher one, resetting only the abandoned path and entering
+// the preempting lane directly, without re-evaluating the lanes above it.
+class LaneNode : public BehaviorTree::Node
+{
+public:
+	LaneNode(const BehaviorTree::NODE_STATE state) : Node(), state(state) {}
+
+	BehaviorTree::NODE_STATE state;
+	int tickCount = 0;
+	int resetCount = 0;
+
+	virtual const BehaviorTree::NODE_STATE update(const float delta = 0) override
+	{
+		this->tickCount++;
+		return this->state;
+	}
+
+	virtual void reset() override
+	{
+		this->resetCount++;
+	}
+};
+
+TEST(PRIORITY_LANE_TEST, CLASSIC_PREEMPT_RESETS_ONLY_ABANDONED_PATH)
+{
+	LaneNode* lane0 = new LaneNode(BehaviorTree::NODE_STATE::FAILURE);
+	LaneNode* lane1 = new LaneNode(BehaviorTree::NODE_STATE::FAILURE);
+	LaneNode* lane2 = new LaneNode(BehaviorTree::NODE_STATE::RUNNING);
+
+	BehaviorTree::Selector selector{ std::unique_ptr<BehaviorTree::Node>(lane0) };
+	selector.addChild(std::unique_ptr<BehaviorTree::Node>(lane1));
+	selector.addChild(std::unique_ptr<BehaviorTree::Node>(lane2));
+
+	ASSERT_EQ(selector.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+
+	ASSERT_TRUE(selector.preempt(1));
+
+	// Only the abandoned path was reset
+	ASSERT_EQ(lane2->resetCount, 1);
+	ASSERT_EQ(lane0->resetCount, 0);
+	ASSERT_EQ(lane1->resetCount, 0);
+
+	// The next update enters directly at lane 1; lane 0 isn't re-evaluated
+	lane1->state = BehaviorTree::NODE_STATE::RUNNING;
+	ASSERT_EQ(selector.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(lane0->tickCount, 1);
+	ASSERT_EQ(lane1->tickCount, 2);
+	ASSERT_EQ(lane2->tickCount, 1);
+}
+
+TEST(PRIORITY_LANE_TEST, PREEMPT_REJECTS_INVALID_REQUESTS)
+{
+	LaneNode* lane0 = new LaneNode(BehaviorTree::NODE_STATE::RUNNING);
+	BehaviorTree::Selector selector{ std::unique_ptr<BehaviorTree::Node>(lane0) };
+	selector.addChild(std::unique_ptr<BehaviorTree::Node>(new LaneNode(BehaviorTree::NODE_STATE::SUCCESS)));
+
+	// Nothing running yet
+	ASSERT_FALSE(selector.preempt(0));
+
+	ASSERT_EQ(selector.update(0.1f), BehaviorTree::NODE_STATE::RUNNING);
+
+	// Running branch already has the highest priority; lower or out of
+	// range slots don't preempt either
+	ASSERT_FALSE(selector.preempt(0));
+	ASSERT_FALSE(selector.preempt(1));
+	ASSERT_FALSE(selector.preempt(5));
+}
+
+TEST(PRIORITY_LANE_TEST, BAKED_PREEMPT_CLEARS_ABANDONED_SUBTREE_STATE)
+{
+	LaneNode* lane0 = new LaneNode(BehaviorTree::NODE_STATE::FAILURE);
+	LaneNode* lane1 = new LaneNode(BehaviorTree::NODE_STATE::FAILURE);
+	LaneNode* lane2Leaf = new LaneNode(BehaviorTree::NODE_STATE::RUNNING);
+
+	// The low priority branch carries decorator state of its own
+	BehaviorTree::Selector* root = new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(lane0));
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(lane1));
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(new BehaviorTree::TimeLimit(std::unique_ptr<BehaviorTree::Node>(lane2Leaf), 100.0f)));
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root) };
+
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+	ASSERT_EQ(tree.update(instance, 0.5f), BehaviorTree::NODE_STATE::RUNNING);
+
+	// Preempt the root selector (flat index 0) in favor of lane 1
+	lane1->state = BehaviorTree::NODE_STATE::RUNNING;
+	ASSERT_TRUE(tree.preempt(instance, 0, 1));
+	ASSERT_EQ(lane2Leaf->resetCount, 1);
+
+	ASSERT_EQ(tree.update(instance, 0.5f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(lane0->tickCount, 1); // higher priority lane untouched
+	ASSERT_EQ(lane1->tickCount, 2);
+	ASSERT_EQ(lane2Leaf->tickCount, 1);
+
+	// Preempting a non selector or an idle selector is rejected
+	ASSERT_FALSE(tree.preempt(instance, 2, 0));
+	ASSERT_FALSE(tree.preempt(instance, 0, 1));
+}
+
+TEST(PRIORITY_LANE_TEST, PREEMPT_EVENT_APPLIES_AT_NEXT_UPDATE)
+{
+	LaneNode* lane0 = new LaneNode(BehaviorTree::NODE_STATE::FAILURE);
+	LaneNode* lane1 = new LaneNode(BehaviorTree::NODE_STATE::FAILURE);
+	LaneNode* lane2 = new LaneNode(BehaviorTree::NODE_STATE::RUNNING);
+
+	BehaviorTree::Selector* root = new BehaviorTree::Selector(std::unique_ptr<BehaviorTree::Node>(lane0));
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(lane1));
+	root->addChild(std::unique_ptr<BehaviorTree::Node>(lane2));
+	BehaviorTree::Tree tree{ std::unique_ptr<BehaviorTree::Node>(root) };
+
+	BehaviorTree::TreeInstance instance = tree.createInstance();
+	ASSERT_EQ(tree.update(instance, 0.1f), BehaviorTree::NODE_STATE::RUNNING);
+
+	// Gameplay threads preempt through the event queue; the event is
+	// applied on the ticking thread at the start of the next update
+	BehaviorTree::Event event;
+	event.nodeIndex = 0;
+	event.type = BehaviorTree::EVENT_TYPE::PREEMPT_BRANCH;
+	event.data = 1;
+	ASSERT_TRUE(instance.postEvent(event));
+
+	lane1->state = BehaviorTree::NODE_STATE::RUNNING;
+	ASSERT_EQ(tree.update(instance, 0.1f), BehaviorTree::NODE_STATE::RUNNING);
+	ASSERT_EQ(lane2->resetCount, 1);
+	ASSERT_EQ(lane0->tickCount, 1);
+	ASSERT_EQ(lane1->tickCount, 2);
+}
+//=====================================================================================================